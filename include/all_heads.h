@@ -3,8 +3,11 @@
 
 /* Includes del compilador */
 #include "sys/ioctl.h"
+#include "sys/mman.h"
 #include "stdio.h"
 #include "stdlib.h"
+#include "stdarg.h"
+#include "stddef.h"
 #include "limits.h"
 #include "unistd.h"
 #include "string.h"
@@ -13,9 +16,22 @@
 #include "iconv.h"
 #include <string>
 #include <vector>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
 
 /* Includes del proyecto */
+#include "pool_tareas.h"
+#include "cache_fragmentado.h"
 #include "driver_base.h"
+#include "fuente_bloques.h"
+#include "buffer_salida.h"
 #include "driver_fat.h"
 #include "driver_ext.h"
 #include "driver_ntfs.h"
@@ -6,6 +6,88 @@
  *     Constantes	*
  *			*
  ************************/
+/* Máximo de bytes por línea al imprimir un buffer */
+#define	MAXIMO_BYTES_POR_LINEA		64
+
+/* Comandos que se ejecutan juntos en modo lote */
+#define	COMANDOS_POR_TANDA		1024
+
+/* Bytes de salida de los comandos de una tanda que esperan su turno en memoria. Pasado este límite van a un archivo temporal */
+#define	BYTES_SALIDA_EN_MEMORIA		(32*1024*1024)
+
+/* Bytes que junta en memoria cada comando antes de pasarlos al archivo temporal, y de a cuántos se leen de vuelta */
+#define	BYTES_BLOQUE_TEMPORAL		(1024*1024)
+
+
+/************************
+ *			*
+ *     Estructuras	*
+ *			*
+ ************************/
+/* Estado del volcado en pantalla de un archivo que se recibe de a tramos */
+typedef struct
+    {
+	TDriverBase			*Driver;
+	TBufferSalida			*Salida;
+	unsigned			BytesPorLinea;
+	bool				EncabezadoImpreso;
+	__u64				Offset;				/* Posición en el archivo del primer byte pendiente */
+	unsigned			BytesPendientes;		/* Bytes de una línea incompleta que quedó del tramo anterior */
+	unsigned char			Pendientes[MAXIMO_BYTES_POR_LINEA];
+    }	TEstadoVolcado;
+
+/* Estado del listado en pantalla de todo el volumen */
+typedef struct
+    {
+	TBufferSalida			*Salida;
+	__u64				Entradas;
+    }	TEstadoRecorrido;
+
+/* Comandos del archivo de tests */
+typedef enum {ctDIR, ctCAT, ctTREE}	TTipoComando;
+
+/* Un comando del archivo de tests, ya interpretado */
+typedef struct
+    {
+	TTipoComando			Tipo;
+	TString				Ruta;				/* Directorio (DIR) o archivo (CAT) */
+    }	TComandoTest;
+
+/* Salida de un comando ejecutado en lote, mientras espera su turno para imprimirse */
+typedef struct
+    {
+	int				CodError;
+	bool				Terminado;
+	bool				Directo;			/* Ya le tocó: escribe directamente en stdout */
+	std::vector<char>		Memoria;			/* Lo último que imprimió */
+	std::vector< std::pair<__u64, size_t> >	Volcados;		/* Lo anterior, en el archivo temporal (posición y bytes) */
+    }	TResultadoComando;
+
+/* Tanda de comandos que se reparte entre los hilos. La tarea i ejecuta el comando Orden[i] */
+typedef struct
+    {
+	TAnalizadorFS			*Analizador;
+	const std::vector<TComandoTest>	*Comandos;
+	size_t				Primero;			/* Primer comando de la tanda */
+	std::vector<size_t>		Orden;
+	std::vector<TResultadoComando>	Resultados;			/* Indexado por número de comando menos Primero */
+
+	/* Lo que sigue se usa con Mutex bloqueado */
+	std::mutex			Mutex;
+	size_t				Turno;				/* Comando que está imprimiendo (o Primero+Resultados.size()) */
+	size_t				PrimerFallo;			/* Primer comando que falló, o Comandos->size() */
+	int				CodError;			/* El error de PrimerFallo, una vez que se imprimió */
+	__u64				BytesEnMemoria;
+	FILE				*Temporal;			/* Se crea la primera vez que hace falta */
+	__u64				BytesTemporal;
+    }	TTandaComandos;
+
+/* Un comando en ejecución, para la salida armada con fopencookie() */
+typedef struct
+    {
+	TTandaComandos			*pTanda;
+	size_t				NroComando;
+    }	TSalidaComando;
 
 /********************************
  *				*
@@ -19,20 +101,40 @@ public:
 	virtual				~TAnalizadorFS();
 	
 	int				Ejecutar(const char *Ruta);
+	void				ConfigurarCarga(TModoCarga Modo, __u64 BytesCache, bool MostrarEstadisticas);
+	void				ConfigurarHilos(unsigned Hilos);
+	void				ConfigurarLote(bool EnLote, bool AgruparPorDirectorio);
 
 protected:
 	unsigned			PrintWidth;
-	unsigned			LongitudDiskData;
-	const unsigned char		*DiskData;
+	TModoCarga			ModoCarga;
+	__u64				BytesCache;
+	bool				MostrarEstadisticas;
+	unsigned			HilosParalelos;
+	bool				EjecutarEnLote;
+	bool				AgruparPorDirectorio;
+	TFuenteBloques			*FuenteBloques;
 	TDriverBase			*DriverFS;
 	
 	virtual int 			EjecutarTests();
+	virtual int			LeerArchivoTests(std::vector<TComandoTest> &Comandos);
+	virtual int			EjecutarComando(const TComandoTest &Comando, FILE *f);
+	virtual int			EjecutarTestsEnLote(const std::vector<TComandoTest> &Comandos);
 
 	virtual int			CargarImagen(const char *Ruta);
 	virtual void			BorrarTodoYReinicializar(void);
 	
-	virtual int			MostrarContenidoDirectorio(const char *Path);
-	virtual int			MostrarContenidoArchivo(const char *Path);
+	virtual int			MostrarContenidoDirectorio(const char *Path, FILE *f);
+	virtual int			MostrarContenidoArchivo(const char *Path, FILE *f);
+	virtual int			MostrarVolumen(FILE *f);
+
+	static int			VolcarTramo(const TTramoArchivo &Tramo, void *pParametroUsuario);
+	static int			EjecutarComandoDeTanda(size_t NroTarea, void *pParametroUsuario);
+	static ssize_t			EscribirSalidaComando(void *pCookie, const char *Buffer, size_t Bytes);
+	static void			VolcarEnTemporal(TTandaComandos &Tanda, TResultadoComando &Resultado);
+	static void			ImprimirTurnos(TTandaComandos &Tanda, std::unique_lock<std::mutex> &Bloqueo);
+	static void			DirectorioComando(const TComandoTest &Comando, TString &Directorio);
+	static int			ImprimirEntradaVolumen(const TString &Ruta, const TEntradaDirectorio &Entrada, void *pParametroUsuario);
 };
 
 #endif
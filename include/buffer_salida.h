@@ -0,0 +1,58 @@
+#ifndef	__BUFFER_SALIDA__H__
+#define	__BUFFER_SALIDA__H__
+
+/************************
+ *			*
+ *     Constantes	*
+ *			*
+ ************************/
+/* Tamaño del buffer donde se arma la salida antes de escribirla de una sola vez */
+#define	BYTES_BUFFER_SALIDA			(1024*1024)
+
+/* Lo máximo que se puede pedir de una vez con Reservar() */
+#define	MAXIMO_RESERVA_SALIDA			(64*1024)
+
+
+/********************************
+ *				*
+ *     Clase TBufferSalida	*
+ *				*
+ ********************************/
+class TBufferSalida
+{
+public:
+					TBufferSalida(FILE *f);
+	virtual				~TBufferSalida();
+
+	/* Armado de la salida */
+	void				Texto(const char *Texto);
+	void				Texto(const char *Texto, size_t Bytes);
+	void				Caracter(char c);
+	void				Repetir(char c, size_t Veces);
+	void				Decimal(__u64 Valor, unsigned Ancho, char Relleno = ' ');
+	void				Hexa(__u64 Valor, unsigned Digitos, bool Mayusculas);
+	void				Printf(const char *Formato, ...);
+
+	/* Acceso directo al buffer, para los que arman líneas enteras */
+	char				*Reservar(size_t Bytes);
+	void				Avanzar(size_t Bytes)		{Usados+=Bytes;};
+
+	void				Vaciar(void);
+
+	/* Tablas de conversión: cada byte como dos dígitos hexa y un espacio, y como caracter imprimible */
+	static const char		*HexaMayusculas(unsigned char Byte)	{return(TablaHexa[Byte]);};
+	static char			Imprimible(unsigned char Byte)		{return(Byte>=' ' ? (char)Byte : '.');};
+
+protected:
+	FILE				*Salida;
+	char				*Buffer;
+	size_t				Usados;
+
+	static const char		DigitosMayusculas[17];
+	static const char		DigitosMinusculas[17];
+	static char			TablaHexa[256][4];
+	static bool			TablaHexaArmada;
+	static bool			ArmarTablaHexa(void);
+};
+
+#endif
@@ -0,0 +1,240 @@
+#ifndef	__CACHE_FRAGMENTADO__H__
+#define	__CACHE_FRAGMENTADO__H__
+
+/************************
+ *			*
+ *     Constantes	*
+ *			*
+ ************************/
+/* Cantidad de fragmentos de cada cache compartido entre hilos. Cada clave cae siempre en el mismo fragmento */
+#define	FRAGMENTOS_CACHE			16
+
+
+/****************************************
+ *					*
+ *     Clase TCacheFragmentado		*
+ *					*
+ ****************************************/
+template <typename TClave, typename TValor> class TCacheFragmentado
+{
+public:
+					TCacheFragmentado();
+
+	void				Dimensionar(size_t MaximoEntradas);
+	bool				Buscar(const TClave &Clave, TValor &Valor);
+	void				Guardar(const TClave &Clave, const TValor &Valor);
+
+	/* Contadores, sumando todos los fragmentos */
+	size_t				Aciertos(void);
+	size_t				Fallos(void);
+	size_t				Entradas(void);
+
+protected:
+	/* Cada fragmento es un cache LRU con su propio mutex (la entrada más reciente adelante) */
+	typedef struct
+	    {
+		TClave				Clave;
+		TValor				Valor;
+	    }	TEntradaCache;
+	typedef struct
+	    {
+		std::mutex			Mutex;
+		std::list<TEntradaCache>	Entradas;
+		std::unordered_map<TClave, typename std::list<TEntradaCache>::iterator>	Indice;
+		size_t				Aciertos;
+		size_t				Fallos;
+	    }	TFragmentoCache;
+
+	TFragmentoCache			Fragmentos[FRAGMENTOS_CACHE];
+	size_t				MaximoPorFragmento;
+
+	TFragmentoCache			&Fragmento(const TClave &Clave);
+};
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						TCacheFragmentado :: TCacheFragmentado							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+template <typename TClave, typename TValor> TCacheFragmentado<TClave, TValor>::TCacheFragmentado()
+{
+size_t	i;
+
+/* Inicializar variables */
+for (i=0;i<FRAGMENTOS_CACHE;i++)
+	Fragmentos[i].Aciertos=Fragmentos[i].Fallos=0;
+MaximoPorFragmento=1;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TCacheFragmentado :: Dimensionar							*
+ *																	*
+ * OBJETIVO: Esta función fija cuántas entradas puede guardar el cache.									*
+ *																	*
+ * ENTRADA: MaximoEntradas: Cantidad máxima de entradas, sumando todos los fragmentos.							*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Se llama antes de empezar a usar el cache, desde un solo hilo. Cada fragmento se queda con una parte igual.		*
+ *																	*
+ ****************************************************************************************************************************************/
+template <typename TClave, typename TValor> void TCacheFragmentado<TClave, TValor>::Dimensionar(size_t MaximoEntradas)
+{
+MaximoPorFragmento=MaximoEntradas/FRAGMENTOS_CACHE ? MaximoEntradas/FRAGMENTOS_CACHE : 1;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TCacheFragmentado :: Buscar							*
+ *																	*
+ * OBJETIVO: Esta función busca una entrada en el cache y, si está, la pasa adelante en su fragmento.					*
+ *																	*
+ * ENTRADA: Clave: La clave buscada.													*
+ *																	*
+ * SALIDA: En el nombre de la función true si la encontró.										*
+ *	   Valor: Copia del valor guardado.												*
+ *																	*
+ * OBSERVACIONES: Se devuelve una copia porque la entrada puede desalojarse desde otro hilo apenas se suelta el mutex. Para valores	*
+ *		  grandes se guarda un std::shared_ptr, así copiar es sólo sumar una referencia.					*
+ *																	*
+ ****************************************************************************************************************************************/
+template <typename TClave, typename TValor> bool TCacheFragmentado<TClave, TValor>::Buscar(const TClave &Clave, TValor &Valor)
+{
+TFragmentoCache							&Frag = Fragmento(Clave);
+std::lock_guard<std::mutex>					Bloqueo(Frag.Mutex);
+typename std::unordered_map<TClave, typename std::list<TEntradaCache>::iterator>::iterator	itIndice;
+
+if ( (itIndice=Frag.Indice.find(Clave)) == Frag.Indice.end() )
+    {
+	Frag.Fallos++;
+	return(false);
+    }
+Frag.Aciertos++;
+Frag.Entradas.splice(Frag.Entradas.begin(), Frag.Entradas, itIndice->second);
+Valor=Frag.Entradas.front().Valor;
+return(true);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TCacheFragmentado :: Guardar							*
+ *																	*
+ * OBJETIVO: Esta función guarda una entrada adelante de su fragmento, desalojando la menos usada del fragmento si está lleno.		*
+ *																	*
+ * ENTRADA: Clave: La clave.														*
+ *	    Valor: El valor.														*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Si dos hilos no la encontraron y la armaron a la vez, la segunda reemplaza a la primera en vez de duplicarla.		*
+ *																	*
+ ****************************************************************************************************************************************/
+template <typename TClave, typename TValor> void TCacheFragmentado<TClave, TValor>::Guardar(const TClave &Clave, const TValor &Valor)
+{
+TFragmentoCache							&Frag = Fragmento(Clave);
+std::lock_guard<std::mutex>					Bloqueo(Frag.Mutex);
+typename std::unordered_map<TClave, typename std::list<TEntradaCache>::iterator>::iterator	itIndice;
+
+/* Si ya está, reemplazarla */
+if ( (itIndice=Frag.Indice.find(Clave)) != Frag.Indice.end() )
+    {
+	Frag.Entradas.splice(Frag.Entradas.begin(), Frag.Entradas, itIndice->second);
+	Frag.Entradas.front().Valor=Valor;
+	return;
+    }
+
+/* Si no, agregarla adelante */
+if (Frag.Entradas.size()>=MaximoPorFragmento)
+    {
+	Frag.Indice.erase(Frag.Entradas.back().Clave);
+	Frag.Entradas.pop_back();
+    }
+Frag.Entradas.push_front(TEntradaCache());
+Frag.Entradas.front().Clave=Clave;
+Frag.Entradas.front().Valor=Valor;
+Frag.Indice[Clave]=Frag.Entradas.begin();
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *					 TCacheFragmentado :: Aciertos, Fallos, Entradas						*
+ *																	*
+ * OBJETIVO: Estas funciones devuelven los contadores del cache, sumando todos los fragmentos.						*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función el contador.											*
+ *																	*
+ ****************************************************************************************************************************************/
+template <typename TClave, typename TValor> size_t TCacheFragmentado<TClave, TValor>::Aciertos(void)
+{
+size_t	i, Total;
+
+for (i=0,Total=0;i<FRAGMENTOS_CACHE;i++)
+    {
+	std::lock_guard<std::mutex>	Bloqueo(Fragmentos[i].Mutex);
+	Total+=Fragmentos[i].Aciertos;
+    }
+return(Total);
+}
+
+template <typename TClave, typename TValor> size_t TCacheFragmentado<TClave, TValor>::Fallos(void)
+{
+size_t	i, Total;
+
+for (i=0,Total=0;i<FRAGMENTOS_CACHE;i++)
+    {
+	std::lock_guard<std::mutex>	Bloqueo(Fragmentos[i].Mutex);
+	Total+=Fragmentos[i].Fallos;
+    }
+return(Total);
+}
+
+template <typename TClave, typename TValor> size_t TCacheFragmentado<TClave, TValor>::Entradas(void)
+{
+size_t	i, Total;
+
+for (i=0,Total=0;i<FRAGMENTOS_CACHE;i++)
+    {
+	std::lock_guard<std::mutex>	Bloqueo(Fragmentos[i].Mutex);
+	Total+=Fragmentos[i].Entradas.size();
+    }
+return(Total);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TCacheFragmentado :: Fragmento							*
+ *																	*
+ * OBJETIVO: Esta función devuelve el fragmento donde va una clave.									*
+ *																	*
+ * ENTRADA: Clave: La clave.														*
+ *																	*
+ * SALIDA: En el nombre de la función el fragmento.											*
+ *																	*
+ * OBSERVACIONES: El hash de los enteros es el propio número, así que se mezclan los bits antes de elegir: los inodes o registros	*
+ *		  consecutivos que se leen juntos quedan repartidos entre los fragmentos.						*
+ *																	*
+ ****************************************************************************************************************************************/
+template <typename TClave, typename TValor> typename TCacheFragmentado<TClave, TValor>::TFragmentoCache &TCacheFragmentado<TClave, TValor>::Fragmento(const TClave &Clave)
+{
+unsigned long long	Hash;
+
+Hash=(unsigned long long)std::hash<TClave>()(Clave)*0x9E3779B97F4A7C15ULL;
+return(Fragmentos[(Hash>>32)%FRAGMENTOS_CACHE]);
+}
+
+#endif
@@ -27,6 +27,30 @@ typedef	unsigned long long	__u64;
 /* Clase que utiliza los drivers derivados de esta clase */
 class TAnalizadorFS;
 
+/* Clase por la que los drivers acceden a la imágen */
+class TFuenteBloques;
+
+/* Clase donde se arma lo que se imprime */
+class TBufferSalida;
+
+
+/************************
+ *			*
+ *     Constantes	*
+ *			*
+ ************************/
+/* Tamaño máximo de cada tramo entregado al leer un archivo por partes, cuando la fuente no tiene la imágen contigua en memoria */
+#define	BYTES_MAXIMOS_TRAMO		(1024*1024)
+
+/* Tamaño del bloque de ceros con que se entregan los huecos de los archivos dispersos */
+#define	BYTES_BLOQUE_CEROS		(64*1024)
+
+/* Cantidad máxima de entradas que se recuerdan en el cache de rutas */
+#define	MAXIMO_ENTRADAS_CACHE_RUTAS	16384
+
+/* Cantidad máxima de entradas, sumando todos los directorios, que se guardan indexadas por nombre */
+#define	MAXIMO_ENTRADAS_INDEXADAS	262144
+
 
 /************************
  *			*
@@ -61,6 +85,10 @@ typedef	struct
 	/* Datos calculados */
 	int				ClustersRootDir;
 	int				PrimerClusterRootDir;
+
+	/* Datos del sector FSInfo (sólo FAT32, -1 si no se conocen) */
+	int				ClustersLibres;
+	int				ProximoClusterLibre;
 	
     }	TDatosFSFAT;
 
@@ -71,6 +99,8 @@ typedef	struct
 	__u64				ClusterBitmapBloques;
 	__u64				ClusterTablaINodes;
 	__u64				ClusterTablaBloques;
+	int				Flags;				/* bg_flags (EXT4_BG_*) */
+	__u32				INodesSinUsar;			/* Inodes del final de la tabla que nunca se usaron */
     }	TDatosGrupoFSEXT;
 
 /* Datos de un FS en formato EXT */
@@ -87,9 +117,8 @@ typedef struct
 	int				BytesPorINode;
 	int				PeriodoAgrupadoFlex;
 
-	/* Datos calculados */
+	/* Datos calculados (los descriptores de grupo los levanta el driver a medida que se usan, ver DatosGrupoEXT()) */
 	int				NroGrupos;
-	std::vector<TDatosGrupoFSEXT>	DatosGrupo;
 	
     }	TDatosFSEXT;
 
@@ -174,6 +203,62 @@ typedef struct
 	    }				DatosEspecificos;
     }	TEntradaDirectorio;
 
+/* Tramo contiguo de un archivo leído por partes. Datos apunta directamente a la imágen y sólo es válido durante el llamado */
+typedef struct
+    {
+	const unsigned char		*Datos;
+	__u64				Bytes;
+	__u64				Offset;			/* Posición del tramo dentro del archivo */
+	__u64				BytesArchivo;		/* Tamaño total del archivo */
+    }	TTramoArchivo;
+
+/* Ranura de la tabla de hash de un directorio indexado. Entrada es la posición en el arreglo + 1 (0 = ranura libre) */
+typedef struct
+    {
+	__u32				Hash;
+	__u32				Entrada;
+    }	TRanuraIndice;
+
+/* Directorio listado e indexado por nombre normalizado, en una tabla de direccionamiento abierto con sondeo lineal */
+typedef struct
+    {
+	__u64				IdDirectorio;
+	std::vector<TEntradaDirectorio>	Entradas;
+	std::vector<TRanuraIndice>	Ranuras;			/* Potencia de 2, al menos el doble de las entradas */
+    }	TIndiceDirectorio;
+
+/* Puntero a función que recibe cada tramo de un archivo leído por partes. Si no retorna CODERROR_NINGUNO se corta la lectura */
+typedef	int				(* TpReceptorTramo)(const TTramoArchivo &Tramo, void *pParametroUsuario);
+
+/* Puntero a función que recibe cada entrada al recorrer todo el volumen, con su ruta completa. Si no retorna CODERROR_NINGUNO se
+   corta el recorrido */
+typedef	int				(* TpReceptorEntrada)(const TString &Ruta, const TEntradaDirectorio &Entrada, void *pParametroUsuario);
+
+/* Directorio que falta listar al recorrer todo el volumen */
+typedef struct
+    {
+	TString				Ruta;				/* "" para el raíz */
+	TEntradaDirectorio		Entrada;
+    }	TDirectorioPendiente;
+
+/* Estado de la ruta de un directorio mientras se arman las rutas a partir de los padres */
+typedef	enum
+    {
+	erSIN_ARMAR			= 0,
+	erARMANDO			= 1,
+	erARMADA			= 2,
+	erHUERFANA			= 3				// El padre no existe, o hay un ciclo
+    }	TEstadoRuta;
+
+/* Directorio encontrado al recorrer el volumen sin bajar por el árbol (su padre y su nombre, y la ruta una vez armada) */
+typedef struct
+    {
+	__u64				IdPadre;
+	TString				Nombre;
+	TEstadoRuta			Estado;
+	TString				Ruta;				/* "" para el raíz */
+    }	TDirectorioRecorrido;
+
 
 /********************************
  *				*
@@ -183,26 +268,81 @@ typedef struct
 class TDriverBase
 {
 public:
-					TDriverBase(const unsigned char *DiskData, unsigned LongitudDiskData);
+					TDriverBase(TFuenteBloques *FuenteBloques);
 	virtual				~TDriverBase();
+
+	void				ConfigurarHilos(unsigned Hilos);
+
+	/* Lectura del volumen montado. Se puede llamar desde varios hilos a la vez (ver SerializarLectura()) */
+	virtual int 			ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas) const = 0;
+	virtual int 			LeerArchivo(const char *Path, unsigned char *&Data, __u64 &DataLen) const = 0;
+	virtual int			LeerArchivoPorTramos(const char *Path, TpReceptorTramo Receptor, void *pParametroUsuario) const;
+	virtual int			RecorrerVolumen(TpReceptorEntrada Receptor, void *pParametroUsuario) const;
+	virtual void			MostrarEstadisticas(FILE *f) const;
 	
 protected:
 	TDatosFS			DatosFS;
 
-	virtual const unsigned char	*PunteroASector(__u64 NroSector);
+	virtual const unsigned char	*PunteroASector(__u64 NroSector, __u64 Bytes = 0) const;
+	virtual const unsigned char	*PunteroABytes(__u64 Offset, __u64 Bytes) const;
+	std::unique_lock<std::recursive_mutex>	SerializarLectura(void) const;
 	
 	/* Funciones a implementar por el alumno */
 	virtual int			LevantarDatosSuperbloque() = 0;
-	virtual int 			ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas) = 0;
-	virtual int 			LeerArchivo(const char *Path, unsigned char *&Data, unsigned &DataLen) = 0;
+
+	/* Lectura de archivos por partes, sin copiar los datos */
+	int				LeerArchivoCompleto(const char *Path, unsigned char *&Data, __u64 &DataLen) const;
+	int				EmitirTramo(__u64 Offset, __u64 Bytes, __u64 OffsetArchivo, __u64 BytesArchivo, TpReceptorTramo Receptor, void *pParametroUsuario) const;
+	int				EmitirCeros(__u64 Bytes, __u64 OffsetArchivo, __u64 BytesArchivo, TpReceptorTramo Receptor, void *pParametroUsuario) const;
+
+	/* Resolución de rutas con cache, para los drivers que implementan ListarDirectorioEntrada() */
+	virtual void			EntradaRootDir(TEntradaDirectorio &Entrada) const;
+	virtual int			ListarDirectorioEntrada(const TEntradaDirectorio &Directorio, std::vector<TEntradaDirectorio> &Entradas) const;
+	virtual __u64			IdentificadorDirectorio(const TEntradaDirectorio &Directorio) const;
+	virtual void			NormalizarNombre(TString &Nombre) const;
+	virtual int			BuscarEnDirectorio(const TEntradaDirectorio &Directorio, const TString &Nombre, TEntradaDirectorio &Entrada) const;
+	int				BuscarEntrada(const char *Path, TEntradaDirectorio &Entrada) const;
+	int				ListarDirectorioPorRuta(const char *Path, std::vector<TEntradaDirectorio> &Entradas) const;
+
+	/* Recorrido de todo el volumen */
+	static int			ArmarRutaRecorrido(__u64 IdDirectorio, std::unordered_map<__u64, TDirectorioRecorrido> &Directorios, const TString *&pRuta);
+
+	/* Tareas independientes repartidas entre varios hilos */
+	int				EjecutarEnParalelo(size_t Tareas, TpTarea Tarea, void *pParametroUsuario) const;
+
+	/* Datos de cada grupo de EXT, para los drivers que los levantan a medida que se usan */
+	virtual const TDatosGrupoFSEXT	*DatosGrupoEXT(int NroGrupo) const;
 
 private:
-	unsigned			LongitudDiskData;
-	const unsigned char		*DiskData;
+	TFuenteBloques			*FuenteBloques;
+
+	/* Lecturas de a una, si la fuente no admite varios hilos a la vez */
+	mutable std::recursive_mutex	MutexLectura;
+
+	/* Pool de hilos, que se crea la primera vez que hace falta y lo usa una tanda a la vez */
+	unsigned			HilosParalelos;
+	mutable TPoolTareas		*PoolTareas;
+	mutable std::mutex		MutexPool;
+
+	/* Cache de rutas (padre, nombre) -> entrada. La clave es el identificador del directorio padre seguido del nombre normalizado */
+	mutable TCacheFragmentado<TString, TEntradaDirectorio>	CacheRutas;
+
+	/* Últimos directorios listados, indexados por nombre (el más reciente primero), y su posición en la lista por identificador */
+	mutable std::list< std::shared_ptr<const TIndiceDirectorio> >	DirectoriosIndexados;
+	mutable std::unordered_map<__u64, std::list< std::shared_ptr<const TIndiceDirectorio> >::iterator>	PosicionIndexados;
+	mutable __u64			EntradasIndexadas;
+	mutable std::mutex		MutexIndexados;
+
+	void				ArmarClaveCacheRutas(__u64 IdPadre, const TString &Nombre, TString &Clave) const;
+	int				IndexarDirectorio(const TEntradaDirectorio &Directorio, std::shared_ptr<const TIndiceDirectorio> &pIndice) const;
+	const TEntradaDirectorio	*BuscarEnIndice(const TIndiceDirectorio &Indice, const TString &Nombre) const;
+	static __u32			HashNombre(const TString &Nombre);
 
 	virtual int			MostrarDatosSuperbloque(void);
-	virtual int			MostrarDatosDirectorio(std::vector<TEntradaDirectorio> &Entradas);
-	virtual void 			PrintBuffer(const unsigned char *Buffer, unsigned BufferLen, unsigned BytesPorLinea);
+	virtual int			MostrarDatosDirectorio(std::vector<TEntradaDirectorio> &Entradas, TBufferSalida &Salida) const;
+	virtual void 			PrintBuffer(const unsigned char *Buffer, __u64 BufferLen, unsigned BytesPorLinea, __u64 OffsetInicial, TBufferSalida &Salida) const;
+
+	static int			CopiarTramo(const TTramoArchivo &Tramo, void *pParametroUsuario);
 
 	
 	friend				TAnalizadorFS;
@@ -79,6 +79,72 @@
 /* Bots para determinar las propiedades del INode basado en el campo i_flags (sacados de stat.h) */
 #define EXT3_INDEX_FL			0x00001000
 #define EXT4_EXTENTS_FL			0x00080000
+#define EXT4_INLINE_DATA_FL		0x10000000
+
+/* Flags de los descriptores de grupo (sacados de ext4.h) */
+#define EXT4_BG_INODE_UNINIT		0x0001	/* Inode table/bitmap not in use */
+
+/* Incompat features que este driver sabe leer */
+#define	EXT_FEATURE_INCOMPAT_SOPORTADAS	(EXT2_FEATURE_INCOMPAT_FILETYPE | EXT3_FEATURE_INCOMPAT_RECOVER | EXT2_FEATURE_INCOMPAT_META_BG | \
+					 EXT4_FEATURE_INCOMPAT_EXTENTS | EXT4_FEATURE_INCOMPAT_64BIT | EXT4_FEATURE_INCOMPAT_MMP | \
+					 EXT4_FEATURE_INCOMPAT_FLEX_BG | EXT4_FEATURE_INCOMPAT_EA_INODE | EXT4_FEATURE_INCOMPAT_BG_USE_META_CSUM | \
+					 EXT4_FEATURE_INCOMPAT_LARGEDIR | EXT4_FEATURE_INCOMPAT_INLINE_DATA)
+
+/* Features que sólo existen a partir de EXT4 */
+#define	EXT4_FEATURE_INCOMPAT_PROPIAS	(EXT2_FEATURE_INCOMPAT_META_BG | EXT4_FEATURE_INCOMPAT_EXTENTS | EXT4_FEATURE_INCOMPAT_64BIT | \
+					 EXT4_FEATURE_INCOMPAT_MMP | EXT4_FEATURE_INCOMPAT_FLEX_BG | EXT4_FEATURE_INCOMPAT_EA_INODE | \
+					 EXT4_FEATURE_INCOMPAT_BG_USE_META_CSUM | EXT4_FEATURE_INCOMPAT_LARGEDIR | EXT4_FEATURE_INCOMPAT_INLINE_DATA)
+#define	EXT4_FEATURE_RO_COMPAT_PROPIAS	(EXT4_FEATURE_RO_COMPAT_HUGE_FILE | EXT4_FEATURE_RO_COMPAT_GDT_CSUM | EXT4_FEATURE_RO_COMPAT_DIR_NLINK | \
+					 EXT4_FEATURE_RO_COMPAT_EXTRA_ISIZE | EXT4_FEATURE_RO_COMPAT_QUOTA | EXT4_FEATURE_RO_COMPAT_BIGALLOC | \
+					 EXT4_FEATURE_RO_COMPAT_METADATA_CSUM)
+
+/* Firmas del superbloque y de los nodos del árbol de extents */
+#define	EXT_MAGIC_SUPERBLOQUE		0xEF53
+#define	EXT_MAGIC_EXTENTS		0xF30A
+
+/* Posición del superbloque principal, en bytes */
+#define	EXT_OFFSET_SUPERBLOQUE		1024
+
+/* Punteros a bloques en i_block cuando el inode no usa extents */
+#define	EXT_BLOQUES_DIRECTOS		12
+#define	EXT_BLOQUE_INDIRECTO		12
+
+/* Profundidad máxima del árbol de extents */
+#define	EXT_PROFUNDIDAD_MAXIMA_EXTENTS	5
+
+/* Un extent con más bloques que esto está reservado pero sin inicializar (se lee como ceros) */
+#define	EXT_MAXIMO_LARGO_EXTENT		32768
+
+/* Tamaño del inode original de EXT2, lo que sigue son campos extra (i_extra_isize) */
+#define	EXT_BYTES_INODE_BASICO		128
+
+/* Índice htree de directorios (dir_index): versiones de hash y ubicación de la raíz dentro del bloque 0 */
+#define	EXT_DX_HASH_LEGACY		0
+#define	EXT_DX_HASH_HALF_MD4		1
+#define	EXT_DX_HASH_TEA			2
+#define	EXT_DX_HASH_LEGACY_UNSIGNED	3
+#define	EXT_DX_HASH_HALF_MD4_UNSIGNED	4
+#define	EXT_DX_HASH_TEA_UNSIGNED	5
+#define	EXT_OFFSET_DX_ROOT_INFO		24	/* Después de las entradas "." (12 bytes) y ".." (8 bytes + nombre de 4) */
+#define	EXT_OFFSET_DX_NODE		8	/* Después de una entrada vacía que ocupa todo el bloque */
+#define	EXT_MAXIMO_NIVELES_DX		3
+#define	EXT_HTREE_EOF_32BIT		0x7FFFFFFFu
+#define	EXT_LARGO_MAXIMO_NOMBRE		255
+#define	EXT_FLAGS_UNSIGNED_HASH		0x0002	/* s_flags: la versión del hash va con chars sin signo */
+#define	EXT4_CASEFOLD_FL		0x40000000
+#define	EXT4_ENCRYPT_FL			0x00000800
+
+/* Datos inline: los primeros bytes están en i_block y el resto en el atributo extendido "system.data" dentro del inode */
+#define	EXT_BYTES_INLINE_IBLOCK		60
+#define	EXT_MAGIC_XATTR			0xEA020000
+#define	EXT_XATTR_INDEX_SYSTEM		7
+#define	EXT_XATTR_NOMBRE_INLINE		"data"
+
+/* Cantidad de inodes decodificados que se mantienen en el cache */
+#define	MAXIMO_INODES_CACHE		8192
+
+/* Bytes de la tabla de inodes o de bloques de directorio que se leen juntos al recorrer todo el volumen en orden de disco */
+#define	EXT_BYTES_LOTE_RECORRIDO	(1024*1024)
 
 
 /************************
@@ -87,6 +153,72 @@
  *			*
  ************************/
 
+/* Superbloque (sacado de ext4.h, sólo hasta los campos que se usan) */
+typedef struct __attribute__((packed))
+    {
+	__le32	s_inodes_count;				/* Inodes count */
+	__le32	s_blocks_count_lo;			/* Blocks count */
+	__le32	s_r_blocks_count_lo;			/* Reserved blocks count */
+	__le32	s_free_blocks_count_lo;			/* Free blocks count */
+	__le32	s_free_inodes_count;			/* Free inodes count */
+	__le32	s_first_data_block;			/* First Data Block */
+	__le32	s_log_block_size;			/* Block size */
+	__le32	s_log_cluster_size;			/* Allocation cluster size */
+	__le32	s_blocks_per_group;			/* # Blocks per group */
+	__le32	s_clusters_per_group;			/* # Clusters per group */
+	__le32	s_inodes_per_group;			/* # Inodes per group */
+	__le32	s_mtime;				/* Mount time */
+	__le32	s_wtime;				/* Write time */
+	__le16	s_mnt_count;				/* Mount count */
+	__le16	s_max_mnt_count;			/* Maximal mount count */
+	__le16	s_magic;				/* Magic signature */
+	__le16	s_state;				/* File system state */
+	__le16	s_errors;				/* Behaviour when detecting errors */
+	__le16	s_minor_rev_level;			/* minor revision level */
+	__le32	s_lastcheck;				/* time of last check */
+	__le32	s_checkinterval;			/* max. time between checks */
+	__le32	s_creator_os;				/* OS */
+	__le32	s_rev_level;				/* Revision level */
+	__le16	s_def_resuid;				/* Default uid for reserved blocks */
+	__le16	s_def_resgid;				/* Default gid for reserved blocks */
+	__le32	s_first_ino;				/* First non-reserved inode */
+	__le16  s_inode_size;				/* size of inode structure */
+	__le16	s_block_group_nr;			/* block group # of this superblock */
+	__le32	s_feature_compat;			/* compatible feature set */
+	__le32	s_feature_incompat;			/* incompatible feature set */
+	__le32	s_feature_ro_compat;			/* readonly-compatible feature set */
+	__u8	s_uuid[16];				/* 128-bit uuid for volume */
+	char	s_volume_name[16];			/* volume name */
+	char	s_last_mounted[64];			/* directory where last mounted */
+	__le32	s_algorithm_usage_bitmap;		/* For compression */
+	__u8	s_prealloc_blocks;			/* Nr of blocks to try to preallocate*/
+	__u8	s_prealloc_dir_blocks;			/* Nr to preallocate for dirs */
+	__le16	s_reserved_gdt_blocks;			/* Per group desc for online growth */
+	__u8	s_journal_uuid[16];			/* uuid of journal superblock */
+	__le32	s_journal_inum;				/* inode number of journal file */
+	__le32	s_journal_dev;				/* device number of journal file */
+	__le32	s_last_orphan;				/* start of list of inodes to delete */
+	__le32	s_hash_seed[4];				/* HTREE hash seed */
+	__u8	s_def_hash_version;			/* Default hash version to use */
+	__u8	s_jnl_backup_type;
+	__le16  s_desc_size;				/* size of group descriptor */
+	__le32	s_default_mount_opts;
+	__le32	s_first_meta_bg;			/* First metablock block group */
+	__le32	s_mkfs_time;				/* When the filesystem was created */
+	__le32	s_jnl_blocks[17];			/* Backup of the journal inode */
+	__le32	s_blocks_count_hi;			/* Blocks count */
+	__le32	s_r_blocks_count_hi;			/* Reserved blocks count */
+	__le32	s_free_blocks_count_hi;			/* Free blocks count */
+	__le16	s_min_extra_isize;			/* All inodes have at least # bytes */
+	__le16	s_want_extra_isize; 			/* New inodes should reserve # bytes */
+	__le32	s_flags;				/* Miscellaneous flags */
+	__le16  s_raid_stride;				/* RAID stride */
+	__le16  s_mmp_update_interval;  		/* # seconds to wait in MMP checking */
+	__le64  s_mmp_block;            		/* Block for multi-mount protection */
+	__le32  s_raid_stripe_width;    		/* blocks on all data disks (N*stride)*/
+	__u8	s_log_groups_per_flex;  		/* FLEX_BG group size */
+    }	TSuperBloqueEXT;
+
 /* Descriptor de grupos para EXT2 y EXT3 */
 typedef	struct __attribute__((packed))
     {
@@ -236,6 +368,89 @@ typedef struct __attribute__((packed))
 
 
 
+/* Corrida de bloques lógicos consecutivos de un archivo que también son consecutivos en el disco (BloqueFisico 0 = hueco) */
+typedef struct
+    {
+	__u64		BloqueLogico;
+	__u64		BloqueFisico;
+	__u64		Bloques;
+    }	TRunEXT;
+
+/* Datos de la raíz del índice htree (dx_root_info) */
+typedef struct __attribute__((packed))
+    {
+	__le32		reserved_zero;
+	__u8		hash_version;
+	__u8		info_length;
+	__u8		indirect_levels;
+	__u8		unused_flags;
+    }	TDxRootInfoEXT;
+
+/* Entrada de un nodo del índice htree. En la primera, el lugar del hash lo ocupan limit (2 bytes) y count (2 bytes) */
+typedef struct __attribute__((packed))
+    {
+	__le32		hash;
+	__le32		block;
+    }	TDxEntryEXT;
+
+/* Entrada de un atributo extendido (las del inode empiezan después de un encabezado de 4 bytes con EXT_MAGIC_XATTR) */
+typedef struct __attribute__((packed))
+    {
+	__u8		e_name_len;	/* Length of name */
+	__u8		e_name_index;	/* Attribute name index */
+	__le16		e_value_offs;	/* Offset in disk block of value */
+	__le32		e_value_inum;	/* Inode in which the value is stored */
+	__le32		e_value_size;	/* Size of attribute value */
+	__le32		e_hash;		/* Hash value of name and value */
+	char		e_name[];	/* Attribute name */
+    }	TEntradaXAttrEXT;
+
+/* Inode decodificado junto con su número */
+typedef struct
+    {
+	__u32		NroINode;
+	TINodeEXT	INode;
+    }	TEntradaCacheINodes;
+
+/* Corrida de bloques de un directorio, para leer los de todo el volumen ordenados por su posición en el disco */
+typedef struct
+    {
+	__u64		BloqueFisico;
+	__u64		Bloques;
+	__u32		NroINode;
+    }	TTramoDirectorioEXT;
+
+/* Nombre encontrado al recorrer los bloques de directorio de todo el volumen */
+typedef struct
+    {
+	__u32		INodePadre;
+	size_t		PosicionINode;		// Posición del inode en el inventario de inodes en uso
+	TString		Nombre;
+    }	TNombreEXT;
+
+/* Resultados de un grupo al recorrer el volumen, que cada tarea deja aparte para juntarlos después en orden */
+typedef struct
+    {
+	std::vector<TEntradaDirectorio>		INodes;			// Inodes en uso de la tabla del grupo
+	std::vector<TEntradaCacheINodes>	INodesDirectorio;	// Los que son directorios
+	std::vector<TTramoDirectorioEXT>	Tramos;			// Corridas de esos directorios
+	std::vector<TNombreEXT>			NombresInline;		// Nombres de esos directorios, si son inline
+	size_t					PrimerTramo;		// Corridas que empiezan en el grupo, ya ordenadas
+	size_t					FinTramos;
+	std::vector<TNombreEXT>			Nombres;		// Nombres leídos de esas corridas
+    }	TRecorridoGrupoEXT;
+
+/* Datos que comparten las tareas de un recorrido del volumen */
+class TDriverEXT;
+typedef struct
+    {
+	const TDriverEXT			*pDriver;
+	std::vector<TRecorridoGrupoEXT>		Grupos;
+	std::vector<TEntradaDirectorio>		INodes;			// Inventario de todo el volumen, ordenado por número de inode
+	std::vector<TTramoDirectorioEXT>	Tramos;			// Corridas de todos los directorios, ordenadas por posición
+    }	TRecorridoEXT;
+
+
 /********************************
  *				*
  *	 Clase TDriverEXT	*
@@ -244,15 +459,94 @@ typedef struct __attribute__((packed))
 class TDriverEXT : public TDriverBase
 {
 public:
-					TDriverEXT(const unsigned char *DiskData, unsigned LongitudDiskData);
+					TDriverEXT(TFuenteBloques *FuenteBloques);
 	virtual				~TDriverEXT();
 
+	/* Lectura del volumen montado (ver TDriverBase) */
+	virtual int 			ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas) const;
+	virtual int 			LeerArchivo(const char *Path, unsigned char *&Data, __u64 &DataLen) const;
+	virtual int			LeerArchivoPorTramos(const char *Path, TpReceptorTramo Receptor, void *pParametroUsuario) const;
+	virtual int			RecorrerVolumen(TpReceptorEntrada Receptor, void *pParametroUsuario) const;
+	virtual void			MostrarEstadisticas(FILE *f) const;
+
 protected:
 	/* Funciones a implementar por el alumno */
 	virtual int			LevantarDatosSuperbloque();
-	virtual int 			ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas);
-	virtual int 			LeerArchivo(const char *Path, unsigned char *&Data, unsigned &DataLen);
-	
+
+	/* Resolución de rutas (ver TDriverBase::BuscarEntrada) */
+	virtual void			EntradaRootDir(TEntradaDirectorio &Entrada) const;
+	virtual int			ListarDirectorioEntrada(const TEntradaDirectorio &Directorio, std::vector<TEntradaDirectorio> &Entradas) const;
+	virtual __u64			IdentificadorDirectorio(const TEntradaDirectorio &Directorio) const;
+	virtual int			BuscarEnDirectorio(const TEntradaDirectorio &Directorio, const TString &Nombre, TEntradaDirectorio &Entrada) const;
+	virtual void			NormalizarNombre(TString &Nombre) const;
+
+	/* Recorrido de todo el volumen leyendo las tablas de inodes en orden */
+	int				EscanearGrupoINodes(__u32 NroGrupo, std::vector<TEntradaDirectorio> &INodes,
+							    std::vector<TEntradaCacheINodes> &INodesDirectorio) const;
+	int				JuntarTramosDirectorio(const TEntradaCacheINodes &Directorio, const std::vector<TEntradaDirectorio> &INodes,
+							       std::vector<TTramoDirectorioEXT> &Tramos, std::vector<TNombreEXT> &Nombres) const;
+	int				LeerNombresTramos(const std::vector<TTramoDirectorioEXT> &Tramos, size_t Primero, size_t Fin,
+							  const std::vector<TEntradaDirectorio> &INodes, std::vector<TNombreEXT> &Nombres) const;
+	void				AgregarNombresVolumen(__u32 INodePadre, const std::vector<TEntradaDirectorio> &Entradas,
+							      const std::vector<TEntradaDirectorio> &INodes, std::vector<TNombreEXT> &Nombres) const;
+	static int			TareaInventarioGrupo(size_t NroGrupo, void *pParametroUsuario);
+	static int			TareaTramosGrupo(size_t NroGrupo, void *pParametroUsuario);
+	static int			TareaNombresGrupo(size_t NroGrupo, void *pParametroUsuario);
+	static bool			INodeMenor(const TEntradaDirectorio &Entrada, __u32 NroINode);
+	static bool			TramoMenor(const TTramoDirectorioEXT &Tramo1, const TTramoDirectorioEXT &Tramo2);
+
+	/* Acceso a los inodes y a sus bloques */
+	TSuperBloqueEXT			SuperBloque;
+	unsigned			BytesPorDescriptor;
+	__u64				NumeroDeBloques;
+
+	int				CargarDatosGrupo(__u32 NroGrupo, const TDatosGrupoFSEXT *&pGrupo) const;
+	int				LeerDescriptorGrupo(__u32 NroGrupo, TDatosGrupoFSEXT &DatosGrupo) const;
+	virtual const TDatosGrupoFSEXT	*DatosGrupoEXT(int NroGrupo) const;
+	int				LeerINode(__u32 NroINode, TINodeEXT &INode) const;
+	int				OffsetINode(__u32 NroINode, __u64 &Offset) const;
+	int				DecodificarINode(__u32 NroINode, TINodeEXT &INode) const;
+	void				CopiarINode(const unsigned char *pINode, TINodeEXT &INode) const;
+	int				ArmarRuns(const TINodeEXT &INode, std::vector<TRunEXT> &Runs) const;
+	int				ArmarRunsExtents(const unsigned char *pNodo, unsigned BytesNodo, int Profundidad, std::vector<TRunEXT> &Runs) const;
+	int				ArmarRunsIndirectos(__u64 NroBloque, int Nivel, __u64 &BloqueLogico, __u64 BloquesArchivo, std::vector<TRunEXT> &Runs) const;
+	void				AgregarRun(std::vector<TRunEXT> &Runs, __u64 BloqueLogico, __u64 BloqueFisico, __u64 Bloques) const;
+	int				EmitirRuns(const std::vector<TRunEXT> &Runs, __u64 BytesArchivo, TpReceptorTramo Receptor, void *pParametroUsuario) const;
+	void				CompletarEntrada(__u32 NroINode, const TINodeEXT &INode, TEntradaDirectorio &Entrada) const;
+	int				JuntarEntradasDirectorio(const unsigned char *pRegion, unsigned Bytes, std::vector<TEntradaDirectorio> &Entradas) const;
+
+	/* Archivos y directorios con los datos dentro del inode (inline_data) */
+	int				UbicarDatosInline(__u32 NroINode, __u64 &OffsetImagen, const unsigned char *&pINode, unsigned &OffsetExtra,
+							  unsigned &BytesExtra) const;
+	int				EmitirDatosInline(__u32 NroINode, __u64 BytesArchivo, TpReceptorTramo Receptor, void *pParametroUsuario) const;
+	int				ListarDirectorioInline(__u32 NroINode, std::vector<TEntradaDirectorio> &Entradas) const;
+
+	/* Búsqueda por el índice htree de los directorios */
+	int				BuscarEnNodoDx(const std::vector<TRunEXT> &Runs, const unsigned char *pNodo, unsigned Offset, int Niveles,
+						       __u32 Hash, const TString &Nombre, __u32 &NroINode, TString &NombreDisco) const;
+	int				BuscarEnBloqueDirectorio(const std::vector<TRunEXT> &Runs, __u64 BloqueLogico, const TString &Nombre, __u32 &NroINode,
+								 TString &NombreDisco) const;
+	int				LeerBloqueLogico(const std::vector<TRunEXT> &Runs, __u64 BloqueLogico, const unsigned char *&pBloque) const;
+	__u32				HashNombreDx(const TString &Nombre, int VersionHash) const;
+	static bool			EntradaDirectorioValida(const unsigned char *pBloque, unsigned Offset, unsigned BytesBloque);
+	static __u32			HashLegacyDx(const char *pNombre, int Largo, bool SinSigno);
+	static void			ArmarEntradaHashDx(const char *pNombre, int Largo, __u32 *Entrada, int Palabras, bool SinSigno);
+	static void			TransformarTEADx(__u32 *Buffer, const __u32 *Entrada);
+	static void			TransformarHalfMD4Dx(__u32 *Buffer, const __u32 *Entrada);
+
+	__u64				PrimerClusterDatosGrupo(__u32 NroGrupo, __u64 ClusterTablaINodes) const;
+	bool				GrupoTieneSuperbloque(__u32 NroGrupo) const;
+	static __u64			BytesINode(const TINodeEXT &INode);
+	static time_t			FechaINode(__le32 Segundos, __le32 Extra, bool HayExtra);
+
+	/* Descriptores de grupo, levantados a medida que se usan. Cada uno se escribe una sola vez, bajo MutexGrupos, antes de marcarlo
+	   en GruposCargados; después se lee sin bloquear */
+	mutable std::vector<TDatosGrupoFSEXT>	DatosGrupos;
+	mutable std::atomic<bool>	*GruposCargados;
+	mutable std::mutex		MutexGrupos;
+
+	/* Cache de inodes decodificados */
+	mutable TCacheFragmentado<__u32, TINodeEXT>	CacheINodes;
 };
 
 #endif
@@ -15,6 +15,9 @@
 #define FAT_ARCHIVE	0x20 
 #define FAT_LFN		(FAT_READ_ONLY|FAT_HIDDEN|FAT_SYSTEM|FAT_VOLUME_ID)
 
+/* Marca de fin de cadena en la FAT decodificada, sin importar el formato */
+#define FAT_FIN_DE_CADENA	0xFFFFFFFF
+
 
 /************************
  *			*
@@ -40,6 +43,13 @@ typedef	struct __attribute__((packed))
 	__le32		FileSize;
     }	TDirEntryFAT;
 
+/* Corrida de clusters físicamente contiguos de un archivo */
+typedef	struct
+    {
+	unsigned	PrimerCluster;
+	unsigned	Clusters;
+    }	TExtentFAT;
+
 
 /********************************
  *				*
@@ -49,33 +59,52 @@ typedef	struct __attribute__((packed))
 class TDriverFAT : public TDriverBase
 {
 public:
-					TDriverFAT(const unsigned char *DiskData, unsigned LongitudDiskData);
+					TDriverFAT(TFuenteBloques *FuenteBloques);
 	virtual				~TDriverFAT();
 
+	/* Lectura del volumen montado (ver TDriverBase) */
+	virtual int 			ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas) const;
+	virtual int 			LeerArchivo(const char *Path, unsigned char *&Data, __u64 &DataLen) const;
+	virtual int			LeerArchivoPorTramos(const char *Path, TpReceptorTramo Receptor, void *pParametroUsuario) const;
+
 protected:
 	/* Funciones a implementar por el alumno */
 	virtual int			LevantarDatosSuperbloque();
-	virtual int 			ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas);
-	virtual int 			LeerArchivo(const char *Path, unsigned char *&Data, unsigned &DataLen);
-	virtual const unsigned char* PunteroACluster(unsigned int NroCluster);
+	virtual const unsigned char* PunteroACluster(unsigned int NroCluster) const;
+	__u64 SectorDeCluster(unsigned int NroCluster) const;
 
 
     /* Mis funciones pples */
-    /*Funcion ListarDirectorio (2):: navegadora*/
-    virtual int ListarDirectorio(std::vector<unsigned int> &ClustersDirActual, const char *SubDirs, std::vector<TEntradaDirectorio> &Entradas); 
+    /*Funcion ListarDirectorio (2):: lista un directorio dado por su entrada, para la resolución de rutas de la clase base*/
+    virtual int ListarDirectorioEntrada(const TEntradaDirectorio &Directorio, std::vector<TEntradaDirectorio> &Entradas) const;
     /*Funcion ListarDirectorio (3):: lectora */
-    virtual int ListarDirectorio(std::vector<unsigned int> &Clusters, std::vector<TEntradaDirectorio> &Entradas);
+    virtual int ListarDirectorio(const std::vector<unsigned int> &Clusters, std::vector<TEntradaDirectorio> &Entradas) const;
+    /*Datos que necesita el cache de rutas de la clase base */
+    virtual void EntradaRootDir(TEntradaDirectorio &Entrada) const;
+    virtual __u64 IdentificadorDirectorio(const TEntradaDirectorio &Directorio) const;
+    virtual void NormalizarNombre(TString &Nombre) const;
 
 
     /* Mis funciones auxiliares */
-    /* PopPathComponent :: separar un path en dos partes tomando como separador el primer slash encontrado */
-    void PopPathComponent(const char *pPath, std::string& pComponente, std::string& pResto);
     /*FatTimeToTimeT :: para convertir las fechas de FAT a time stamp */
-    time_t FatTimeToTimeT(__u16 pFatDate, __u16 pFatTime);
+    time_t FatTimeToTimeT(__u16 pFatDate, __u16 pFatTime) const;
     /* Función auxiliar para parsear una entrada de 32 bytes. Rellena una struct tipo TEntradaDirectorio*/
-    bool ParsearEntradaFAT(TDirEntryFAT* pRawEntry, TEntradaDirectorio& pEntrada);
-    /*Sigue la cadena de la FAT y devuelve la lista de clusters.*/
-    virtual int BuscarCadenaDeClusters(unsigned int PrimerCluster,  __u64 Longitud, std::vector<unsigned> &Clusters);
+    bool ParsearEntradaFAT(const TDirEntryFAT* pRawEntry, TEntradaDirectorio& pEntrada) const;
+    /*Sigue la cadena de la FAT y devuelve la lista de clusters (sólo lee SiguienteCluster, que no cambia después de montar)*/
+    virtual int BuscarCadenaDeClusters(unsigned int PrimerCluster,  __u64 Longitud, std::vector<unsigned> &Clusters) const;
+    /*Lee los contadores de clusters libres del sector FSInfo de FAT32*/
+    void LeerFSInfo(unsigned int NroSector);
+    /*Devuelve la cadena de clusters del root (cluster cero en FAT12/16)*/
+    int BuscarClustersRootDir(std::vector<unsigned int> &Clusters) const;
+    /*Decodifica la FAT una sola vez al arreglo SiguienteCluster*/
+    int DecodificarFAT();
+    /*Junta los clusters consecutivos de una cadena en extents (inicio, cantidad)*/
+    static void ArmarExtents(const std::vector<unsigned> &Clusters, std::vector<TExtentFAT> &Extents);
+
+    /* FAT decodificada: siguiente cluster de cada cluster. Se arma al montar y después sólo se lee, desde cualquier hilo */
+    std::vector<__u32> SiguienteCluster;
+    /* Copia de la FAT que se usa (en FAT32 se puede apagar el espejado) */
+    int FATActiva;
     
 
     
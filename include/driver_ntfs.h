@@ -52,6 +52,80 @@
 #define	NTFS_DIRECTORY				0x10000000	// Directory (copy from corresponding bit in MFT record)
 #define	NTFS_INDEX_VIEW				0x20000000	// Index View (copy from corresponding bit in MFT record)
 
+/* Flags para el campo FILE_RECORD_SEGMENT_HEADER.Flags */
+#define	NTFS_REGISTRO_EN_USO			0x0001
+#define	NTFS_REGISTRO_DIRECTORIO		0x0002
+
+/* Flags para el campo ATTRIBUTE_RECORD_HEADER.Flags */
+#define	NTFS_ATRIBUTO_COMPRIMIDO		0x00FF
+#define	NTFS_COMPRESION_LZNT1			0x0001
+#define	NTFS_ATRIBUTO_ENCRIPTADO		0x4000
+#define	NTFS_ATRIBUTO_DISPERSO			0x8000
+
+/* Flags para el campo INDEX_RECORD.Flags */
+#define	NTFS_INDICE_SUBNODO			0x01
+#define	NTFS_INDICE_ULTIMA			0x02
+
+/* Espacios de nombres para el campo FILE_NAME.Flags */
+#define	NTFS_NOMBRE_POSIX			0
+#define	NTFS_NOMBRE_WIN32			1
+#define	NTFS_NOMBRE_DOS				2
+#define	NTFS_NOMBRE_WIN32_Y_DOS			3
+
+/* Firmas de las estructuras */
+#define	NTFS_OEM_ID				"NTFS    "
+#define	NTFS_FIRMA_FILE				"FILE"
+#define	NTFS_FIRMA_INDX				"INDX"
+
+/* Nombre del índice de archivos de un directorio, y la regla con que se ordenan sus entradas (COLLATION_FILE_NAME) */
+#define	NTFS_NOMBRE_INDICE_ARCHIVOS		"$I30"
+#define	NTFS_COLACION_NOMBRE_ARCHIVO		0x00000001
+
+/* Cantidad de caracteres de la tabla $UpCase (uno por cada código UTF-16) */
+#define	NTFS_CARACTERES_UPCASE			65536
+
+/* Cada cuántos bytes de un bloque con fixups (registros del $MFT y buffers de índice) está el número de secuencia */
+#define	NTFS_BYTES_SECTOR_FIXUP			512
+
+/* Las fechas son cantidad de intervalos de 100 ns desde el 1/1/1601 */
+#define	NTFS_INTERVALOS_POR_SEGUNDO		10000000ULL
+#define	NTFS_SEGUNDOS_1601_A_1970		11644473600ULL
+
+/* Máxima profundidad de un árbol de índice (para no quedar en un ciclo si está dañado) */
+#define	NTFS_MAXIMO_NIVELES_INDICE		32
+
+/* Tabla de particiones de un MBR, por si la imágen es de un disco entero */
+#define	NTFS_OFFSET_TABLA_PARTICIONES		446
+#define	NTFS_CANTIDAD_PARTICIONES		4
+#define	NTFS_TIPO_PARTICION			0x07
+#define	NTFS_BYTES_SECTOR_MBR			512
+#define	NTFS_FIRMA_MBR				0xAA55
+
+/* LCN con que se marcan en memoria los data runs dispersos (sin clusters en el disco) */
+#define	NTFS_LCN_DISPERSO			((LCN)-1)
+
+/* Compresión LZNT1: cada unidad de compresión se comprime en bloques de 4 KiB, cada uno con un encabezado de 16 bits */
+#define	NTFS_BYTES_BLOQUE_LZNT1			4096
+#define	NTFS_BLOQUE_LZNT1_COMPRIMIDO		0x8000
+#define	NTFS_LARGO_BLOQUE_LZNT1			0x0FFF
+#define	NTFS_MAXIMO_BYTES_UNIDAD		(1024*1024)
+
+/* Cantidad de registros del $MFT (ya corregidos) que se mantienen en el cache */
+#define	MAXIMO_REGISTROS_CACHE			4096
+
+/* Cantidad de streams ($DATA con sus runs ya decodificados) que se mantienen en el cache */
+#define	MAXIMO_STREAMS_CACHE			1024
+
+/* Separador del nombre de un stream en una ruta (archivo:stream o archivo:stream:$DATA) */
+#define	NTFS_SEPARADOR_STREAM			':'
+#define	NTFS_TIPO_STREAM			"$DATA"
+
+/* Bytes del $MFT que se leen juntos al recorrer todo el volumen en orden de disco */
+#define	NTFS_BYTES_LOTE_MFT			(1024*1024)
+
+/* Referencia completa (registro y número de secuencia) en 64 bits, para identificar a los directorios al armar las rutas */
+#define	NTFS_ID_REFERENCIA(Indice, Secuencia)	((__u64)(Indice) | (__u64)(Secuencia)<<48)
+
 
 
 /************************
@@ -70,6 +144,45 @@ typedef unsigned int			ULONG;
 typedef unsigned long long		LONGLONG;
 typedef unsigned long long		ULONGLONG;
 
+/* Boot sector de un volumen NTFS */
+typedef struct __attribute__((packed))
+    {
+	UCHAR				Jump[3];
+	CHAR				OemId[8];
+	USHORT				BytesPerSector;
+	UCHAR				SectorsPerCluster;		// Si es mayor a 0x80 el valor es 2^(256-SectorsPerCluster)
+	USHORT				ReservedSectors;
+	UCHAR				Unused1[5];
+	UCHAR				MediaDescriptor;
+	UCHAR				Unused2[2];
+	USHORT				SectorsPerTrack;
+	USHORT				NumberOfHeads;
+	ULONG				HiddenSectors;
+	UCHAR				Unused3[8];
+	LONGLONG			TotalSectors;
+	LONGLONG			MftStartLcn;
+	LONGLONG			Mft2StartLcn;
+	CHAR				ClustersPerFileRecordSegment;	// Si es negativo el tamaño en bytes es 2^(-ClustersPerFileRecordSegment)
+	UCHAR				Unused4[3];
+	CHAR				ClustersPerIndexBuffer;		// Idem ClustersPerFileRecordSegment
+	UCHAR				Unused5[3];
+	LONGLONG			VolumeSerialNumber;
+	ULONG				Checksum;
+	UCHAR				BootStrap[426];
+	USHORT				EndOfSectorMarker;
+    }	BOOT_SECTOR;
+
+/* Entrada de la tabla de particiones de un MBR */
+typedef struct __attribute__((packed))
+    {
+	UCHAR				BootIndicator;
+	UCHAR				StartingCHS[3];
+	UCHAR				SystemId;
+	UCHAR				EndingCHS[3];
+	ULONG				StartingSector;
+	ULONG				TotalSectors;
+    }	PARTITION_ENTRY;
+
 /* Encabezado de un elemento del $MFT (sacado de learn.microsoft.com) */
 typedef struct __attribute__((packed))
     {
@@ -193,7 +306,7 @@ typedef struct __attribute__((packed))
 	UCHAR                 		AttributeNameOffset;
 	VCN                   		LowestVcn;
 	FILE_REFERENCE 			SegmentReference;
-	USHORT                		Reserved;
+	USHORT                		AttributeId;
 	WCHAR                 		AttributeName[1];
     }	ATTRIBUTE_LIST_ENTRY;						// La estructura se repite tantas veces como permitan ATTRIBUTE_RECORD_HEADER.RealSize bytes
 
@@ -263,7 +376,7 @@ typedef struct __attribute__((packed))
 
 /* Puntero a función usado por el enumerador de entrdas de índice */
 class TDriverNTFS;
-typedef	int				(TDriverNTFS::* TpColectoraDatosIndice)(INDEX_RECORD *IndexRecord, void *pParametroUsuario);
+typedef	int				(TDriverNTFS::* TpColectoraDatosIndice)(INDEX_RECORD *IndexRecord, void *pParametroUsuario) const;
 
 /* Data Runs tal como los guardo en memoria */
 typedef struct
@@ -272,6 +385,46 @@ typedef struct
 	unsigned	Cantidad;
     }	TDataRun;
 
+/* Un atributo $DATA listo para leer, juntando todos sus fragmentos. Es la entrada del cache de streams */
+typedef struct
+    {
+	USHORT				NroSecuencia;
+	bool				Residente;
+	std::vector<unsigned char>	Valor;				// Si es residente
+	std::vector<TDataRun>		Runs;				// Si no
+	__u64				BytesArchivo;
+	__u64				BytesInicializados;
+	USHORT				Flags;				// Del atributo (NTFS_ATRIBUTO_COMPRIMIDO)
+	unsigned			UnidadCompresion;
+    }	TStreamNTFS;
+
+/* Un nombre (FILE_NAME que no sea sólo DOS) encontrado al recorrer el $MFT */
+typedef struct
+    {
+	__u64				IdPadre;			// NTFS_ID_REFERENCIA del ParentDirectory
+	TEntradaDirectorio		Entrada;			// Con la referencia del registro base
+	bool				EnExtension;			// Si estaba en un registro de extensión
+    }	TNombreMFT;
+
+/* Lo que junta un lote de registros consecutivos del $MFT */
+typedef struct
+    {
+	std::vector<TNombreMFT>		Nombres;			// En el orden de los registros
+	std::vector< std::pair<__u64, __u64> >	TamanosExtension;	// (NTFS_ID_REFERENCIA del registro base, tamaño) de cada $DATA
+									// sin nombre que empieza en un registro de extensión
+    }	TLoteMFT;
+
+/* Datos que comparten las tareas de un recorrido del $MFT */
+typedef struct
+    {
+	const TDriverNTFS		*pDriver;
+	__u64				RegistrosLote;
+	std::vector<TLoteMFT>		Lotes;
+    }	TRecorridoNTFS;
+
+/* Registro del $MFT con los fixups aplicados, compartido entre el cache y quienes lo están usando */
+typedef	std::shared_ptr<const std::vector<unsigned char> >	TRegistroMFT;
+
 /* Estructura usada para devolver bloques de memoria alocados */
 typedef struct
     {
@@ -305,14 +458,97 @@ protected:
 class TDriverNTFS : public TDriverBase
 {
 public:
-					TDriverNTFS(const unsigned char *DiskData, unsigned LongitudDiskData);
+					TDriverNTFS(TFuenteBloques *FuenteBloques);
 	virtual				~TDriverNTFS();
 
+	/* Lectura del volumen montado (ver TDriverBase) */
+	virtual int 			ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas) const;
+	virtual int 			LeerArchivo(const char *Path, unsigned char *&Data, __u64 &DataLen) const;
+	virtual int			LeerArchivoPorTramos(const char *Path, TpReceptorTramo Receptor, void *pParametroUsuario) const;
+	virtual int			RecorrerVolumen(TpReceptorEntrada Receptor, void *pParametroUsuario) const;
+	virtual void			MostrarEstadisticas(FILE *f) const;
+
 protected:
 	/* Funciones a implementar por el alumno */
 	virtual int			LevantarDatosSuperbloque();
-	virtual int 			ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas);
-	virtual int 			LeerArchivo(const char *Path, unsigned char *&Data, unsigned &DataLen);
+
+	/* Resolución de rutas (ver TDriverBase::BuscarEntrada) */
+	virtual void			EntradaRootDir(TEntradaDirectorio &Entrada) const;
+	virtual int			ListarDirectorioEntrada(const TEntradaDirectorio &Directorio, std::vector<TEntradaDirectorio> &Entradas) const;
+	virtual __u64			IdentificadorDirectorio(const TEntradaDirectorio &Directorio) const;
+	virtual void			NormalizarNombre(TString &Nombre) const;
+	virtual int			BuscarEnDirectorio(const TEntradaDirectorio &Directorio, const TString &Nombre, TEntradaDirectorio &Entrada) const;
+
+	/* Recorrido de todo el volumen en el orden del $MFT */
+	int				EscanearLoteMFT(__u64 Primero, __u64 Cantidad, TLoteMFT &Lote) const;
+	int				EscanearRegistroMFT(__u64 IndiceMFT, const FILE_RECORD_SEGMENT_HEADER *pRegistro, TLoteMFT &Lote) const;
+	int				ResolverExtensionMFT(TNombreMFT &Nombre) const;
+	static int			TareaLoteMFT(size_t NroLote, void *pParametroUsuario);
+
+	/* Acceso a los registros del $MFT y a sus atributos */
+	__u64				OffsetParticion;
+	std::vector<TDataRun>		RunsMFT;
+	std::vector<VCN>		VCNsMFT;			// Primer VCN de cada run de RunsMFT, y al final el total
+	__u64				RegistrosMFT;
+
+	/* Cache de registros del $MFT, por número de registro */
+	mutable TCacheFragmentado<__u64, TRegistroMFT>	CacheRegistros;
+
+	int				UbicarBootSector(const BOOT_SECTOR *&pBoot);
+	static int			BytesEstructura(CHAR Clusters, int BytesPorCluster);
+	void				ArmarTablaMFT(std::vector<TDataRun> &Runs);
+	int				LeerRegistroMFT(__u64 IndiceMFT, USHORT NroSecuencia, TRegistroMFT &Registro, const FILE_RECORD_SEGMENT_HEADER *&pRegistro) const;
+	int				CopiarRegistroMFT(__u64 IndiceMFT, unsigned char *pDestino) const;
+	size_t				BuscarRunMFT(VCN NroVCN) const;
+	int				ValidarRegistroMFT(unsigned char *pRegistro) const;
+	int				AplicarFixups(unsigned char *pBloque, unsigned Bytes, const char *Firma) const;
+	int				BuscarAtributo(const FILE_RECORD_SEGMENT_HEADER *pRegistro, ATTRIBUTE_TYPE_CODE Tipo, const char *Nombre,
+						       const ATTRIBUTE_RECORD_HEADER *&pAtributo, int Id = -1) const;
+	int				ValorResidente(const ATTRIBUTE_RECORD_HEADER *pAtributo, const unsigned char *&pValor, __u32 &Bytes) const;
+	int				ParsearDataRuns(const ATTRIBUTE_RECORD_HEADER *pAtributo, std::vector<TDataRun> &Runs) const;
+	int				LeerDeRuns(const std::vector<TDataRun> &Runs, __u64 Offset, __u64 Bytes, unsigned char *pDestino,
+						   size_t PrimerRun = 0, __u64 InicioPrimerRun = 0) const;
+
+	/* Streams ($DATA) con sus runs ya decodificados, por registro base y nombre del stream normalizado */
+	mutable TCacheFragmentado<TString, std::shared_ptr<const TStreamNTFS> >	CacheStreams;
+
+	static int			SepararStream(const char *Path, TString &Ruta, TString &Stream);
+	int				CargarStream(__u64 IndiceMFT, USHORT NroSecuencia, const TString &Nombre, std::shared_ptr<const TStreamNTFS> &pStream) const;
+	int				ArmarStream(const FILE_RECORD_SEGMENT_HEADER *pRegistro, const TString &Nombre, TStreamNTFS &Stream) const;
+	int				ArmarStreamFragmentado(const ATTRIBUTE_RECORD_HEADER *pLista, const TString &Nombre, TStreamNTFS &Stream) const;
+	int				AgregarFragmento(const ATTRIBUTE_RECORD_HEADER *pAtributo, TStreamNTFS &Stream) const;
+	static int			StreamAusente(const TString &Nombre, TStreamNTFS &Stream);
+	int				EmitirStream(const TStreamNTFS &Stream, TpReceptorTramo Receptor, void *pParametroUsuario) const;
+	int				EmitirRuns(const std::vector<TDataRun> &Runs, __u64 BytesArchivo, __u64 BytesInicializados,
+						   TpReceptorTramo Receptor, void *pParametroUsuario) const;
+	int				EmitirRunsComprimidos(const std::vector<TDataRun> &Runs, unsigned ClustersUnidad, __u64 BytesArchivo,
+							      __u64 BytesInicializados, TpReceptorTramo Receptor, void *pParametroUsuario) const;
+	static int			DescomprimirLZNT1(const unsigned char *pOrigen, unsigned BytesOrigen, unsigned char *pDestino,
+							  unsigned BytesDestino);
+
+	/* Recorrido de los índices de los directorios */
+	mutable std::atomic<__u64>	BuffersIndiceLeidos;
+	std::vector<WCHAR>		TablaMayusculas;		// $UpCase, vacía si no se pudo levantar
+
+	int				LeerRaizIndice(__u64 IndiceMFT, std::vector<unsigned char> &Raiz, std::vector<TDataRun> &Runs, unsigned &BytesBuffer) const;
+	int				ParsearIndice(__u64 IndiceMFT, TpColectoraDatosIndice Colectora, void *pParametroUsuario) const;
+	int				ParsearSubArbolIndice(IDX_HEADER *pHeader, unsigned BytesNodo, const std::vector<TDataRun> &Runs, unsigned BytesBuffer,
+							      int Nivel, TpColectoraDatosIndice Colectora, void *pParametroUsuario) const;
+	int				LeerBufferIndice(const std::vector<TDataRun> &Runs, VCN NroVCN, unsigned BytesBuffer,
+							 std::vector<unsigned char> &Buffer, FILE_RECORD_INDEX_HEADER *&pBuffer) const;
+	int				ColectarEntradaDirectorio(INDEX_RECORD *IndexRecord, void *pParametroUsuario) const;
+	static int			ValidarEntradaIndice(IDX_HEADER *pHeader, unsigned Offset, INDEX_RECORD *&pEntrada);
+	static const FILE_NAME		*NombreEntradaIndice(const INDEX_RECORD *pEntrada);
+	static VCN			VCNSubnodo(const INDEX_RECORD *pEntrada);
+
+	/* Comparación de nombres como la hace el índice */
+	int				CargarMayusculas(void);
+	int				CompararNombreIndice(const FILE_NAME *pNombre, const std::vector<WCHAR> &Buscado) const;
+	static void			NombreUTF16(const TString &Nombre, std::vector<WCHAR> &Caracteres);
+
+	void				CompletarEntrada(const FILE_REFERENCE &Referencia, const FILE_NAME *pNombre, TEntradaDirectorio &Entrada) const;
+	static void			NombreUTF8(const unsigned char *pNombre, int Caracteres, TString &Nombre);
+	static time_t			FechaNTFS(ULONGLONG Fecha);
 };
 
 #endif
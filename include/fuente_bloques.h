@@ -0,0 +1,150 @@
+#ifndef	__FUENTE_BLOQUES__H__
+#define	__FUENTE_BLOQUES__H__
+
+/************************
+ *			*
+ *     Constantes	*
+ *			*
+ ************************/
+/* Bytes del comienzo de la imágen que se piden por adelantado al mapearla (boot sector, superbloques, descriptores) */
+#define	LONGITUD_PRECARGA_IMAGEN		(64*1024)
+
+/* Valores por omisión del cache de la fuente pread */
+#define	BYTES_POR_LINEA_CACHE			4096
+#define	BYTES_CACHE_POR_OMISION			(64*1024*1024)
+
+/* Lecturas a partir de este tamaño no pasan por el cache, y tamaño máximo de cada una al leer archivos por partes. Todas las lecturas
+   grandes comparten un solo buffer: su puntero deja de valer con la próxima lectura grande */
+#define	BYTES_LECTURA_GRANDE			(256*1024)
+#define	BYTES_LECTURA_DIRECTA			(1024*1024)
+
+/* Cantidad de líneas usadas más recientemente que nunca se desalojan, sin importar el tamaño del cache. El puntero a una línea vale
+   hasta que se usan otras LINEAS_CACHE_PROTEGIDAS líneas distintas después de ella */
+#define	LINEAS_CACHE_PROTEGIDAS			32
+
+
+/************************
+ *			*
+ *     Estructuras	*
+ *			*
+ ************************/
+/* Formas de acceder a la imágen de disco */
+typedef	enum
+    {
+	mcMEMORIA			= 0,		/* Se lee la imágen completa a un bloque de memoria */
+	mcMAPEADA			= 1,		/* Se mapea la imágen en memoria (mmap) */
+	mcPREAD				= 2		/* Se lee con pread() a pedido, a través de un cache LRU */
+    }	TModoCarga;
+
+/* Línea del cache de la fuente pread. Puede abarcar varias líneas consecutivas si la lectura que la originó las cruzaba */
+typedef	struct
+    {
+	__u64				Clave;
+	__u64				Bytes;
+	unsigned char			*pDatos;
+    }	TLineaCache;
+
+
+/********************************
+ *				*
+ *     Clase TFuenteBloques	*
+ *				*
+ ********************************/
+class TFuenteBloques
+{
+public:
+					TFuenteBloques();
+	virtual				~TFuenteBloques();
+
+	virtual int			Abrir(const char *Ruta) = 0;
+	virtual const unsigned char	*Puntero(__u64 Offset, __u64 Bytes) = 0;
+	virtual void			MostrarEstadisticas(FILE *f);
+	virtual __u64			BytesMaximosPorLectura(void)	{return(~0ULL);};
+	virtual bool			LecturasConcurrentes(void)	{return(false);};
+
+	__u64				Longitud(void)			{return(LongitudImagen);};
+
+protected:
+	__u64				LongitudImagen;
+
+	bool				RangoValido(__u64 Offset, __u64 Bytes);
+};
+
+
+/****************************************
+ *					*
+ *     Clase TFuenteBloquesMemoria	*
+ *					*
+ ****************************************/
+class TFuenteBloquesMemoria : public TFuenteBloques
+{
+public:
+					TFuenteBloquesMemoria();
+	virtual				~TFuenteBloquesMemoria();
+
+	virtual int			Abrir(const char *Ruta);
+	virtual const unsigned char	*Puntero(__u64 Offset, __u64 Bytes);
+	virtual bool			LecturasConcurrentes(void)	{return(true);};
+
+protected:
+	const unsigned char		*DiskData;
+};
+
+
+/****************************************
+ *					*
+ *     Clase TFuenteBloquesMapeada	*
+ *					*
+ ****************************************/
+class TFuenteBloquesMapeada : public TFuenteBloquesMemoria
+{
+public:
+					TFuenteBloquesMapeada();
+	virtual				~TFuenteBloquesMapeada();
+
+	virtual int			Abrir(const char *Ruta);
+
+protected:
+	bool				ImagenMapeada;
+};
+
+
+/****************************************
+ *					*
+ *      Clase TFuenteBloquesPRead	*
+ *					*
+ ****************************************/
+/* A diferencia de las otras fuentes, los punteros que devuelve Puntero() no valen mientras dure la imágen: ver las constantes de arriba.
+   Quien necesite dos lecturas grandes a la vez, o conservar datos más allá de eso, tiene que copiarlos */
+class TFuenteBloquesPRead : public TFuenteBloques
+{
+public:
+					TFuenteBloquesPRead(__u64 BytesCache);
+	virtual				~TFuenteBloquesPRead();
+
+	virtual int			Abrir(const char *Ruta);
+	virtual const unsigned char	*Puntero(__u64 Offset, __u64 Bytes);
+	virtual void			MostrarEstadisticas(FILE *f);
+	virtual __u64			BytesMaximosPorLectura(void)	{return(BYTES_LECTURA_DIRECTA);};
+
+protected:
+	FILE				*Archivo;
+	__u64				BytesMaximosCache;
+	__u64				BytesEnCache;
+	std::list<TLineaCache>		Lineas;
+	std::unordered_map<__u64, std::list<TLineaCache>::iterator>	IndiceLineas;
+	unsigned char			*pLecturaGrande;
+	__u64				BytesLecturaGrande;
+
+	/* Estadísticas */
+	__u64				Aciertos;
+	__u64				Fallos;
+	__u64				Desalojos;
+	__u64				BytesLeidos;
+
+	bool				LeerRango(__u64 Offset, __u64 Bytes, unsigned char *pDestino);
+	void				Desalojar(void);
+	void				VaciarCache(void);
+};
+
+#endif
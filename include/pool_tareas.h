@@ -0,0 +1,67 @@
+#ifndef	__POOL_TAREAS__H__
+#define	__POOL_TAREAS__H__
+
+/************************
+ *			*
+ *     Constantes	*
+ *			*
+ ************************/
+/* Cantidad máxima de hilos de un pool, aunque la máquina tenga más núcleos */
+#define	MAXIMO_HILOS_POOL			64
+
+
+/************************
+ *			*
+ *     Estructuras	*
+ *			*
+ ************************/
+/* Función que ejecuta una tarea del pool. Si devuelve un error no se empiezan las tareas que vienen después */
+typedef int (* TpTarea)(size_t NroTarea, void *pParametroUsuario);
+
+/* Tareas pendientes de un hilo, de Primera a Fin-1: el hilo las toma desde adelante y los demás le roban desde atrás */
+typedef struct
+    {
+	std::mutex			Mutex;
+	size_t				Primera;
+	size_t				Fin;
+    }	TColaTareas;
+
+
+/********************************
+ *				*
+ *      Clase TPoolTareas	*
+ *				*
+ ********************************/
+class TPoolTareas
+{
+public:
+					TPoolTareas(unsigned Hilos);
+	virtual				~TPoolTareas();
+
+	int				Ejecutar(size_t Tareas, TpTarea Tarea, void *pParametroUsuario);
+	unsigned			Hilos(void)			{return(CantidadHilos);};
+
+protected:
+	unsigned			CantidadHilos;
+	std::vector<std::thread>	Trabajadores;
+	TColaTareas			*Colas;
+
+	/* Tanda de tareas en curso */
+	std::mutex			Mutex;
+	std::condition_variable		HayTanda;
+	std::condition_variable		TandaTerminada;
+	unsigned			NroTanda;
+	unsigned			HilosOcupados;
+	bool				Terminar;
+	TpTarea				Tarea;
+	void				*pParametroUsuario;
+	std::atomic<size_t>		PrimeraFallida;
+	int				CodErrorFallida;
+
+	void				Trabajar(unsigned NroHilo);
+	bool				TomarTarea(unsigned NroHilo, size_t &NroTarea);
+	void				RegistrarError(size_t NroTarea, int CodError);
+	static void			Hilo(TPoolTareas *pPool, unsigned NroHilo);
+};
+
+#endif
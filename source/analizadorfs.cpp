@@ -31,8 +31,13 @@ TAnalizadorFS::TAnalizadorFS()
 struct winsize WinSize;
 
 /* Inicialziar variables */
-LongitudDiskData=0;
-DiskData=NULL;
+ModoCarga=mcMAPEADA;
+BytesCache=BYTES_CACHE_POR_OMISION;
+MostrarEstadisticas=false;
+HilosParalelos=0;
+EjecutarEnLote=false;
+AgruparPorDirectorio=false;
+FuenteBloques=NULL;
 DriverFS=NULL;
 
 /* Levantar el ancho de la pantalla */
@@ -97,7 +102,7 @@ if ( (CodError=CargarImagen(Ruta)) != CODERROR_NINGUNO)
 
 /* Ver si la imágen es FAT */
 printf("Analizando imágen con driver FAT12/FAT16/FAT32 ...\n");
-DriverFS=new TDriverFAT(DiskData, LongitudDiskData);
+DriverFS=new TDriverFAT(FuenteBloques);
 CodError=DriverFS->LevantarDatosSuperbloque();
 if ( (CodError==CODERROR_SUPERBLOQUE_INVALIDO) || (CodError==CODERROR_FILESYSTEM_DESCONOCIDO) )
     {
@@ -106,7 +111,7 @@ if ( (CodError==CODERROR_SUPERBLOQUE_INVALIDO) || (CodError==CODERROR_FILESYSTEM
 	delete DriverFS;
 
 	printf("Analizando imágen con driver EXT2/EXT3/EXT4 ...\n");
-	DriverFS=new TDriverEXT(DiskData, LongitudDiskData);
+	DriverFS=new TDriverEXT(FuenteBloques);
 	CodError=DriverFS->LevantarDatosSuperbloque();
 	if ( (CodError==CODERROR_SUPERBLOQUE_INVALIDO) || (CodError==CODERROR_FILESYSTEM_DESCONOCIDO) )
 	    {
@@ -115,7 +120,7 @@ if ( (CodError==CODERROR_SUPERBLOQUE_INVALIDO) || (CodError==CODERROR_FILESYSTEM
 		delete DriverFS;
 
 		printf("Analizando imágen con driver NTFS ...\n");
-		DriverFS=new TDriverNTFS(DiskData, LongitudDiskData);
+		DriverFS=new TDriverNTFS(FuenteBloques);
 		CodError=DriverFS->LevantarDatosSuperbloque();
 		if ( (CodError==CODERROR_SUPERBLOQUE_INVALIDO) || (CodError==CODERROR_FILESYSTEM_DESCONOCIDO) )
 			printf("ERROR: La imágen no es NTFS.\n");
@@ -124,12 +129,21 @@ if ( (CodError==CODERROR_SUPERBLOQUE_INVALIDO) || (CodError==CODERROR_FILESYSTEM
 if (CodError!=CODERROR_NINGUNO)
 	return(CodError);
 printf("ÉXITO: Imágen válida.\n");
+DriverFS->ConfigurarHilos(HilosParalelos);
 
 /* Mostrar los datos del Filesystem */
 DriverFS->MostrarDatosSuperbloque();
 
 /* Ejecutar los tests */
-if ( (CodError=EjecutarTests()) != CODERROR_NINGUNO)
+CodError=EjecutarTests();
+
+/* Si lo pidieron, mostrar cómo les fue a los caches de lectura y de rutas (por stderr, para no alterar la salida) */
+if (MostrarEstadisticas)
+    {
+	FuenteBloques->MostrarEstadisticas(stderr);
+	DriverFS->MostrarEstadisticas(stderr);
+    }
+if (CodError!=CODERROR_NINGUNO)
 	return(CodError);
 
 /* Salir */
@@ -143,23 +157,63 @@ return(CODERROR_NINGUNO);
  *																	*
  * OBJETIVO: Esta función carga el archivo <nombre-ejecutable>_tests.txt y ejecuta cada uno de los comandos.				*
  *																	*
- * ENTRADA: Ruta: Ruta al archivo binario a cargar.											*
+ * ENTRADA: Nada.															*
  *																	*
  * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
  *																	*
+ * OBSERVACIONES: Si una línea tiene errores se ejecutan igual los comandos anteriores, como si se fueran leyendo de a uno. En modo	*
+ *		  lote se reparten entre varios hilos (ver EjecutarTestsEnLote()), pero la salida es la misma.				*
+ *																	*
  ****************************************************************************************************************************************/
 int TAnalizadorFS::EjecutarTests()
 {
-int	CodError = CODERROR_NINGUNO;
-char	aux[1024];
-char	Delimiters[] = " \t";
-char	*p;
-FILE	*f;
+int				CodError, CodErrorArchivo;
+std::vector<TComandoTest>	Comandos;
+size_t				i;
+
+/* Levantar todos los comandos */
+CodErrorArchivo=LeerArchivoTests(Comandos);
+
+/* Ejecutarlos, de a uno o en lote */
+if (EjecutarEnLote)
+	CodError=EjecutarTestsEnLote(Comandos);
+else
+	for (i=0,CodError=CODERROR_NINGUNO;(CodError==CODERROR_NINGUNO)&&(i<Comandos.size());i++)
+		CodError=EjecutarComando(Comandos[i], stdout);
+if (CodError!=CODERROR_NINGUNO)
+	return(CodError);
+
+/* Salir */
+return(CodErrorArchivo);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TAnalizadorFS :: LeerArchivoTests							*
+ *																	*
+ * OBJETIVO: Esta función carga el archivo <nombre-ejecutable>_tests.txt e interpreta todos sus comandos.				*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Comandos: Los comandos, en el orden del archivo. Si hay una línea con errores, los que están antes de ella.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::LeerArchivoTests(std::vector<TComandoTest> &Comandos)
+{
+int		CodError = CODERROR_NINGUNO;
+char		aux[1024];
+char		Delimiters[] = " \t";
+char		*p;
+FILE		*f;
+TComandoTest	Comando;
 
 /* Armar el nombre del archivo de comandos */
 sprintf(aux, "%s_tests.txt", __progname_full);
 
 /* Abrir el archivo de comandos */
+Comandos.clear();
 if ( (f=fopen(aux, "r")) == NULL )
 	return(CODERROR_FALTA_ARCHIVO_DE_COMANDOS);
 
@@ -179,109 +233,460 @@ while ( (CodError==CODERROR_NINGUNO) && (fgets(aux, sizeof(aux), f)) )
 	p=strtok(aux, Delimiters);
 	if (!strcasecmp(p, "dir"))
 	    {
-		/* Quieren ejecutar un DIR */
-
-		/* Primero debería venir el directorio */
-		p=strtok(NULL, Delimiters);
-		if (!p)
-			return(CODERROR_COMANDO_CON_ERRORES);
-	
-		/* Listar el contenido del directorio */
-		CodError=MostrarContenidoDirectorio(p);
+		/* Quieren ejecutar un DIR, primero debería venir el directorio */
+		Comando.Tipo=ctDIR;
+		if ( (p=strtok(NULL, Delimiters)) == NULL )
+			CodError=CODERROR_COMANDO_CON_ERRORES;
 	    }
 	else if (!strcasecmp(p, "cat"))
 	    {
-		/* Quieren ejecutar un CAT */
-		
-		/* Primero debería venir la ruta completa al archivo */
-		p=strtok(NULL, Delimiters);
-		if (!p)
-			return(CODERROR_COMANDO_CON_ERRORES);
-	
-		/* Listar el contenido del directorio */
-		CodError=MostrarContenidoArchivo(p);
+		/* Quieren ejecutar un CAT, primero debería venir la ruta completa al archivo */
+		Comando.Tipo=ctCAT;
+		if ( (p=strtok(NULL, Delimiters)) == NULL )
+			CodError=CODERROR_COMANDO_CON_ERRORES;
+	    }
+	else if (!strcasecmp(p, "tree"))
+	    {
+		/* Quieren ejecutar un TREE, que lista todo el volumen */
+		Comando.Tipo=ctTREE;
+		p=NULL;
 	    }
 	else
 	    {
 		/* Comando desconocido */
-		return(CODERROR_COMANDO_DESCONOCIDO);
+		CodError=CODERROR_COMANDO_DESCONOCIDO;
+	    }
+
+	/* Guardarlo */
+	if (CodError==CODERROR_NINGUNO)
+	    {
+		Comando.Ruta=p ? p : "";
+		Comandos.push_back(Comando);
 	    }
     }
 
 /* Cerrar el archivo de comandos */
 fclose(f);
 
-/* Salir indicando éxito */
-return(CODERROR_NINGUNO);
+/* Salir */
+return(CodError);
 }
 
 
 /****************************************************************************************************************************************
  *																	*
- *						      TAnalizadorFS :: CargarImagen							*
+ *						    TAnalizadorFS :: EjecutarComando							*
  *																	*
- * OBJETIVO: Esta función carga una nueva imágen de disco para analizar.								*
+ * OBJETIVO: Esta función ejecuta un comando del archivo de tests.									*
  *																	*
- * ENTRADA: Ruta: Ruta al archivo binario a cargar.											*
+ * ENTRADA: Comando: El comando.													*
+ *	    f: Dónde imprimir el resultado.												*
  *																	*
  * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
  *																	*
  ****************************************************************************************************************************************/
-int TAnalizadorFS::CargarImagen(const char *Ruta)
+int TAnalizadorFS::EjecutarComando(const TComandoTest &Comando, FILE *f)
 {
-int		CodError = CODERROR_NINGUNO;
-FILE		*f;
+switch (Comando.Tipo)
+    {
+	case ctDIR:
+		return(MostrarContenidoDirectorio(Comando.Ruta.c_str(), f));
+	case ctCAT:
+		return(MostrarContenidoArchivo(Comando.Ruta.c_str(), f));
+	case ctTREE:
+		return(MostrarVolumen(f));
+    }
 
-/* Voy a cargar una nueva imágen, borrar todo */
-BorrarTodoYReinicializar();
+/* Salir */
+return(CODERROR_COMANDO_DESCONOCIDO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TAnalizadorFS :: EjecutarTestsEnLote							*
+ *																	*
+ * OBJETIVO: Esta función ejecuta los comandos del archivo de tests repartiéndolos entre varios hilos, e imprime los resultados en el	*
+ *	     orden original.														*
+ *																	*
+ * ENTRADA: Comandos: Los comandos.													*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código del primero que falló.		*
+ *																	*
+ * OBSERVACIONES: Se ejecutan de a COMANDOS_POR_TANDA. El comando más viejo que no terminó escribe directamente en stdout; los demás	*
+ *		  guardan su salida hasta que les toca, en memoria de a bloques de BYTES_BLOQUE_TEMPORAL bytes mientras la tanda no	*
+ *		  junte más de BYTES_SALIDA_EN_MEMORIA, y si no en un archivo temporal. Así la salida es idéntica a ejecutarlos de a	*
+ *		  uno, hasta el primero que falló inclusive, y un comando con mucha salida no la acumula en memoria. Una vez que falla	*
+ *		  uno no se empieza ninguno posterior. Si se agrupan por directorio, dentro de cada tanda se ordenan por el directorio	*
+ *		  que tocan: los hilos se llevan tramos consecutivos y cada uno reusa lo que ya quedó en los caches de rutas al		*
+ *		  resolver el anterior.													*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::EjecutarTestsEnLote(const std::vector<TComandoTest> &Comandos)
+{
+int					CodError;
+size_t					i, Cantidad;
+TPoolTareas				*Pool;
+TTandaComandos				Tanda;
+std::vector< std::pair<TString, size_t> >	Claves;
+
+/* Inicializar variables */
+Pool=new TPoolTareas(HilosParalelos);
+Tanda.Analizador=this;
+Tanda.Comandos=&Comandos;
+Tanda.PrimerFallo=Comandos.size();
+Tanda.CodError=CODERROR_NINGUNO;
+Tanda.Temporal=NULL;
+CodError=CODERROR_NINGUNO;
 
-/* Abrir el archivo de entrada */
-if ( (f=fopen(Ruta, "rb")) == NULL )
+/* Para cada tanda de comandos */
+for (Tanda.Primero=0;(CodError==CODERROR_NINGUNO)&&(Tanda.Primero<Comandos.size());Tanda.Primero+=Cantidad)
     {
-	/* No puedo abrirlo, salir */
-	CodError = CODERROR_ARCHIVO_INEXISTENTE;
+	/* Elegir en qué orden se ejecutan */
+	Cantidad=Comandos.size()-Tanda.Primero<COMANDOS_POR_TANDA ? Comandos.size()-Tanda.Primero : COMANDOS_POR_TANDA;
+	Tanda.Orden.resize(Cantidad);
+	if (AgruparPorDirectorio)
+	    {
+		Claves.resize(Cantidad);
+		for (i=0;i<Cantidad;i++)
+		    {
+			DirectorioComando(Comandos[Tanda.Primero+i], Claves[i].first);
+			Claves[i].second=Tanda.Primero+i;
+		    }
+		std::sort(Claves.begin(), Claves.end());
+		for (i=0;i<Cantidad;i++)
+			Tanda.Orden[i]=Claves[i].second;
+	    }
+	else
+	    {
+		for (i=0;i<Cantidad;i++)
+			Tanda.Orden[i]=Tanda.Primero+i;
+	    }
+
+	/* Preparar los resultados. El primero de la tanda ya puede escribir directamente */
+	Tanda.Resultados.assign(Cantidad, TResultadoComando());
+	for (i=0;i<Cantidad;i++)
+	    {
+		Tanda.Resultados[i].CodError=CODERROR_NINGUNO;
+		Tanda.Resultados[i].Terminado=false;
+		Tanda.Resultados[i].Directo=false;
+	    }
+	Tanda.Resultados[0].Directo=true;
+	Tanda.Turno=Tanda.Primero;
+	Tanda.BytesEnMemoria=0;
+	Tanda.BytesTemporal=0;
+
+	/* Ejecutarlos. Las tareas no fallan nunca: cada comando que termina imprime lo que esté en turno, y el error del primero que
+	   falló queda en la tanda al imprimirlo */
+	Pool->Ejecutar(Cantidad, EjecutarComandoDeTanda, &Tanda);
+	CodError=Tanda.CodError;
     }
-else
+
+/* Liberar recursos */
+if (Tanda.Temporal)
+	fclose(Tanda.Temporal);
+delete Pool;
+
+/* Salir */
+return(CodError);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TAnalizadorFS :: EjecutarComandoDeTanda						*
+ *																	*
+ * OBJETIVO: Tarea del pool que ejecuta un comando de la tanda, guardando lo que imprime hasta que le toque.				*
+ *																	*
+ * ENTRADA: NroTarea: Número de tarea, que indica el comando a ejecutar a través de TTandaComandos::Orden.				*
+ *	    pParametroUsuario: Puntero a la TTandaComandos.										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO.											*
+ *																	*
+ * OBSERVACIONES: Devuelve siempre CODERROR_NINGUNO: con los comandos agrupados el número de tarea no sigue el orden del archivo, y	*
+ *		  si el pool dejara de empezar las tareas siguientes podría saltear comandos anteriores al que falló. En cambio cada	*
+ *		  tarea mira antes de empezar si ya falló un comando anterior al suyo, y en ese caso no lo ejecuta.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::EjecutarComandoDeTanda(size_t NroTarea, void *pParametroUsuario)
+{
+TTandaComandos		*pTanda = (TTandaComandos *)pParametroUsuario;
+TSalidaComando		Salida;
+cookie_io_functions_t	Funciones = {NULL, EscribirSalidaComando, NULL, NULL};
+TResultadoComando	*pResultado;
+FILE			*f;
+int			CodError;
+bool			Omitir;
+
+/* Ubicar el comando, y ver si todavía hace falta */
+Salida.pTanda=pTanda;
+Salida.NroComando=pTanda->Orden[NroTarea];
     {
-	/* Determinar el tamaño */
-	fseek(f, 0, SEEK_END);
-	LongitudDiskData=ftell(f);
-	fseek(f, 0, SEEK_SET);
-	
-	/* Validar la longitud del archivo */
-	if ( (LongitudDiskData%512) != 0 )
+	std::lock_guard<std::mutex>	Bloqueo(pTanda->Mutex);
+	Omitir=Salida.NroComando>pTanda->PrimerFallo;
+    }
+
+/* Ejecutarlo, imprimiendo a través de EscribirSalidaComando() */
+CodError=CODERROR_NINGUNO;
+if (!Omitir)
+    {
+	if ( (f=fopencookie(&Salida, "w", Funciones)) == NULL )
+		CodError=CODERROR_FALTA_MEMORIA;
+	else
 	    {
-		/* No puede no ser múltiplo de sector */
-		CodError = CODERROR_ARCHIVO_INVALIDO;
+		CodError=pTanda->Analizador->EjecutarComando((*pTanda->Comandos)[Salida.NroComando], f);
+		fclose(f);
 	    }
-	else
+    }
+
+/* Marcarlo terminado, y si era el que estaba imprimiendo pasar el turno a los siguientes */
+std::unique_lock<std::mutex>	Bloqueo(pTanda->Mutex);
+pResultado=&pTanda->Resultados[Salida.NroComando-pTanda->Primero];
+pResultado->Terminado=true;
+pResultado->CodError=CodError;
+if ( (CodError!=CODERROR_NINGUNO) && (Salida.NroComando<pTanda->PrimerFallo) )
+	pTanda->PrimerFallo=Salida.NroComando;
+if (pResultado->Directo)
+	ImprimirTurnos(*pTanda, Bloqueo);
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TAnalizadorFS :: EscribirSalidaComando							*
+ *																	*
+ * OBJETIVO: Esta función recibe lo que imprime un comando ejecutado en lote (es la función de escritura de fopencookie()).		*
+ *																	*
+ * ENTRADA: pCookie: El TSalidaComando del comando.											*
+ *	    Buffer, Bytes: Lo que imprimió.												*
+ *																	*
+ * SALIDA: En el nombre de la función los bytes escritos.										*
+ *																	*
+ * OBSERVACIONES: Si le toca escribe directamente en stdout, sin bloquear la tanda mientras tanto; el turno sólo pasa a otro comando	*
+ *		  cuando éste termina. Si no, lo guarda hasta que le toque. Lo de un comando posterior al que falló se descarta.	*
+ *																	*
+ ****************************************************************************************************************************************/
+ssize_t TAnalizadorFS::EscribirSalidaComando(void *pCookie, const char *Buffer, size_t Bytes)
+{
+TSalidaComando			*pSalida = (TSalidaComando *)pCookie;
+TTandaComandos			&Tanda = *pSalida->pTanda;
+TResultadoComando		*pResultado;
+std::unique_lock<std::mutex>	Bloqueo(Tanda.Mutex);
+
+/* Si le toca, directamente a stdout */
+pResultado=&Tanda.Resultados[pSalida->NroComando-Tanda.Primero];
+if (pResultado->Directo)
+    {
+	Bloqueo.unlock();
+	return(fwrite(Buffer, 1, Bytes, stdout));
+    }
+
+/* Si no, guardarlo. Si el comando juntó un bloque, o la tanda se pasa de lo que puede tener en memoria, mandar lo del comando al
+   archivo temporal */
+if (pSalida->NroComando>Tanda.PrimerFallo)
+	return(Bytes);
+pResultado->Memoria.insert(pResultado->Memoria.end(), Buffer, Buffer+Bytes);
+Tanda.BytesEnMemoria+=Bytes;
+if ( (pResultado->Memoria.size()>=BYTES_BLOQUE_TEMPORAL) || (Tanda.BytesEnMemoria>BYTES_SALIDA_EN_MEMORIA) )
+	VolcarEnTemporal(Tanda, *pResultado);
+
+/* Salir */
+return(Bytes);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TAnalizadorFS :: VolcarEnTemporal							*
+ *																	*
+ * OBJETIVO: Esta función pasa al archivo temporal de la tanda lo que un comando tiene en memoria.					*
+ *																	*
+ * ENTRADA: Tanda: La tanda, bloqueada.													*
+ *	    Resultado: El resultado del comando.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Todos los comandos de la tanda comparten el archivo, cada uno con la lista de los tramos que escribió en él. El	*
+ *		  archivo se reusa de una tanda a otra, porque al terminar cada una ya se imprimió todo. Si no se puede crear o		*
+ *		  escribir, la salida queda en memoria.											*
+ *																	*
+ ****************************************************************************************************************************************/
+void TAnalizadorFS::VolcarEnTemporal(TTandaComandos &Tanda, TResultadoComando &Resultado)
+{
+size_t	Bytes;
+
+/* Crear el archivo la primera vez */
+if ( (!Tanda.Temporal) && ((Tanda.Temporal=tmpfile()) == NULL) )
+	return;
+
+/* Escribirlo a continuación de lo último */
+Bytes=Resultado.Memoria.size();
+if (pwrite(fileno(Tanda.Temporal), &Resultado.Memoria[0], Bytes, Tanda.BytesTemporal) != (ssize_t)Bytes)
+	return;
+Resultado.Volcados.push_back(std::make_pair(Tanda.BytesTemporal, Bytes));
+Tanda.BytesTemporal+=Bytes;
+Tanda.BytesEnMemoria-=Bytes;
+std::vector<char>().swap(Resultado.Memoria);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TAnalizadorFS :: ImprimirTurnos							*
+ *																	*
+ * OBJETIVO: Esta función pasa el turno de imprimir a los comandos siguientes, una vez que terminó el que lo tenía.			*
+ *																	*
+ * ENTRADA: Tanda: La tanda.														*
+ *	    Bloqueo: El bloqueo de la tanda, tomado.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Imprime lo que guardó cada comando siguiente. Los que ya terminaron ceden el turno al que sigue; el primero que	*
+ *		  no terminó se queda con el turno y desde ahí escribe directamente. Lo guardado se imprime con la tanda		*
+ *		  desbloqueada, así los demás comandos no esperan, y se repite hasta que no quede nada (el comando puede seguir		*
+ *		  imprimiendo mientras tanto). Al llegar a uno que falló, el turno ya no pasa a nadie.					*
+ *																	*
+ ****************************************************************************************************************************************/
+void TAnalizadorFS::ImprimirTurnos(TTandaComandos &Tanda, std::unique_lock<std::mutex> &Bloqueo)
+{
+TResultadoComando			*pResultado;
+std::vector<char>			Memoria;
+std::vector< std::pair<__u64, size_t> >	Volcados;
+std::vector<char>			Lectura;
+size_t					i, Bytes;
+__u64					Offset, Restantes;
+ssize_t					Leidos;
+bool					Leido;
+
+while (Tanda.Turno<Tanda.Primero+Tanda.Resultados.size())
+    {
+	/* Imprimir lo que tenga guardado */
+	pResultado=&Tanda.Resultados[Tanda.Turno-Tanda.Primero];
+	Leido=true;
+	while ( (Leido) && (!pResultado->Directo) && ((!pResultado->Volcados.empty()) || (!pResultado->Memoria.empty())) )
 	    {
-		/* Alocar memoria para almacenarlo */
-		if ( (DiskData=(const unsigned char *)malloc(LongitudDiskData)) == NULL )
-		    {
-			/* No hay suficiente memoria */
-			CodError = CODERROR_FALTA_MEMORIA;
-		    }
-		else
-		    {
-			/* Levantar el archivo a memoria */
-			if ( fread((void *)DiskData, 1, LongitudDiskData, f) != LongitudDiskData )
+		Volcados.swap(pResultado->Volcados);
+		Memoria.swap(pResultado->Memoria);
+		Tanda.BytesEnMemoria-=Memoria.size();
+		Bloqueo.unlock();
+		for (i=0;(Leido)&&(i<Volcados.size());i++)
+			for (Offset=Volcados[i].first,Restantes=Volcados[i].second;(Leido)&&(Restantes);Offset+=Leidos,Restantes-=Leidos)
 			    {
-				/* Error al levantar el archivo */
-				CodError = CODERROR_LECTURA_DISCO;
+				Lectura.resize(BYTES_BLOQUE_TEMPORAL);
+				Bytes=Restantes<BYTES_BLOQUE_TEMPORAL ? Restantes : BYTES_BLOQUE_TEMPORAL;
+				if ( (Leidos=pread(fileno(Tanda.Temporal), &Lectura[0], Bytes, Offset)) <= 0 )
+				    {
+					Leido=false;
+					break;
+				    }
+				fwrite(&Lectura[0], 1, Leidos, stdout);
 			    }
-		    }
+		if ( (Leido) && (!Memoria.empty()) )
+			fwrite(&Memoria[0], 1, Memoria.size(), stdout);
+		Volcados.clear();
+		Memoria.clear();
+		Bloqueo.lock();
+	    }
+
+	/* Si no se pudo leer el archivo temporal, o el comando falló, no se imprime nada más */
+	if ( (!Leido) || ((pResultado->Terminado) && (pResultado->CodError!=CODERROR_NINGUNO)) )
+	    {
+		Tanda.CodError=Leido ? pResultado->CodError : CODERROR_LECTURA_DISCO;
+		if (Tanda.Turno<Tanda.PrimerFallo)
+			Tanda.PrimerFallo=Tanda.Turno;
+		Tanda.Turno=Tanda.Primero+Tanda.Resultados.size();
+		return;
 	    }
 
-	/* Cerrar el archivo de entrada */
-	fclose(f);
+	/* Si todavía no terminó se queda con el turno, y desde ahora escribe directamente */
+	if (!pResultado->Terminado)
+	    {
+		pResultado->Directo=true;
+		return;
+	    }
+	Tanda.Turno++;
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TAnalizadorFS :: DirectorioComando							*
+ *																	*
+ * OBJETIVO: Esta función devuelve el directorio que toca un comando, para agrupar los que comparten rutas.				*
+ *																	*
+ * ENTRADA: Comando: El comando.													*
+ *																	*
+ * SALIDA: Directorio: El directorio listado (DIR), el que contiene al archivo (CAT) o vacío (TREE).					*
+ *																	*
+ ****************************************************************************************************************************************/
+void TAnalizadorFS::DirectorioComando(const TComandoTest &Comando, TString &Directorio)
+{
+size_t	Posicion;
+
+switch (Comando.Tipo)
+    {
+	case ctDIR:
+		Directorio=Comando.Ruta;
+		break;
+	case ctCAT:
+		if ( (Posicion=Comando.Ruta.rfind('/')) == TString::npos )
+			Directorio.clear();
+		else
+			Directorio=Comando.Ruta.substr(0, Posicion);
+		break;
+	default:
+		Directorio.clear();
+		break;
     }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TAnalizadorFS :: CargarImagen							*
+ *																	*
+ * OBJETIVO: Esta función carga una nueva imágen de disco para analizar.								*
+ *																	*
+ * ENTRADA: Ruta: Ruta al archivo binario a cargar.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: La forma de acceder a la imágen (leerla completa, mapearla o leerla a pedido con un cache) la determina ModoCarga.	*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::CargarImagen(const char *Ruta)
+{
+int		CodError;
+
+/* Voy a cargar una nueva imágen, borrar todo */
+BorrarTodoYReinicializar();
+
+/* Crear la fuente según el modo de carga elegido */
+switch (ModoCarga)
+    {
+	case mcMEMORIA:
+		FuenteBloques=new TFuenteBloquesMemoria();
+		break;
+	case mcPREAD:
+		FuenteBloques=new TFuenteBloquesPRead(BytesCache);
+		break;
+	default:
+		FuenteBloques=new TFuenteBloquesMapeada();
+		break;
+    }
+
+/* Abrir la imágen */
+CodError=FuenteBloques->Abrir(Ruta);
 
 /* Ver si hubo errores */
 if (CodError==CODERROR_NINGUNO)
     {
 	/* Se cargó sin errores */
-	printf("Se cargaron %d bytes de %s sin errores.\n", LongitudDiskData, Ruta);
+	printf("Se cargaron %llu bytes de %s sin errores.\n", FuenteBloques->Longitud(), Ruta);
     }
 else
     {
@@ -309,16 +714,73 @@ return(CodError);
 void TAnalizadorFS::BorrarTodoYReinicializar(void)
 {
 /* Ver si hay imágen cargada */
-if (DiskData)
+if (FuenteBloques)
     {
 	/* Sí, liberarla */
-	free((void *)DiskData);
-	LongitudDiskData=0;
-	DiskData=NULL;
+	delete FuenteBloques;
+	FuenteBloques=NULL;
     }
 }
 
 
+/****************************************************************************************************************************************
+ *																	*
+ *						    TAnalizadorFS :: ConfigurarCarga							*
+ *																	*
+ * OBJETIVO: Esta función elige cómo se va a acceder a las próximas imágenes que se carguen.						*
+ *																	*
+ * ENTRADA: Modo: Forma de acceder a la imágen (ver TModoCarga).									*
+ *	    BytesCache: Memoria máxima para el cache de lectura (sólo en modo mcPREAD).							*
+ *	    MostrarEstadisticas: Si al terminar se muestran los contadores del cache.							*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TAnalizadorFS::ConfigurarCarga(TModoCarga Modo, __u64 BytesCache, bool MostrarEstadisticas)
+{
+/* Tomar los valores recibidos */
+ModoCarga=Modo;
+TAnalizadorFS::BytesCache=BytesCache;
+TAnalizadorFS::MostrarEstadisticas=MostrarEstadisticas;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TAnalizadorFS :: ConfigurarHilos							*
+ *																	*
+ * OBJETIVO: Esta función elige cuántos hilos usan los drivers para las tareas que pueden repartir.					*
+ *																	*
+ * ENTRADA: Hilos: Cantidad de hilos (0 = uno por núcleo, 1 = sin hilos adicionales).							*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TAnalizadorFS::ConfigurarHilos(unsigned Hilos)
+{
+HilosParalelos=Hilos;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TAnalizadorFS :: ConfigurarLote							*
+ *																	*
+ * OBJETIVO: Esta función elige si los comandos del archivo de tests se ejecutan de a uno o en lote, repartidos entre los hilos.	*
+ *																	*
+ * ENTRADA: EnLote: Si se ejecutan en lote (ver EjecutarTestsEnLote()).									*
+ *	    AgruparPorDirectorio: Si en lote se ejecutan juntos los comandos que tocan el mismo directorio.				*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TAnalizadorFS::ConfigurarLote(bool EnLote, bool AgruparPorDirectorio)
+{
+EjecutarEnLote=EnLote;
+TAnalizadorFS::AgruparPorDirectorio=AgruparPorDirectorio;
+}
+
+
 /****************************************************************************************************************************************
  *																	*
  *					   TAnalizadorFS :: MostrarContenidoDirectorio							*
@@ -326,17 +788,19 @@ if (DiskData)
  * OBJETIVO: Esta función usa el driver cargado para listar el contenido de un determinado directorio.					*
  *																	*
  * ENTRADA: Path: Ruta al directorio cuyo contenido listar.										*
+ *	    f: Dónde imprimirlo.													*
  *																	*
  * SALIDA: En el nombre de la función el código de error.										*
  *																	*
  ****************************************************************************************************************************************/
-int TAnalizadorFS::MostrarContenidoDirectorio(const char *Path)
+int TAnalizadorFS::MostrarContenidoDirectorio(const char *Path, FILE *f)
 {
 int				CodError;
 std::vector<TEntradaDirectorio> Entradas;
+TBufferSalida			Salida(f);
 
 /* Imprimir lo que voy a hacer */
-printf("Leyendo directorio '%s' ...\n", Path);
+Salida.Printf("Leyendo directorio '%s' ...\n", Path);
 
 /* Buscar el contenido del directorio */
 CodError=DriverFS->ListarDirectorio(Path, Entradas);
@@ -345,13 +809,13 @@ if ( (CodError!=CODERROR_NINGUNO) && (CodError!=CODERROR_DIRECTORIO_INEXISTENTE)
 if (CodError==CODERROR_NINGUNO)
     {
 	/* Lo tengo, mostrarlo por pantalla */
-	DriverFS->MostrarDatosDirectorio(Entradas);
+	DriverFS->MostrarDatosDirectorio(Entradas, Salida);
     }
 else
     {
 	/* Si el problema es que el directorio no existe no reportar error, simplemente imprimir que no existe */
 	if (CodError==CODERROR_DIRECTORIO_INEXISTENTE)
-		printf("\tError, el directorio NO EXISTE!\n");
+		Salida.Texto("\tError, el directorio NO EXISTE!\n");
 	else
 		return(CodError);
     }
@@ -368,39 +832,196 @@ return(CODERROR_NINGUNO);
  * OBJETIVO: Esta función usa el driver cargado para listar el contenido de un determinado directorio.					*
  *																	*
  * ENTRADA: Path: Ruta al archivo cuyo contenido listar.										*
+ *	    f: Dónde imprimirlo.													*
  *																	*
  * SALIDA: En el nombre de la función el código de error.										*
  *																	*
  ****************************************************************************************************************************************/
-int TAnalizadorFS::MostrarContenidoArchivo(const char *Path)
+int TAnalizadorFS::MostrarContenidoArchivo(const char *Path, FILE *f)
 {
 int		CodError;
-unsigned	DataLen;
-unsigned char	*Data;
+TEstadoVolcado	Estado;
+TBufferSalida	Salida(f);
 
 /* Imprimir lo que voy a hacer */
-printf("Leyendo archivo '%s' ...\n", Path);
+Salida.Printf("Leyendo archivo '%s' ...\n", Path);
 
-/* Buscar el contenido del archivo */
-CodError=DriverFS->LeerArchivo(Path, Data, DataLen);
+/* Recorrer el archivo de a tramos, imprimiéndolos a medida que llegan */
+Estado.Driver=DriverFS;
+Estado.Salida=&Salida;
+Estado.BytesPorLinea=PrintWidth;
+Estado.EncabezadoImpreso=false;
+Estado.Offset=0;
+Estado.BytesPendientes=0;
+CodError=DriverFS->LeerArchivoPorTramos(Path, VolcarTramo, &Estado);
 if ( (CodError!=CODERROR_NINGUNO) && (CodError!=CODERROR_ARCHIVO_INEXISTENTE) )
 	return(CodError);
 
 if (CodError==CODERROR_NINGUNO)
     {
-	/* Lo tengo, mostrarlo por pantalla */
-	printf("\tLeído, %u bytes\n", DataLen);
-	DriverFS->PrintBuffer(Data, DataLen, PrintWidth);
-	free(Data);
+	/* Un archivo vacío no entrega ningún tramo */
+	if (!Estado.EncabezadoImpreso)
+		Salida.Texto("\tLeído, 0 bytes\n");
+
+	/* Imprimir la última línea incompleta */
+	if (Estado.BytesPendientes)
+		DriverFS->PrintBuffer(Estado.Pendientes, Estado.BytesPendientes, PrintWidth, Estado.Offset, Salida);
     }
 else
     {
 	/* Si el problema es que el archivo no existe no reportar error, simplemente imprimir que no existe */
-	printf("\tError, el archivo NO EXISTE!\n");
+	Salida.Texto("\tError, el archivo NO EXISTE!\n");
     }
 
 /* Salir indicando éxito */
 return(CODERROR_NINGUNO);
 }
 
+/****************************************************************************************************************************************
+ *																	*
+ *						     TAnalizadorFS :: MostrarVolumen							*
+ *																	*
+ * OBJETIVO: Esta función usa el driver cargado para listar todos los archivos y directorios del volumen con su ruta completa.		*
+ *																	*
+ * ENTRADA: f: Dónde imprimirlo.													*
+ *																	*
+ * SALIDA: En el nombre de la función el código de error.										*
+ *																	*
+ * OBSERVACIONES: El orden de las entradas depende del driver: el recorrido por directorios de la clase base o el orden en que están	*
+ *		  en el disco.														*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::MostrarVolumen(FILE *f)
+{
+int			CodError;
+TEstadoRecorrido	Estado;
+TBufferSalida		Salida(f);
+
+/* Imprimir lo que voy a hacer */
+Salida.Texto("Recorriendo el volumen ...\n");
+
+/* Imprimir cada entrada a medida que llega */
+Estado.Salida=&Salida;
+Estado.Entradas=0;
+if ( (CodError=DriverFS->RecorrerVolumen(ImprimirEntradaVolumen, &Estado)) != CODERROR_NINGUNO )
+	return(CodError);
+Salida.Printf("\tRecorrido, %llu entradas\n", Estado.Entradas);
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TAnalizadorFS :: ImprimirEntradaVolumen						*
+ *																	*
+ * OBJETIVO: Receptor de entradas que imprime en pantalla cada entrada del volumen a medida que el driver la encuentra.			*
+ *																	*
+ * ENTRADA: Ruta: Ruta completa de la entrada.												*
+ *	    Entrada: La entrada.													*
+ *	    pParametroUsuario: Puntero al TEstadoRecorrido del volumen.									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO.											*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::ImprimirEntradaVolumen(const TString &Ruta, const TEntradaDirectorio &Entrada, void *pParametroUsuario)
+{
+TEstadoRecorrido	*pEstado = (TEstadoRecorrido *)pParametroUsuario;
+char			Flags[12];
+
+/* Flags y tamaño con las mismas letras que el listado de un directorio, y después la ruta */
+Flags[0]='\t';
+Flags[1]=Entrada.Flags&fedSOLO_LECTURA     ? 'R' : ' ';
+Flags[2]=Entrada.Flags&fedOCULTO           ? 'H' : ' ';
+Flags[3]=Entrada.Flags&fedSISTEMA          ? 'S' : ' ';
+Flags[4]=Entrada.Flags&fedETIQUETA_VOLUMEN ? 'V' : ' ';
+Flags[5]=Entrada.Flags&fedDIRECTORIO       ? 'D' : ' ';
+Flags[6]=Entrada.Flags&fedARCHIVAR         ? 'A' : ' ';
+Flags[7]=Entrada.Flags&fedACCESO_DIRECTO   ? 'L' : ' ';
+Flags[8]=Entrada.Flags&fedCOMPRIMIDO       ? 'C' : ' ';
+Flags[9]=Entrada.Flags&fedENCRIPTADO       ? 'E' : ' ';
+Flags[10]=Entrada.Flags&fedDISPERSO        ? 'P' : ' ';
+Flags[11]=' ';
+pEstado->Salida->Texto(Flags, sizeof(Flags));
+pEstado->Salida->Decimal(Entrada.Bytes, 12);
+pEstado->Salida->Caracter(' ');
+pEstado->Salida->Texto(Ruta.c_str());
+pEstado->Salida->Caracter('\n');
+pEstado->Entradas++;
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TAnalizadorFS :: VolcarTramo							*
+ *																	*
+ * OBJETIVO: Receptor de tramos que imprime en pantalla cada tramo de un archivo a medida que el driver lo lee.				*
+ *																	*
+ * ENTRADA: Tramo: El tramo a imprimir.													*
+ *	    pParametroUsuario: Puntero al TEstadoVolcado del archivo.									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO.											*
+ *																	*
+ * OBSERVACIONES: Los tramos no tienen por qué terminar en un fin de línea, los bytes sobrantes se guardan hasta el próximo tramo	*
+ *		  para que la salida sea idéntica a imprimir el archivo completo de una sola vez.					*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::VolcarTramo(const TTramoArchivo &Tramo, void *pParametroUsuario)
+{
+TEstadoVolcado		*pEstado = (TEstadoVolcado *)pParametroUsuario;
+const unsigned char	*pDatos;
+__u64			Bytes, BytesLineasCompletas;
+unsigned		BytesACompletar;
+
+/* Con el primer tramo imprimir el tamaño del archivo */
+if (!pEstado->EncabezadoImpreso)
+    {
+	pEstado->Salida->Texto("\tLeído, ");
+	pEstado->Salida->Decimal(Tramo.BytesArchivo, 0);
+	pEstado->Salida->Texto(" bytes\n");
+	pEstado->EncabezadoImpreso=true;
+    }
+pDatos=Tramo.Datos;
+Bytes=Tramo.Bytes;
+
+/* Completar la línea que quedó por la mitad del tramo anterior */
+if (pEstado->BytesPendientes)
+    {
+	BytesACompletar=pEstado->BytesPorLinea-pEstado->BytesPendientes;
+	if (BytesACompletar>Bytes)
+		BytesACompletar=Bytes;
+	memcpy(pEstado->Pendientes+pEstado->BytesPendientes, pDatos, BytesACompletar);
+	pEstado->BytesPendientes+=BytesACompletar;
+	pDatos+=BytesACompletar;
+	Bytes-=BytesACompletar;
+	if (pEstado->BytesPendientes<pEstado->BytesPorLinea)
+		return(CODERROR_NINGUNO);
+	pEstado->Driver->PrintBuffer(pEstado->Pendientes, pEstado->BytesPorLinea, pEstado->BytesPorLinea, pEstado->Offset, *pEstado->Salida);
+	pEstado->Offset+=pEstado->BytesPorLinea;
+	pEstado->BytesPendientes=0;
+    }
+
+/* Imprimir las líneas completas directamente desde el tramo */
+BytesLineasCompletas=Bytes-Bytes%pEstado->BytesPorLinea;
+if (BytesLineasCompletas)
+    {
+	pEstado->Driver->PrintBuffer(pDatos, BytesLineasCompletas, pEstado->BytesPorLinea, pEstado->Offset, *pEstado->Salida);
+	pEstado->Offset+=BytesLineasCompletas;
+	pDatos+=BytesLineasCompletas;
+	Bytes-=BytesLineasCompletas;
+    }
+
+/* Guardar lo que sobra para el próximo tramo */
+memcpy(pEstado->Pendientes, pDatos, Bytes);
+pEstado->BytesPendientes=Bytes;
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
 
@@ -0,0 +1,288 @@
+#include "all_heads.h"
+
+
+/********************************
+ *				*
+ *     Clase TBufferSalida	*
+ *				*
+ ********************************/
+/* Dígitos hexa y tabla de conversión de cada byte a "XX " (el cuarto caracter es el '\0', que no se copia) */
+const char	TBufferSalida::DigitosMayusculas[17] = "0123456789ABCDEF";
+const char	TBufferSalida::DigitosMinusculas[17] = "0123456789abcdef";
+char		TBufferSalida::TablaHexa[256][4];
+bool		TBufferSalida::TablaHexaArmada = TBufferSalida::ArmarTablaHexa();
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TBufferSalida :: TBufferSalida							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: f: Dónde se escribe la salida.												*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TBufferSalida::TBufferSalida(FILE *f)
+{
+/* Inicializar variables */
+Salida=f;
+Buffer=new char[BYTES_BUFFER_SALIDA];
+Usados=0;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TBufferSalida :: ~TBufferSalida							*
+ *																	*
+ * OBJETIVO: Escribir lo que quedó pendiente y liberar recursos alocados.								*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TBufferSalida::~TBufferSalida()
+{
+Vaciar();
+delete[] Buffer;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TBufferSalida :: Texto								*
+ *																	*
+ * OBJETIVO: Esta función agrega un texto a la salida.											*
+ *																	*
+ * ENTRADA: Texto: El texto.														*
+ *	    Bytes: Su longitud (si no se pasa, hasta el '\0').										*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TBufferSalida::Texto(const char *Texto)
+{
+TBufferSalida::Texto(Texto, strlen(Texto));
+}
+
+void TBufferSalida::Texto(const char *Texto, size_t Bytes)
+{
+/* Si no entra en lo que queda, vaciar el buffer. Si tampoco entra vacío, escribirlo directamente */
+if (Usados+Bytes>BYTES_BUFFER_SALIDA)
+    {
+	Vaciar();
+	if (Bytes>BYTES_BUFFER_SALIDA)
+	    {
+		fwrite(Texto, 1, Bytes, Salida);
+		return;
+	    }
+    }
+memcpy(Buffer+Usados, Texto, Bytes);
+Usados+=Bytes;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TBufferSalida :: Caracter, Repetir							*
+ *																	*
+ * OBJETIVO: Estas funciones agregan un caracter a la salida, una vez o varias.								*
+ *																	*
+ * ENTRADA: c: El caracter.														*
+ *	    Veces: Cuántas veces agregarlo.												*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TBufferSalida::Caracter(char c)
+{
+if (Usados==BYTES_BUFFER_SALIDA)
+	Vaciar();
+Buffer[Usados++]=c;
+}
+
+void TBufferSalida::Repetir(char c, size_t Veces)
+{
+size_t	Bytes;
+
+while (Veces)
+    {
+	if (Usados==BYTES_BUFFER_SALIDA)
+		Vaciar();
+	Bytes=BYTES_BUFFER_SALIDA-Usados<Veces ? BYTES_BUFFER_SALIDA-Usados : Veces;
+	memset(Buffer+Usados, c, Bytes);
+	Usados+=Bytes;
+	Veces-=Bytes;
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TBufferSalida :: Decimal								*
+ *																	*
+ * OBJETIVO: Esta función agrega un número en decimal, alineado a la derecha, como "%*llu" o "%0*llu".					*
+ *																	*
+ * ENTRADA: Valor: El número.														*
+ *	    Ancho: Cantidad mínima de caracteres. Si el número tiene más dígitos no se corta.						*
+ *	    Relleno: Con qué completar a la izquierda (' ' o '0').									*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TBufferSalida::Decimal(__u64 Valor, unsigned Ancho, char Relleno)
+{
+char		Digitos[20];
+unsigned	Cantidad;
+
+/* Armar los dígitos de atrás para adelante */
+Cantidad=0;
+do
+    {
+	Digitos[sizeof(Digitos)-++Cantidad]='0'+Valor%10;
+	Valor/=10;
+    }
+while (Valor);
+
+/* Completar y copiarlos */
+if (Ancho>Cantidad)
+	Repetir(Relleno, Ancho-Cantidad);
+Texto(Digitos+sizeof(Digitos)-Cantidad, Cantidad);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TBufferSalida :: Hexa								*
+ *																	*
+ * OBJETIVO: Esta función agrega un número en hexa completado con ceros, como "%0*llx" o "%0*llX".					*
+ *																	*
+ * ENTRADA: Valor: El número.														*
+ *	    Digitos: Cantidad mínima de dígitos. Si el número tiene más no se corta.							*
+ *	    Mayusculas: Si las letras van en mayúsculas.										*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TBufferSalida::Hexa(__u64 Valor, unsigned Digitos, bool Mayusculas)
+{
+char		Numero[16];
+const char	*pDigitos = Mayusculas ? DigitosMayusculas : DigitosMinusculas;
+unsigned	Cantidad;
+
+/* Armar los dígitos de atrás para adelante */
+Cantidad=0;
+do
+    {
+	Numero[sizeof(Numero)-++Cantidad]=pDigitos[Valor&0xF];
+	Valor>>=4;
+    }
+while (Valor);
+
+/* Completar y copiarlos */
+if (Digitos>Cantidad)
+	Repetir('0', Digitos-Cantidad);
+Texto(Numero+sizeof(Numero)-Cantidad, Cantidad);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TBufferSalida :: Printf								*
+ *																	*
+ * OBJETIVO: Esta función agrega un texto con formato, para lo que no vale la pena armar a mano.					*
+ *																	*
+ * ENTRADA: Formato: El formato, como printf().												*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TBufferSalida::Printf(const char *Formato, ...)
+{
+va_list	Argumentos, Copia;
+int	Bytes;
+
+/* Intentar armarlo en lo que queda del buffer */
+va_start(Argumentos, Formato);
+va_copy(Copia, Argumentos);
+Bytes=vsnprintf(Buffer+Usados, BYTES_BUFFER_SALIDA-Usados, Formato, Argumentos);
+if ( (Bytes>=0) && (Usados+Bytes<BYTES_BUFFER_SALIDA) )
+	Usados+=Bytes;
+else
+    {
+	/* No entró, escribirlo directamente detrás de lo pendiente */
+	Vaciar();
+	vfprintf(Salida, Formato, Copia);
+    }
+va_end(Copia);
+va_end(Argumentos);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TBufferSalida :: Reservar								*
+ *																	*
+ * OBJETIVO: Esta función asegura que haya lugar en el buffer para escribir directamente en él.						*
+ *																	*
+ * ENTRADA: Bytes: Cuántos bytes se van a escribir, hasta MAXIMO_RESERVA_SALIDA.							*
+ *																	*
+ * SALIDA: En el nombre de la función dónde escribirlos. Después hay que llamar a Avanzar() con los que se usaron.			*
+ *																	*
+ ****************************************************************************************************************************************/
+char *TBufferSalida::Reservar(size_t Bytes)
+{
+if (Usados+Bytes>BYTES_BUFFER_SALIDA)
+	Vaciar();
+return(Buffer+Usados);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TBufferSalida :: Vaciar								*
+ *																	*
+ * OBJETIVO: Esta función escribe todo lo pendiente de una sola vez.									*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TBufferSalida::Vaciar(void)
+{
+if (Usados)
+	fwrite(Buffer, 1, Usados, Salida);
+Usados=0;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TBufferSalida :: ArmarTablaHexa							*
+ *																	*
+ * OBJETIVO: Esta función arma la tabla con cada byte escrito como dos dígitos hexa en mayúsculas y un espacio.				*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función true.												*
+ *																	*
+ * OBSERVACIONES: Se llama una sola vez, al inicializar las variables globales del programa.						*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TBufferSalida::ArmarTablaHexa(void)
+{
+unsigned	i;
+
+for (i=0;i<256;i++)
+    {
+	TablaHexa[i][0]=DigitosMayusculas[i>>4];
+	TablaHexa[i][1]=DigitosMayusculas[i&0xF];
+	TablaHexa[i][2]=' ';
+	TablaHexa[i][3]='\0';
+    }
+return(true);
+}
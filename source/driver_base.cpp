@@ -13,20 +13,22 @@
  *																	*
  * OBJETIVO: Inicializar la clase recién creada.											*
  *																	*
- * ENTRADA: DiskData: Puntero a un bloque de memoria con la imágen del disco a analizar.						*
- *	    LongitudDiskData: Tamaño, en bytes, de la imágen a analizar.								*
+ * ENTRADA: FuenteBloques: Fuente de la que leer la imágen del disco a analizar.							*
  *																	*
  * SALIDA: Nada.															*
  *																	*
  ****************************************************************************************************************************************/
-TDriverBase::TDriverBase(const unsigned char *DiskData, unsigned LongitudDiskData)
+TDriverBase::TDriverBase(TFuenteBloques *FuenteBloques)
 {
 /* Tomar los valores recibidos */
-TDriverBase::DiskData=DiskData;
-TDriverBase::LongitudDiskData=LongitudDiskData;
+TDriverBase::FuenteBloques=FuenteBloques;
 
-/* Inicialziar variables */
-memset(&DatosFS, 0, sizeof(DatosFS));
+/* Inicialziar variables (DatosFS se inicializa por valor, así queda todo en cero) */
+DatosFS=TDatosFS();
+CacheRutas.Dimensionar(MAXIMO_ENTRADAS_CACHE_RUTAS);
+EntradasIndexadas=0;
+HilosParalelos=0;
+PoolTareas=NULL;
 }
 
 
@@ -43,6 +45,82 @@ memset(&DatosFS, 0, sizeof(DatosFS));
  ****************************************************************************************************************************************/
 TDriverBase::~TDriverBase()
 {
+delete PoolTareas;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverBase :: ConfigurarHilos							*
+ *																	*
+ * OBJETIVO: Esta función elige cuántos hilos se usan para las tareas que se pueden repartir (ver EjecutarEnParalelo()).		*
+ *																	*
+ * ENTRADA: Hilos: Cantidad de hilos (0 = uno por núcleo, 1 = todo en el hilo que llama).						*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Es parte de la configuración del driver: se llama antes de empezar a leer, no mientras otros hilos lo usan.		*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverBase::ConfigurarHilos(unsigned Hilos)
+{
+/* El pool se vuelve a crear con la nueva cantidad cuando haga falta */
+HilosParalelos=Hilos;
+delete PoolTareas;
+PoolTareas=NULL;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverBase :: EjecutarEnParalelo							*
+ *																	*
+ * OBJETIVO: Esta función ejecuta una tanda de tareas independientes repartiéndolas entre los hilos del pool del driver.		*
+ *																	*
+ * ENTRADA: Tareas, Tarea, pParametroUsuario: Ver TPoolTareas::Ejecutar().								*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el error de la primera tarea que falló.	*
+ *																	*
+ * OBSERVACIONES: Las tareas pueden usar las funciones const del driver, que se pueden llamar desde varios hilos a la vez. Si la fuente	*
+ *		  no admite lecturas desde varios hilos a la vez (pread, que comparte un cache LRU) el pool tiene un solo hilo y las	*
+ *		  tareas se ejecutan en orden en el que llama. Si dos hilos piden una tanda a la vez, la segunda espera a que termine	*
+ *		  la primera (el pool no es reentrante).										*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::EjecutarEnParalelo(size_t Tareas, TpTarea Tarea, void *pParametroUsuario) const
+{
+std::lock_guard<std::mutex>	Bloqueo(MutexPool);
+
+/* Crear el pool la primera vez */
+if (!PoolTareas)
+	PoolTareas=new TPoolTareas( (FuenteBloques) && (FuenteBloques->LecturasConcurrentes()) ? HilosParalelos : 1 );
+
+/* Repartir las tareas */
+return(PoolTareas->Ejecutar(Tareas, Tarea, pParametroUsuario));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverBase :: SerializarLectura							*
+ *																	*
+ * OBJETIVO: Esta función bloquea el driver mientras dura una lectura, si la fuente de la imágen no admite lecturas desde varios	*
+ *	     hilos a la vez.														*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función el bloqueo, que se suelta al destruirlo (sin bloquear nada si la fuente es concurrente).		*
+ *																	*
+ * OBSERVACIONES: La llaman al empezar las funciones públicas de lectura. Los caches del driver ya se pueden usar desde varios hilos,	*
+ *		  pero la fuente pread comparte un cache LRU y sus punteros sólo duran unas lecturas, así que con ella los pedidos se	*
+ *		  atienden de a uno. El mutex es recursivo porque esas funciones se llaman entre sí.					*
+ *																	*
+ ****************************************************************************************************************************************/
+std::unique_lock<std::recursive_mutex> TDriverBase::SerializarLectura(void) const
+{
+if ( (FuenteBloques) && (FuenteBloques->LecturasConcurrentes()) )
+	return(std::unique_lock<std::recursive_mutex>());
+return(std::unique_lock<std::recursive_mutex>(MutexLectura));
 }
 
 
@@ -53,28 +131,846 @@ TDriverBase::~TDriverBase()
  * OBJETIVO: Esta función devuelve un puntero al sector pedido.										*
  *																	*
  * ENTRADA: NroSector: Número de sector (el primero es el sector es el 0).								*
+ *	    Bytes: Cantidad de bytes contiguos que se van a leer a partir del comienzo del sector (0 = un sector).			*
  *																	*
  * SALIDA: En el nombre de la función el puntero a los datos del sector.								*
  *																	*
  * OBSERVACIONES: IMPORTANTE: Esta función sólo puede usarse para acceder al sector 0 hasta tanto se inicialice la variable 		*
  *			      DatosFS.BytesPorSector.											*
+ *		  Sólo se garantiza que los Bytes pedidos sean contiguos en memoria, leer más allá depende de la fuente de la imágen.	*
  *																	*
  ****************************************************************************************************************************************/
-const unsigned char *TDriverBase::PunteroASector(__u64 NroSector)
+const unsigned char *TDriverBase::PunteroASector(__u64 NroSector, __u64 Bytes) const
+{
+int	BytesPorSector;
+
+/* Hasta levantar el superbloque no se conoce el tamaño de sector, asumir el mínimo */
+BytesPorSector=DatosFS.BytesPorSector ? DatosFS.BytesPorSector : 512;
+
+/* Por omisión se lee un sector */
+if (!Bytes)
+	Bytes=BytesPorSector;
+
+/* Retornar el puntero solicitado */
+return(PunteroABytes(NroSector*BytesPorSector, Bytes));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverBase :: PunteroABytes								*
+ *																	*
+ * OBJETIVO: Esta función devuelve un puntero a un rango de bytes cualquiera de la imágen.						*
+ *																	*
+ * ENTRADA: Offset: Posición, en bytes, del comienzo del rango.										*
+ *	    Bytes: Cantidad de bytes contiguos que se van a leer.									*
+ *																	*
+ * SALIDA: En el nombre de la función el puntero a los datos, o NULL si el rango no existe en la imágen.				*
+ *																	*
+ * OBSERVACIONES: Con la fuente pread el puntero es temporal (ver TFuenteBloquesPRead::Puntero()): no se pueden tener dos lecturas	*
+ *		  de BYTES_LECTURA_GRANDE o más a la vez, ni guardar un puntero mientras se hacen muchas otras lecturas.		*
+ *																	*
+ ****************************************************************************************************************************************/
+const unsigned char *TDriverBase::PunteroABytes(__u64 Offset, __u64 Bytes) const
 {
 /* Ver si tengo imágen cargada */
-if (!DiskData)
+if (!FuenteBloques)
 	return(NULL);
 
-/* Ver si el sector existe */
-if ( ((NroSector+1)*DatosFS.BytesPorSector) >= LongitudDiskData )
+/* La fuente valida que el rango exista */
+return(FuenteBloques->Puntero(Offset, Bytes));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverBase :: LeerArchivoPorTramos							*
+ *																	*
+ * OBJETIVO: Esta función lee un archivo entregándolo de a tramos contiguos que apuntan directamente a la imágen, sin alocar ni		*
+ *	     copiar el archivo completo.												*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo a leer.												*
+ *	    Receptor: Función a la que se le entrega cada tramo, en orden.								*
+ *	    pParametroUsuario: Valor que se le pasa sin modificar al receptor.								*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error (o el que haya		*
+ *	   retornado el receptor).													*
+ *																	*
+ * OBSERVACIONES: Esta implementación sirve para los drivers que sólo saben leer con LeerArchivo(): entrega un único tramo con el	*
+ *		  buffer alocado. Los drivers que puedan deberían redefinirla y entregar tramos con EmitirTramo().			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::LeerArchivoPorTramos(const char *Path, TpReceptorTramo Receptor, void *pParametroUsuario) const
+{
+int					CodError;
+unsigned char				*Data;
+__u64					DataLen;
+TTramoArchivo				Tramo;
+std::unique_lock<std::recursive_mutex>	Bloqueo = SerializarLectura();
+
+/* Leer el archivo completo */
+if ( (CodError=LeerArchivo(Path, Data, DataLen)) != CODERROR_NINGUNO )
+	return(CodError);
+
+/* Entregarlo en un solo tramo */
+if (DataLen)
     {
-	/* No, la imágen cargada no tiene tantos sectores */
-	return(NULL);
+	Tramo.Datos=Data;
+	Tramo.Bytes=DataLen;
+	Tramo.Offset=0;
+	Tramo.BytesArchivo=DataLen;
+	CodError=Receptor(Tramo, pParametroUsuario);
     }
 
-/* Retornar el puntero solicitado */
-return(DiskData+NroSector*DatosFS.BytesPorSector);
+/* Liberar el buffer y salir */
+free(Data);
+return(CodError);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverBase :: LeerArchivoCompleto							*
+ *																	*
+ * OBJETIVO: Esta función lee un archivo completo a un buffer alocado, usando LeerArchivoPorTramos().					*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo a levantar.												*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Data: Buffer alocado con malloc() con los datos del archivo.									*
+ *	   DataLen: Tamaño en bytes del buffer devuelto.										*
+ *																	*
+ * OBSERVACIONES: Sirve para que los drivers que leen por tramos implementen LeerArchivo() sin repetir código.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::LeerArchivoCompleto(const char *Path, unsigned char *&Data, __u64 &DataLen) const
+{
+int		CodError;
+TDatosAlocados	Buffer;
+
+/* Inicializar salidas */
+Data=NULL;
+DataLen=0;
+Buffer.NumBytes=0;
+Buffer.pDatos=NULL;
+
+/* Juntar todos los tramos */
+CodError=LeerArchivoPorTramos(Path, CopiarTramo, &Buffer);
+if ( (CodError==CODERROR_NINGUNO) && (!Buffer.pDatos) && ((Buffer.pDatos=malloc(1)) == NULL) )
+	CodError=CODERROR_FALTA_MEMORIA;
+if (CodError!=CODERROR_NINGUNO)
+    {
+	/* No dejar nada por la mitad */
+	free(Buffer.pDatos);
+	return(CodError);
+    }
+
+/* Devolver el buffer */
+Data=(unsigned char *)Buffer.pDatos;
+DataLen=Buffer.NumBytes;
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverBase :: CopiarTramo								*
+ *																	*
+ * OBJETIVO: Receptor de tramos usado por LeerArchivoCompleto() para copiar cada tramo a un buffer único.				*
+ *																	*
+ * ENTRADA: Tramo: El tramo a copiar.													*
+ *	    pParametroUsuario: Puntero a una estructura TDatosAlocados con el buffer destino.						*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::CopiarTramo(const TTramoArchivo &Tramo, void *pParametroUsuario)
+{
+TDatosAlocados	*pBuffer = (TDatosAlocados *)pParametroUsuario;
+
+/* Con el primer tramo ya se sabe el tamaño del archivo, alocar todo de una vez */
+if (!pBuffer->pDatos)
+    {
+	if ( (pBuffer->pDatos=malloc(Tramo.BytesArchivo ? Tramo.BytesArchivo : 1)) == NULL )
+		return(CODERROR_FALTA_MEMORIA);
+	pBuffer->NumBytes=Tramo.BytesArchivo;
+    }
+
+/* Copiar el tramo en su lugar */
+if (Tramo.Offset+Tramo.Bytes > pBuffer->NumBytes)
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+memcpy((unsigned char *)pBuffer->pDatos+Tramo.Offset, Tramo.Datos, Tramo.Bytes);
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverBase :: EmitirTramo							*
+ *																	*
+ * OBJETIVO: Esta función entrega al receptor un rango contiguo de la imágen como tramo de un archivo.					*
+ *																	*
+ * ENTRADA: Offset: Posición, en bytes, del rango dentro de la imágen.									*
+ *	    Bytes: Longitud del rango.													*
+ *	    OffsetArchivo: Posición del rango dentro del archivo.									*
+ *	    BytesArchivo: Tamaño total del archivo.											*
+ *	    Receptor, pParametroUsuario: Ver LeerArchivoPorTramos().									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Si la fuente tiene la imágen contigua en memoria el rango se entrega en un único tramo, si no se lo parte en		*
+ *		  tramos de a lo sumo BYTES_MAXIMOS_TRAMO bytes para no tener que levantarlo entero.					*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::EmitirTramo(__u64 Offset, __u64 Bytes, __u64 OffsetArchivo, __u64 BytesArchivo, TpReceptorTramo Receptor, void *pParametroUsuario) const
+{
+int		CodError;
+__u64		BytesMaximos;
+TTramoArchivo	Tramo;
+
+/* Determinar de a cuánto se puede pedir a la fuente */
+BytesMaximos=FuenteBloques->BytesMaximosPorLectura();
+if (BytesMaximos>BYTES_MAXIMOS_TRAMO)
+	BytesMaximos=Bytes;
+
+/* Entregar el rango de a partes */
+Tramo.BytesArchivo=BytesArchivo;
+while (Bytes)
+    {
+	Tramo.Bytes=Bytes<BytesMaximos ? Bytes : BytesMaximos;
+	Tramo.Offset=OffsetArchivo;
+	if ( (Tramo.Datos=PunteroABytes(Offset, Tramo.Bytes)) == NULL )
+		return(CODERROR_LECTURA_DISCO);
+	if ( (CodError=Receptor(Tramo, pParametroUsuario)) != CODERROR_NINGUNO )
+		return(CodError);
+	Offset+=Tramo.Bytes;
+	OffsetArchivo+=Tramo.Bytes;
+	Bytes-=Tramo.Bytes;
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverBase :: EmitirCeros							*
+ *																	*
+ * OBJETIVO: Esta función entrega al receptor un rango de ceros como tramo de un archivo (un hueco de un archivo disperso).		*
+ *																	*
+ * ENTRADA: Bytes: Longitud del hueco.													*
+ *	    OffsetArchivo: Posición del hueco dentro del archivo.									*
+ *	    BytesArchivo: Tamaño total del archivo.											*
+ *	    Receptor, pParametroUsuario: Ver LeerArchivoPorTramos().									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Los tramos apuntan a un bloque de ceros estático, así que un hueco no lee la imágen ni aloca memoria.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::EmitirCeros(__u64 Bytes, __u64 OffsetArchivo, __u64 BytesArchivo, TpReceptorTramo Receptor, void *pParametroUsuario) const
+{
+static const unsigned char	BloqueCeros[BYTES_BLOQUE_CEROS] = {0};
+int				CodError;
+TTramoArchivo			Tramo;
+
+/* Entregar el hueco de a partes */
+Tramo.Datos=BloqueCeros;
+Tramo.BytesArchivo=BytesArchivo;
+while (Bytes)
+    {
+	Tramo.Bytes=Bytes<BYTES_BLOQUE_CEROS ? Bytes : BYTES_BLOQUE_CEROS;
+	Tramo.Offset=OffsetArchivo;
+	if ( (CodError=Receptor(Tramo, pParametroUsuario)) != CODERROR_NINGUNO )
+		return(CodError);
+	OffsetArchivo+=Tramo.Bytes;
+	Bytes-=Tramo.Bytes;
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverBase :: EntradaRootDir							*
+ *																	*
+ * OBJETIVO: Esta función arma la entrada que representa al directorio raíz, que no figura en ningún directorio.			*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Entrada: La entrada del directorio raíz.											*
+ *																	*
+ * OBSERVACIONES: Los drivers la redefinen para completar los datos propios del formato (cluster, inode, registro MFT).			*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverBase::EntradaRootDir(TEntradaDirectorio &Entrada) const
+{
+Entrada.Flags=fedDIRECTORIO;
+Entrada.Nombre="/";
+Entrada.Bytes=0;
+Entrada.FechaCreacion=0;
+Entrada.FechaUltimoAcceso=0;
+Entrada.FechaUltimaModificacion=0;
+memset(&Entrada.DatosEspecificos, 0, sizeof(Entrada.DatosEspecificos));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TDriverBase :: ListarDirectorioEntrada							*
+ *																	*
+ * OBJETIVO: Esta función enumera las entradas de un directorio dado por su entrada (no por su ruta).					*
+ *																	*
+ * ENTRADA: Directorio: Entrada del directorio a enumerar, tal como la devolvió el propio driver o EntradaRootDir().			*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Entradas: Arreglo con cada una de las entradas.										*
+ *																	*
+ * OBSERVACIONES: Los drivers que la implementan pueden usar BuscarEntrada() y ListarDirectorioPorRuta() para resolver rutas.		*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::ListarDirectorioEntrada(const TEntradaDirectorio &Directorio, std::vector<TEntradaDirectorio> &Entradas) const
+{
+return(CODERROR_NO_IMPLEMENTADO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TDriverBase :: IdentificadorDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función devuelve un número que identifica unívocamente a un directorio dentro del filesystem.				*
+ *																	*
+ * ENTRADA: Directorio: Entrada del directorio.												*
+ *																	*
+ * SALIDA: En el nombre de la función el identificador.											*
+ *																	*
+ * OBSERVACIONES: Se usa como parte de la clave del cache de rutas. Distintas entradas de un mismo directorio (por ejemplo su "."	*
+ *		  y la entrada en el padre) tienen que devolver el mismo valor.								*
+ *																	*
+ ****************************************************************************************************************************************/
+__u64 TDriverBase::IdentificadorDirectorio(const TEntradaDirectorio &Directorio) const
+{
+return(0);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverBase :: NormalizarNombre							*
+ *																	*
+ * OBJETIVO: Esta función lleva un nombre a la forma en que se compara dentro de un directorio.						*
+ *																	*
+ * ENTRADA: Nombre: El nombre a normalizar.												*
+ *																	*
+ * SALIDA: Nombre: El nombre normalizado.												*
+ *																	*
+ * OBSERVACIONES: Por omisión los nombres se comparan tal cual. Los formatos que no distinguen mayúsculas la redefinen.			*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverBase::NormalizarNombre(TString &Nombre) const
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverBase :: BuscarEnDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función busca un nombre en un directorio sin listarlo entero. Los drivers cuyo formato tiene un índice en el		*
+ *	     disco (como el htree de EXT) la redefinen.											*
+ *																	*
+ * ENTRADA: Directorio: Entrada del directorio donde buscar.										*
+ *	    Nombre: Nombre a buscar, ya normalizado.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si lo encontró, CODERROR_ARCHIVO_INEXISTENTE si no está, o			*
+ *	   CODERROR_NO_IMPLEMENTADO si no se puede buscar sin listar el directorio (que es lo que hace esta implementación).		*
+ *	   Entrada: La entrada encontrada.												*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::BuscarEnDirectorio(const TEntradaDirectorio &Directorio, const TString &Nombre, TEntradaDirectorio &Entrada) const
+{
+return(CODERROR_NO_IMPLEMENTADO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverBase :: BuscarEntrada							*
+ *																	*
+ * OBJETIVO: Esta función busca la entrada de directorio que corresponde a una ruta, recorriéndola de a un componente.			*
+ *																	*
+ * ENTRADA: Path: Ruta a buscar (cadena de nombres separados por '/').									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, CODERROR_ARCHIVO_INEXISTENTE si algún componente no		*
+ *	   existe, caso contrario el código de error.											*
+ *	   Entrada: La entrada encontrada (la del directorio raíz si la ruta es "/").							*
+ *																	*
+ * OBSERVACIONES: Cada componente se busca primero en el cache de rutas, con clave (directorio padre, nombre normalizado). Si no	*
+ *		  está se le pide al driver con BuscarEnDirectorio(), y sólo si el driver no sabe buscar un nombre suelto se lista el	*
+ *		  directorio padre, así que con el cache caliente resolver una ruta cuesta una búsqueda en una tabla de hash por	*
+ *		  componente. El cache está partido en fragmentos con su propio mutex, así varios hilos resuelven rutas a la vez sin	*
+ *		  esperarse salvo que caigan en el mismo fragmento.									*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::BuscarEntrada(const char *Path, TEntradaDirectorio &Entrada) const
+{
+int					CodError;
+const char				*pFin;
+TString					Nombre, Clave;
+std::shared_ptr<const TIndiceDirectorio>	pIndiceDirectorio;
+const TEntradaDirectorio		*pHijo;
+TEntradaDirectorio			Hijo;
+
+/* Arrancar del directorio raíz */
+EntradaRootDir(Entrada);
+
+/* Recorrer la ruta de a un componente */
+while (*Path)
+    {
+	/* Saltear las barras */
+	if (*Path=='/')
+	    {
+		Path++;
+		continue;
+	    }
+
+	/* Separar el componente */
+	pFin=strchr(Path, '/');
+	if (!pFin)
+		pFin=Path+strlen(Path);
+	Nombre.assign(Path, pFin-Path);
+	Path=pFin;
+
+	/* Sólo se puede bajar por un directorio */
+	if (!(Entrada.Flags&fedDIRECTORIO))
+		return(CODERROR_ARCHIVO_INEXISTENTE);
+
+	/* Buscarlo en el cache */
+	NormalizarNombre(Nombre);
+	ArmarClaveCacheRutas(IdentificadorDirectorio(Entrada), Nombre, Clave);
+	if (CacheRutas.Buscar(Clave, Entrada))
+		continue;
+
+	/* No está, pedírselo al driver si sabe buscar un nombre sin listar todo el directorio */
+	CodError=BuscarEnDirectorio(Entrada, Nombre, Hijo);
+	if (CodError==CODERROR_NINGUNO)
+		pHijo=&Hijo;
+	else if (CodError!=CODERROR_NO_IMPLEMENTADO)
+		return(CodError);
+	else
+	    {
+		/* Si no, buscarlo en el directorio padre indexado por nombre (se lista sólo si no está indexado) */
+		if ( (CodError=IndexarDirectorio(Entrada, pIndiceDirectorio)) != CODERROR_NINGUNO )
+			return(CodError);
+		if ( (pHijo=BuscarEnIndice(*pIndiceDirectorio, Nombre)) == NULL )
+			return(CODERROR_ARCHIVO_INEXISTENTE);
+	    }
+
+	/* Guardarlo en el cache y seguir desde el encontrado */
+	CacheRutas.Guardar(Clave, *pHijo);
+	Entrada=*pHijo;
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TDriverBase :: ListarDirectorioPorRuta							*
+ *																	*
+ * OBJETIVO: Esta función enumera un directorio dado por su ruta, usando BuscarEntrada() y ListarDirectorioEntrada().			*
+ *																	*
+ * ENTRADA: Path: Ruta al directorio a enumerar.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, CODERROR_DIRECTORIO_INEXISTENTE si la ruta no existe o	*
+ *	   no es un directorio, caso contrario el código de error.									*
+ *	   Entradas: Arreglo con cada una de las entradas.										*
+ *																	*
+ * OBSERVACIONES: Sirve para que los drivers implementen ListarDirectorio() sin repetir código. El directorio se lista directo en	*
+ *		  Entradas, sin copias intermedias.											*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::ListarDirectorioPorRuta(const char *Path, std::vector<TEntradaDirectorio> &Entradas) const
+{
+int					CodError;
+TEntradaDirectorio			Directorio;
+std::unique_lock<std::recursive_mutex>	Bloqueo = SerializarLectura();
+
+/* Buscar el directorio */
+CodError=BuscarEntrada(Path, Directorio);
+if (CodError==CODERROR_ARCHIVO_INEXISTENTE)
+	return(CODERROR_DIRECTORIO_INEXISTENTE);
+if (CodError!=CODERROR_NINGUNO)
+	return(CodError);
+if (!(Directorio.Flags&fedDIRECTORIO))
+	return(CODERROR_DIRECTORIO_INEXISTENTE);
+
+/* Listarlo */
+return(ListarDirectorioEntrada(Directorio, Entradas));
+}
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverBase :: RecorrerVolumen							*
+ *																	*
+ * OBJETIVO: Esta función entrega cada archivo y directorio del volumen con su ruta completa.						*
+ *																	*
+ * ENTRADA: Receptor: Función que recibe cada entrada.											*
+ *	    pParametroUsuario: Parámetro que se le pasa al receptor.									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Recorre el árbol desde el raíz listando cada directorio con ListarDirectorioEntrada(). Los drivers que pueden leer	*
+ *		  sus entradas en orden de disco la reemplazan. No se entregan el raíz, "." ni "..", ni las etiquetas de volumen, y un	*
+ *		  directorio que aparece dos veces (un filesystem dañado con ciclos) se lista una sola.					*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::RecorrerVolumen(TpReceptorEntrada Receptor, void *pParametroUsuario) const
+{
+int					CodError;
+std::list<TDirectorioPendiente>		Pendientes;
+std::list<TDirectorioPendiente>::iterator	itSiguiente, itSubdirectorio;
+std::vector<TEntradaDirectorio>		Entradas;
+std::unordered_set<__u64>		Listados;
+TDirectorioPendiente			Directorio;
+TString					Ruta;
+size_t					i;
+std::unique_lock<std::recursive_mutex>	Bloqueo = SerializarLectura();
+
+/* Empezar por el raíz */
+Pendientes.push_back(TDirectorioPendiente());
+EntradaRootDir(Pendientes.back().Entrada);
+Listados.insert(IdentificadorDirectorio(Pendientes.back().Entrada));
+
+/* Listar los directorios pendientes, primero los más profundos */
+while (!Pendientes.empty())
+    {
+	Directorio.Ruta.swap(Pendientes.front().Ruta);
+	Directorio.Entrada=Pendientes.front().Entrada;
+	Pendientes.pop_front();
+	Entradas.clear();
+	if ( (CodError=ListarDirectorioEntrada(Directorio.Entrada, Entradas)) != CODERROR_NINGUNO )
+		return(CodError);
+
+	/* Entregar cada entrada y dejar sus subdirectorios adelante de los pendientes, en el orden del listado */
+	itSiguiente=Pendientes.begin();
+	for (i=0;i<Entradas.size();i++)
+	    {
+		if ( (Entradas[i].Nombre==".") || (Entradas[i].Nombre=="..") || (Entradas[i].Flags&fedETIQUETA_VOLUMEN) )
+			continue;
+		Ruta=Directorio.Ruta;
+		Ruta+='/';
+		Ruta+=Entradas[i].Nombre;
+		if ( (CodError=Receptor(Ruta, Entradas[i], pParametroUsuario)) != CODERROR_NINGUNO )
+			return(CodError);
+		if ( (Entradas[i].Flags&fedDIRECTORIO) && (Listados.insert(IdentificadorDirectorio(Entradas[i])).second) )
+		    {
+			itSubdirectorio=Pendientes.insert(itSiguiente, TDirectorioPendiente());
+			itSubdirectorio->Ruta.swap(Ruta);
+			itSubdirectorio->Entrada=Entradas[i];
+		    }
+	    }
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverBase :: ArmarRutaRecorrido							*
+ *																	*
+ * OBJETIVO: Esta función devuelve la ruta completa de un directorio encontrado al recorrer el volumen sin bajar por el árbol, a	*
+ *	     partir del padre y el nombre de cada directorio.										*
+ *																	*
+ * ENTRADA: IdDirectorio: Identificador del directorio, el mismo que usan los IdPadre.							*
+ *	    Directorios: Los directorios por identificador, con el raíz ya en erARMADA y los demás en erSIN_ARMAR.			*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, CODERROR_NO_ENCONTRADO si el directorio no existe o no	*
+ *	   llega al raíz.														*
+ *	   pRuta: La ruta, dentro de Directorios.											*
+ *	   Directorios: Con las rutas de los directorios del camino ya armadas.								*
+ *																	*
+ * OBSERVACIONES: Se sube por los padres hasta el primero con la ruta ya armada y se baja armando las del camino, así cada ruta se	*
+ *		  arma una sola vez. Un directorio que aparece dos veces en el camino es un ciclo, y todo el camino queda huérfano.	*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::ArmarRutaRecorrido(__u64 IdDirectorio, std::unordered_map<__u64, TDirectorioRecorrido> &Directorios, const TString *&pRuta)
+{
+std::unordered_map<__u64, TDirectorioRecorrido>::iterator	itDirectorio;
+std::vector<TDirectorioRecorrido *>				Camino;
+TDirectorioRecorrido						*pDirectorio;
+TEstadoRuta							Estado;
+size_t								i;
+
+/* Subir hasta un directorio que ya se sabe si llega al raíz */
+pDirectorio=NULL;
+for (;;)
+    {
+	if ( (itDirectorio=Directorios.find(IdDirectorio)) == Directorios.end() )
+	    {
+		Estado=erHUERFANA;
+		break;
+	    }
+	pDirectorio=&itDirectorio->second;
+	if (pDirectorio->Estado!=erSIN_ARMAR)
+	    {
+		Estado=pDirectorio->Estado==erARMADA ? erARMADA : erHUERFANA;
+		break;
+	    }
+	pDirectorio->Estado=erARMANDO;
+	Camino.push_back(pDirectorio);
+	IdDirectorio=pDirectorio->IdPadre;
+    }
+
+/* Bajar armando las rutas del camino */
+for (i=Camino.size();i>0;i--)
+    {
+	if (Estado==erARMADA)
+	    {
+		Camino[i-1]->Ruta=pDirectorio->Ruta;
+		Camino[i-1]->Ruta+='/';
+		Camino[i-1]->Ruta+=Camino[i-1]->Nombre;
+	    }
+	Camino[i-1]->Estado=Estado;
+	pDirectorio=Camino[i-1];
+    }
+
+/* Salir */
+if (Estado!=erARMADA)
+	return(CODERROR_NO_ENCONTRADO);
+pRuta=&pDirectorio->Ruta;
+return(CODERROR_NINGUNO);
+}
+
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverBase :: IndexarDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función devuelve un directorio listado e indexado por nombre, armándolo si no está entre los últimos usados.		*
+ *																	*
+ * ENTRADA: Directorio: Entrada del directorio.												*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   pIndice: El directorio indexado. Sigue siendo válido aunque se lo desaloje mientras quien llama lo tenga.			*
+ *																	*
+ * OBSERVACIONES: Cada nombre se normaliza una sola vez, al indexar. Se conservan los últimos directorios indexados mientras no		*
+ *		  sumen más de MAXIMO_ENTRADAS_INDEXADAS entradas (el último siempre se conserva). La lista sólo se bloquea para	*
+ *		  buscar y para agregar; el directorio se lista e indexa sin bloquear, y si otro hilo lo indexó mientras tanto se	*
+ *		  usa el suyo. Cada directorio se ubica en la lista por su identificador a través de PosicionIndexados, sin recorrerla.	*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::IndexarDirectorio(const TEntradaDirectorio &Directorio, std::shared_ptr<const TIndiceDirectorio> &pIndice) const
+{
+int							CodError;
+__u64							IdDirectorio;
+std::unordered_map<__u64, std::list< std::shared_ptr<const TIndiceDirectorio> >::iterator>::iterator	itPosicion;
+std::shared_ptr<TIndiceDirectorio>			pNuevo;
+TString							Nombre;
+__u32							Hash, Mascara, j;
+size_t							i, Ranuras;
+
+/* Ver si ya lo tengo indexado */
+IdDirectorio=IdentificadorDirectorio(Directorio);
+    {
+	std::lock_guard<std::mutex>	Bloqueo(MutexIndexados);
+	if ( (itPosicion=PosicionIndexados.find(IdDirectorio)) != PosicionIndexados.end() )
+	    {
+		DirectoriosIndexados.splice(DirectoriosIndexados.begin(), DirectoriosIndexados, itPosicion->second);
+		pIndice=DirectoriosIndexados.front();
+		return(CODERROR_NINGUNO);
+	    }
+    }
+
+/* Listarlo */
+pNuevo=std::make_shared<TIndiceDirectorio>();
+pNuevo->IdDirectorio=IdDirectorio;
+if ( (CodError=ListarDirectorioEntrada(Directorio, pNuevo->Entradas)) != CODERROR_NINGUNO )
+	return(CodError);
+
+/* Dimensionar la tabla para que quede a lo sumo a la mitad */
+for (Ranuras=16;Ranuras<2*pNuevo->Entradas.size();Ranuras<<=1);
+pNuevo->Ranuras.assign(Ranuras, TRanuraIndice());
+Mascara=Ranuras-1;
+
+/* Ubicar cada entrada en la primera ranura libre a partir de la que le corresponde por su hash */
+for (i=0;i<pNuevo->Entradas.size();i++)
+    {
+	Nombre=pNuevo->Entradas[i].Nombre;
+	NormalizarNombre(Nombre);
+	Hash=HashNombre(Nombre);
+	for (j=Hash&Mascara;pNuevo->Ranuras[j].Entrada;j=(j+1)&Mascara);
+	pNuevo->Ranuras[j].Hash=Hash;
+	pNuevo->Ranuras[j].Entrada=i+1;
+    }
+
+/* Agregarlo adelante, salvo que otro hilo se haya adelantado */
+std::lock_guard<std::mutex>	Bloqueo(MutexIndexados);
+if ( (itPosicion=PosicionIndexados.find(IdDirectorio)) != PosicionIndexados.end() )
+    {
+	pIndice=*itPosicion->second;
+	return(CODERROR_NINGUNO);
+    }
+DirectoriosIndexados.push_front(pNuevo);
+PosicionIndexados[IdDirectorio]=DirectoriosIndexados.begin();
+pIndice=pNuevo;
+
+/* Desalojar los directorios menos usados si me paso del máximo */
+EntradasIndexadas+=pNuevo->Entradas.size();
+while ( (EntradasIndexadas>MAXIMO_ENTRADAS_INDEXADAS) && (DirectoriosIndexados.size()>1) )
+    {
+	EntradasIndexadas-=DirectoriosIndexados.back()->Entradas.size();
+	PosicionIndexados.erase(DirectoriosIndexados.back()->IdDirectorio);
+	DirectoriosIndexados.pop_back();
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverBase :: BuscarEnIndice							*
+ *																	*
+ * OBJETIVO: Esta función busca un nombre en un directorio indexado.									*
+ *																	*
+ * ENTRADA: Indice: El directorio indexado.												*
+ *	    Nombre: Nombre, ya normalizado, a buscar.											*
+ *																	*
+ * SALIDA: En el nombre de la función la entrada encontrada, o NULL si no existe.							*
+ *																	*
+ * OBSERVACIONES: Si hay dos entradas con el mismo nombre normalizado se devuelve la primera del directorio, igual que una búsqueda	*
+ *		  lineal. Sólo se normalizan los nombres cuyo hash coincide.								*
+ *																	*
+ ****************************************************************************************************************************************/
+const TEntradaDirectorio *TDriverBase::BuscarEnIndice(const TIndiceDirectorio &Indice, const TString &Nombre) const
+{
+__u32			Hash, Mascara, j;
+const TRanuraIndice	*pRanuras;
+TString			Candidato;
+
+/* Recorrer las ranuras desde la que corresponde al hash hasta una libre */
+Hash=HashNombre(Nombre);
+Mascara=Indice.Ranuras.size()-1;
+pRanuras=Indice.Ranuras.data();
+for (j=Hash&Mascara;pRanuras[j].Entrada;j=(j+1)&Mascara)
+    {
+	if (pRanuras[j].Hash!=Hash)
+		continue;
+	Candidato=Indice.Entradas[pRanuras[j].Entrada-1].Nombre;
+	NormalizarNombre(Candidato);
+	if (Candidato==Nombre)
+		return(&Indice.Entradas[pRanuras[j].Entrada-1]);
+    }
+
+/* No está */
+return(NULL);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverBase :: HashNombre								*
+ *																	*
+ * OBJETIVO: Esta función calcula el hash (FNV-1a de 32 bits) de un nombre normalizado.							*
+ *																	*
+ * ENTRADA: Nombre: El nombre.														*
+ *																	*
+ * SALIDA: En el nombre de la función el hash.												*
+ *																	*
+ ****************************************************************************************************************************************/
+__u32 TDriverBase::HashNombre(const TString &Nombre)
+{
+__u32		Hash;
+size_t		i;
+
+Hash=2166136261U;
+for (i=0;i<Nombre.size();i++)
+    {
+	Hash^=(unsigned char)Nombre[i];
+	Hash*=16777619U;
+    }
+return(Hash);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TDriverBase :: ArmarClaveCacheRutas							*
+ *																	*
+ * OBJETIVO: Esta función arma la clave con que se guarda una entrada en el cache de rutas.						*
+ *																	*
+ * ENTRADA: IdPadre: Identificador del directorio que contiene la entrada.								*
+ *	    Nombre: Nombre normalizado de la entrada.											*
+ *																	*
+ * SALIDA: Clave: Los 8 bytes del identificador seguidos del nombre.									*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverBase::ArmarClaveCacheRutas(__u64 IdPadre, const TString &Nombre, TString &Clave) const
+{
+Clave.assign((const char *)&IdPadre, sizeof(IdPadre));
+Clave.append(Nombre);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverBase :: MostrarEstadisticas							*
+ *																	*
+ * OBJETIVO: Esta función muestra los contadores del cache de rutas.									*
+ *																	*
+ * ENTRADA: f: Archivo donde imprimir.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverBase::MostrarEstadisticas(FILE *f) const
+{
+__u64				Aciertos, Fallos, Total;
+std::lock_guard<std::mutex>	Bloqueo(MutexIndexados);
+
+/* Mostrar los contadores */
+Aciertos=CacheRutas.Aciertos();
+Fallos=CacheRutas.Fallos();
+Total=Aciertos+Fallos;
+fprintf(f, "Estadísticas del cache de rutas:\n");
+fprintf(f, "\tAciertos                : %llu\n", Aciertos);
+fprintf(f, "\tFallos                  : %llu\n", Fallos);
+fprintf(f, "\tTasa de aciertos        : %.2f%%\n", Total ? (100.0*Aciertos)/Total : 0.0);
+fprintf(f, "\tEntradas en cache       : %llu de %d\n", (__u64)CacheRutas.Entradas(), MAXIMO_ENTRADAS_CACHE_RUTAS);
+fprintf(f, "\tDirectorios indexados   : %llu (%llu entradas)\n", (__u64)DirectoriosIndexados.size(), EntradasIndexadas);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverBase :: DatosGrupoEXT							*
+ *																	*
+ * OBJETIVO: Esta función devuelve los datos de un grupo de un filesystem EXT.								*
+ *																	*
+ * ENTRADA: NroGrupo: Número de grupo (el primero es el 0).										*
+ *																	*
+ * SALIDA: En el nombre de la función los datos del grupo, o NULL si no existe.								*
+ *																	*
+ * OBSERVACIONES: Esta implementación no tiene grupos; el driver de EXT la redefine, levantando cada descriptor la primera vez que	*
+ *		  se lo pide.														*
+ *																	*
+ ****************************************************************************************************************************************/
+const TDatosGrupoFSEXT *TDriverBase::DatosGrupoEXT(int NroGrupo) const
+{
+return(NULL);
 }
 
 
@@ -89,12 +985,14 @@ return(DiskData+NroSector*DatosFS.BytesPorSector);
  * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
  *																	*
  * OBSERVACIONES: Si llega acá LevantarDatosSuperbloque() retornó sin errores, por lo que el TipoFilesystem es uno de los tipos 	*
- *		  soportados.														*
+ *		  soportados. Los descriptores de los grupos de EXT que todavía no se usaron se levantan a medida que se muestran (ver	*
+ *		  DatosGrupoEXT()).													*
  *																	*
  ****************************************************************************************************************************************/
 int TDriverBase::MostrarDatosSuperbloque(void)
 {
-unsigned	i;
+const TDatosGrupoFSEXT	*pGrupo;
+unsigned		i;
 
 /* Mostrar los datos que tenga */
 printf("Datos del superbloque:\n");
@@ -142,6 +1040,10 @@ switch (DatosFS.TipoFilesystem)
 		printf("\tSectores/FAT            : %d\n", DatosFS.DatosEspecificos.FAT.SectoresPorFAT);
 		printf("\tNro Clusters RootDir    : %d\n", DatosFS.DatosEspecificos.FAT.ClustersRootDir);
 		printf("\t1er Cluster RootDir     : %d\n", DatosFS.DatosEspecificos.FAT.PrimerClusterRootDir);
+		if (DatosFS.TipoFilesystem == tfsFAT32 && DatosFS.DatosEspecificos.FAT.ClustersLibres >= 0)
+			printf("\tClusters Libres         : %d\n", DatosFS.DatosEspecificos.FAT.ClustersLibres);
+		if (DatosFS.TipoFilesystem == tfsFAT32 && DatosFS.DatosEspecificos.FAT.ProximoClusterLibre >= 0)
+			printf("\tProximo Cluster Libre   : %d\n", DatosFS.DatosEspecificos.FAT.ProximoClusterLibre);
 		break;
 	case tfsEXT2:
 	case tfsEXT3:
@@ -157,17 +1059,17 @@ switch (DatosFS.TipoFilesystem)
 		printf("\tPeríodo Agrupado Flex   : %d\n", DatosFS.DatosEspecificos.EXT.PeriodoAgrupadoFlex);
 		printf("\tNro Clust. reserv. GDT  : %d\n", DatosFS.DatosEspecificos.EXT.ClustersReservadosGDT);
 		printf("\tCluster Bitmap INodes   : ");
-		for(i=0;i<DatosFS.DatosEspecificos.EXT.NroGrupos;i++)
-			printf("%llu%s", DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterBitmapINodes, i!=(DatosFS.DatosEspecificos.EXT.NroGrupos-1)? ", ":"\n");
+		for(i=0;i<(unsigned)DatosFS.DatosEspecificos.EXT.NroGrupos;i++)
+			printf("%llu%s", (pGrupo=DatosGrupoEXT(i)) ? pGrupo->ClusterBitmapINodes : 0ULL, i!=(unsigned)(DatosFS.DatosEspecificos.EXT.NroGrupos-1)? ", ":"\n");
 		printf("\tCluster Tabla INodes    : ");
-		for(i=0;i<DatosFS.DatosEspecificos.EXT.NroGrupos;i++)
-			printf("%llu%s", DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterTablaINodes, i!=(DatosFS.DatosEspecificos.EXT.NroGrupos-1)? ", ":"\n");
+		for(i=0;i<(unsigned)DatosFS.DatosEspecificos.EXT.NroGrupos;i++)
+			printf("%llu%s", (pGrupo=DatosGrupoEXT(i)) ? pGrupo->ClusterTablaINodes : 0ULL, i!=(unsigned)(DatosFS.DatosEspecificos.EXT.NroGrupos-1)? ", ":"\n");
 		printf("\tCluster Bitmap Bloques  : ");
-		for(i=0;i<DatosFS.DatosEspecificos.EXT.NroGrupos;i++)
-			printf("%llu%s", DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterBitmapBloques, i!=(DatosFS.DatosEspecificos.EXT.NroGrupos-1)? ", ":"\n");
+		for(i=0;i<(unsigned)DatosFS.DatosEspecificos.EXT.NroGrupos;i++)
+			printf("%llu%s", (pGrupo=DatosGrupoEXT(i)) ? pGrupo->ClusterBitmapBloques : 0ULL, i!=(unsigned)(DatosFS.DatosEspecificos.EXT.NroGrupos-1)? ", ":"\n");
 		printf("\tCluster Tabla Bloques   : ");
-		for(i=0;i<DatosFS.DatosEspecificos.EXT.NroGrupos;i++)
-			printf("%llu%s", DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterTablaBloques, i!=(DatosFS.DatosEspecificos.EXT.NroGrupos-1)? ", ":"\n");
+		for(i=0;i<(unsigned)DatosFS.DatosEspecificos.EXT.NroGrupos;i++)
+			printf("%llu%s", (pGrupo=DatosGrupoEXT(i)) ? pGrupo->ClusterTablaBloques : 0ULL, i!=(unsigned)(DatosFS.DatosEspecificos.EXT.NroGrupos-1)? ", ":"\n");
 		break;
 	case tfsNTFS:
 		printf("\tOffset Part en Sectores : %d\n", DatosFS.DatosEspecificos.NTFS.OffsetParticionEnSectores);
@@ -192,120 +1094,114 @@ return(CODERROR_NINGUNO);
  * OBJETIVO: Esta función muestra en contenido de un directorio.									*
  *																	*
  * ENTRADA: Entradas: Arreglo de estructuras con las entradas (archivos/directorios/etc) a mostrar.					*
+ *	    Salida: Dónde imprimirlo.													*
  *																	*
  * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
  *																	*
+ * OBSERVACIONES: Cada línea se arma a mano en el buffer de salida, con el mismo resultado que los printf() de cada campo.		*
+ *																	*
  ****************************************************************************************************************************************/
-int TDriverBase::MostrarDatosDirectorio(std::vector<TEntradaDirectorio> &Entradas)
+int TDriverBase::MostrarDatosDirectorio(std::vector<TEntradaDirectorio> &Entradas, TBufferSalida &Salida) const
 {
-char	aux[65];
-int	i;
-tm	*LocalTime;
+char		Flags[12];
+size_t		i, BytesNombre;
+int		j;
+const time_t	*Fechas[3];
+tm		LocalTime;
 
 /* Primer fila del encabezado */
-printf(" Fecha Creación   Fecha Ult Acceso  Fecha Ult Modif                                Nombre                                 Flags     Tamaño  ");
+Salida.Texto(" Fecha Creación   Fecha Ult Acceso  Fecha Ult Modif                                Nombre                                 Flags     Tamaño  ");
 switch(DatosFS.TipoFilesystem)
     {
 	case tfsFAT12:
 	case tfsFAT16:
 	case tfsFAT32:
-		printf("   1º Clu  ");
+		Salida.Texto("   1º Clu  ");
 		break;
 	case tfsEXT2:
 	case tfsEXT3:
 	case tfsEXT4:
-		printf("    INode   ");
+		Salida.Texto("    INode   ");
 		break;
 	case tfsNTFS:
-		printf("   Índice MFT     Sec ");
+		Salida.Texto("   Índice MFT     Sec ");
 		break;
     }
-printf("\n");
+Salida.Caracter('\n');
 
 /* Segunda fila del encabezado */
-printf("----------------- ----------------- ----------------- ---------------------------------------------------------------- ----------- ----------");
+Salida.Texto("----------------- ----------------- ----------------- ---------------------------------------------------------------- ----------- ----------");
 switch(DatosFS.TipoFilesystem)
     {
 	case tfsFAT12:
 	case tfsFAT16:
 	case tfsFAT32:
-		printf(" ----------");
+		Salida.Texto(" ----------");
 		break;
 	case tfsEXT2:
 	case tfsEXT3:
 	case tfsEXT4:
-		printf(" -----------");
+		Salida.Texto(" -----------");
 		break;
 	case tfsNTFS:
-		printf(" --------------- ----");
+		Salida.Texto(" --------------- ----");
 		break;
     }
-printf("\n");
+Salida.Caracter('\n');
 
 /* Para cada entrada de directorio a mostrar */
 for(i=0;i<Entradas.size();i++)
     {
-	/* Mostrar la fecha de creación */
-	if (!Entradas[i].FechaCreacion)
-	    {
-		/* No tengo esa fecha, dejarla en blanco */
-		printf("                  ");
-	    }
-	else
+	/* Mostrar las fechas de creación, último acceso y última modificación como "dd/mm/aaaa hh:mm  " */
+	Fechas[0]=&Entradas[i].FechaCreacion;
+	Fechas[1]=&Entradas[i].FechaUltimoAcceso;
+	Fechas[2]=&Entradas[i].FechaUltimaModificacion;
+	for (j=0;j<3;j++)
 	    {
-		/* Convertir el valor a HMS */
-		LocalTime=localtime(&Entradas[i].FechaCreacion);
-		printf("%02d/%02d/%04d %02d:%02d  ", LocalTime->tm_mday, 1+LocalTime->tm_mon, 1900+LocalTime->tm_year, LocalTime->tm_hour, LocalTime->tm_min);
-	    }
+		if (!*Fechas[j])
+		    {
+			/* No tengo esa fecha, dejarla en blanco */
+			Salida.Repetir(' ', 18);
+			continue;
+		    }
 
-	/* Mostrar la fecha de último acceso */
-	if (!Entradas[i].FechaUltimoAcceso)
-	    {
-		/* No tengo esa fecha, dejarla en blanco */
-		printf("                  ");
-	    }
-	else
-	    {
 		/* Convertir el valor a HMS */
-		LocalTime=localtime(&Entradas[i].FechaUltimoAcceso);
-		printf("%02d/%02d/%04d %02d:%02d  ", LocalTime->tm_mday, 1+LocalTime->tm_mon, 1900+LocalTime->tm_year, LocalTime->tm_hour, LocalTime->tm_min);
-	    }
-	
-	/* Mostrar la fecha de última modificación */
-	if (!Entradas[i].FechaUltimaModificacion)
-	    {
-		/* No tengo esa fecha, dejarla en blanco */
-		printf("                  ");
-	    }
-	else
-	    {
-		/* Convertir el valor a HMS */
-		LocalTime=localtime(&Entradas[i].FechaUltimaModificacion);
-		printf("%02d/%02d/%04d %02d:%02d  ", LocalTime->tm_mday, 1+LocalTime->tm_mon, 1900+LocalTime->tm_year, LocalTime->tm_hour, LocalTime->tm_min);
+		localtime_r(Fechas[j], &LocalTime);
+		Salida.Decimal(LocalTime.tm_mday, 2, '0');
+		Salida.Caracter('/');
+		Salida.Decimal(1+LocalTime.tm_mon, 2, '0');
+		Salida.Caracter('/');
+		Salida.Decimal(1900+LocalTime.tm_year, 4, '0');
+		Salida.Caracter(' ');
+		Salida.Decimal(LocalTime.tm_hour, 2, '0');
+		Salida.Caracter(':');
+		Salida.Decimal(LocalTime.tm_min, 2, '0');
+		Salida.Texto("  ", 2);
 	    }
 
-	/* Mostrar el nombre */
-	strncpy(aux, Entradas[i].Nombre.c_str(), 64);
-	aux[64]='\0';
-	printf("%64s", aux);
+	/* Mostrar el nombre, alineado a la derecha en 64 caracteres */
+	BytesNombre=strnlen(Entradas[i].Nombre.c_str(), 64);
+	Salida.Repetir(' ', 64-BytesNombre);
+	Salida.Texto(Entradas[i].Nombre.c_str(), BytesNombre);
 	
 	/* Imprimir los flags */
-	printf(" ");
-	printf("%c", Entradas[i].Flags&fedSOLO_LECTURA     ? 'R' : ' ');
-	printf("%c", Entradas[i].Flags&fedOCULTO           ? 'H' : ' ');
-	printf("%c", Entradas[i].Flags&fedSISTEMA          ? 'S' : ' ');
-	printf("%c", Entradas[i].Flags&fedETIQUETA_VOLUMEN ? 'V' : ' ');
-	printf("%c", Entradas[i].Flags&fedDIRECTORIO       ? 'D' : ' ');
-	printf("%c", Entradas[i].Flags&fedARCHIVAR         ? 'A' : ' ');
-	printf("%c", Entradas[i].Flags&fedACCESO_DIRECTO   ? 'L' : ' ');
-	printf("%c", Entradas[i].Flags&fedCOMPRIMIDO       ? 'C' : ' ');
-	printf("%c", Entradas[i].Flags&fedENCRIPTADO       ? 'E' : ' ');
-	printf("%c", Entradas[i].Flags&fedDISPERSO         ? 'P' : ' ');
-	printf(" ");
-
+	Flags[0]=' ';
+	Flags[1]=Entradas[i].Flags&fedSOLO_LECTURA     ? 'R' : ' ';
+	Flags[2]=Entradas[i].Flags&fedOCULTO           ? 'H' : ' ';
+	Flags[3]=Entradas[i].Flags&fedSISTEMA          ? 'S' : ' ';
+	Flags[4]=Entradas[i].Flags&fedETIQUETA_VOLUMEN ? 'V' : ' ';
+	Flags[5]=Entradas[i].Flags&fedDIRECTORIO       ? 'D' : ' ';
+	Flags[6]=Entradas[i].Flags&fedARCHIVAR         ? 'A' : ' ';
+	Flags[7]=Entradas[i].Flags&fedACCESO_DIRECTO   ? 'L' : ' ';
+	Flags[8]=Entradas[i].Flags&fedCOMPRIMIDO       ? 'C' : ' ';
+	Flags[9]=Entradas[i].Flags&fedENCRIPTADO       ? 'E' : ' ';
+	Flags[10]=Entradas[i].Flags&fedDISPERSO        ? 'P' : ' ';
+	Flags[11]=' ';
+	Salida.Texto(Flags, sizeof(Flags));
 
 	/* Colocar el tamaño */
-	printf(" %10llu", Entradas[i].Bytes);
+	Salida.Caracter(' ');
+	Salida.Decimal(Entradas[i].Bytes, 10);
 
 	/* Mostrar columnas FS dependientes */
 	switch(DatosFS.TipoFilesystem)
@@ -314,20 +1210,24 @@ for(i=0;i<Entradas.size();i++)
 		case tfsFAT16:
 		case tfsFAT32:
 			/* Colocar el primer cluster */
-			printf(" %10u", Entradas[i].DatosEspecificos.FAT.PrimerCluster);
+			Salida.Caracter(' ');
+			Salida.Decimal(Entradas[i].DatosEspecificos.FAT.PrimerCluster, 10);
 			break;
 		case tfsEXT2:
 		case tfsEXT3:
 		case tfsEXT4:
-			printf(" %11u", Entradas[i].DatosEspecificos.EXT.INode);
+			Salida.Caracter(' ');
+			Salida.Decimal(Entradas[i].DatosEspecificos.EXT.INode, 11);
 			break;
 		case tfsNTFS:
-			printf(" %15llu", Entradas[i].DatosEspecificos.NTFS.IndiceMFT);
-			printf(" %04X", Entradas[i].DatosEspecificos.NTFS.NroSecuencia);
+			Salida.Caracter(' ');
+			Salida.Decimal(Entradas[i].DatosEspecificos.NTFS.IndiceMFT, 15);
+			Salida.Caracter(' ');
+			Salida.Hexa(Entradas[i].DatosEspecificos.NTFS.NroSecuencia, 4, true);
 	    }
 
 	/* Cerrar la línea */
-	printf("\n");
+	Salida.Caracter('\n');
     }
 
 /* Salir */
@@ -343,48 +1243,46 @@ return(CODERROR_NINGUNO);
  *																	*
  *  ENTRADA: Buffer: Puntero al bloque binario.												*
  *	     BufferLen: Longitud del bloque a imprimir.											*
+ *	     OffsetInicial: Posición del bloque dentro del archivo, para numerar las líneas (al imprimirlo de a partes).		*
+ *	     Salida: Dónde imprimirlo.													*
  *																	*
  *  SALIDA: Nada.															*
  *																	*
+ *  OBSERVACIONES: Cada línea se arma directamente en el buffer de salida, pasando los bytes a hexa con una tabla.			*
+ *																	*
  ****************************************************************************************************************************************/
-void TDriverBase::PrintBuffer(const unsigned char *Buffer, unsigned BufferLen, unsigned BytesPorLinea)
+void TDriverBase::PrintBuffer(const unsigned char *Buffer, __u64 BufferLen, unsigned BytesPorLinea, __u64 OffsetInicial, TBufferSalida &Salida) const
 {
-int	i, j;
+__u64		i;
+unsigned	j, BytesLinea;
+char		*pInicio, *p;
 
 /* Inicializar la salida */
 i=0;
 while (i<BufferLen)
     {
 	/* Indentar la línea */
-	printf("    %08x    ", i);
+	Salida.Texto("    ", 4);
+	Salida.Hexa(OffsetInicial+i, 8, false);
+	Salida.Texto("    ", 4);
 
-	/* Tomar un bloque de BytesPorLinea caracteres e imprimirlo como hexa */
-	for(j=i;j<(i+BytesPorLinea);j++)
-	    {
-		if (j<BufferLen)
-			printf("%02X ", Buffer[j]);
-		else
-			printf("   ");
-	    }
+	/* Tomar un bloque de BytesPorLinea caracteres e imprimirlo como hexa, completando la última línea con espacios */
+	BytesLinea=BufferLen-i<BytesPorLinea ? BufferLen-i : BytesPorLinea;
+	pInicio=p=Salida.Reservar(4*BytesPorLinea+1);
+	for(j=0;j<BytesLinea;j++,p+=3)
+		memcpy(p, TBufferSalida::HexaMayusculas(Buffer[i+j]), 3);
+	memset(p, ' ', 3*(BytesPorLinea-BytesLinea));
+	p+=3*(BytesPorLinea-BytesLinea);
 
 	/* Tomar el mismo bloque e imprimirlo como caracteres */
-	for(j=i;j<(i+BytesPorLinea);j++)
-	    {
-		if (j<BufferLen)
-		    {
-			if ( (Buffer[j]>=' ')||((Buffer[j]<0)) )
-				printf("%c", Buffer[j]);
-			else
-				printf(".");
-		    }
-		else
-		    {
-			printf(" ");
-		    }
-	    }
+	for(j=0;j<BytesLinea;j++)
+		*p++=TBufferSalida::Imprimible(Buffer[i+j]);
+	memset(p, ' ', BytesPorLinea-BytesLinea);
+	p+=BytesPorLinea-BytesLinea;
 
 	/* Cerrar la línea */
-	printf("\n");
+	*p++='\n';
+	Salida.Avanzar(p-pInicio);
 
 	/* Pasar al siguiente bloque */
 	i+=BytesPorLinea;
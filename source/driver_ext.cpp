@@ -12,14 +12,16 @@
  *																	*
  * OBJETIVO: Inicializar la clase recién creada.											*
  *																	*
- * ENTRADA: DiskData: Puntero a un bloque de memoria con la imágen del disco a analizar.						*
- *	    LongitudDiskData: Tamaño, en bytes, de la imágen a analizar.								*
+ * ENTRADA: FuenteBloques: Fuente de la que leer la imágen del disco a analizar.							*
  *																	*
  * SALIDA: Nada.															*
  *																	*
  ****************************************************************************************************************************************/
-TDriverEXT::TDriverEXT(const unsigned char *DiskData, unsigned LongitudDiskData) : TDriverBase(DiskData, LongitudDiskData)
+TDriverEXT::TDriverEXT(TFuenteBloques *FuenteBloques) : TDriverBase(FuenteBloques)
 {
+/* Inicializar variables */
+GruposCargados=NULL;
+CacheINodes.Dimensionar(MAXIMO_INODES_CACHE);
 }
 
 
@@ -36,6 +38,7 @@ TDriverEXT::TDriverEXT(const unsigned char *DiskData, unsigned LongitudDiskData)
  ****************************************************************************************************************************************/
 TDriverEXT::~TDriverEXT()
 {
+delete[] GruposCargados;
 }
 
 /****************************************************************************************************************************************
@@ -50,32 +53,1618 @@ TDriverEXT::~TDriverEXT()
  *		CODERROR_SUPERBLOQUE_INVALIDO   : El superbloque está dañado o no corresponde a un disco con ningún formato.		*
  *		CODERROR_FILESYSTEM_DESCONOCIDO : El superbloque es válido, pero no corresponde a un FyleSystem soportado por esta	*
  *						  clase.										*
+ *		CODERROR_FEATURE_DESCONOCIDO    : El filesystem usa alguna característica incompatible que este driver no sabe leer.	*
  * ****************************************************************************************************************************************/
 int TDriverEXT::LevantarDatosSuperbloque()
 {
+const TSuperBloqueEXT	*pSuperBloque;
+TDatosFSEXT		&DatosEXT = DatosFS.DatosEspecificos.EXT;
+const TDatosGrupoFSEXT	*pGrupo;
+int			CodError, BytesPorBloque, i;
+
+/* Levantar el superbloque, que siempre está a 1024 bytes del comienzo */
+if ( (pSuperBloque=(const TSuperBloqueEXT *)PunteroABytes(EXT_OFFSET_SUPERBLOQUE, sizeof(TSuperBloqueEXT))) == NULL )
+	return(CODERROR_SUPERBLOQUE_INVALIDO);
+if (pSuperBloque->s_magic!=(__le16)EXT_MAGIC_SUPERBLOQUE)
+	return(CODERROR_SUPERBLOQUE_INVALIDO);
+memcpy(&SuperBloque, pSuperBloque, sizeof(SuperBloque));
+
+/* Validar los valores que se usan para hacer cuentas */
+if ( ((__u32)SuperBloque.s_log_block_size>6) || (SuperBloque.s_blocks_per_group<=0) || (SuperBloque.s_inodes_per_group<=0) || (SuperBloque.s_inodes_count<=0) )
+	return(CODERROR_SUPERBLOQUE_INVALIDO);
+BytesPorBloque=1024<<SuperBloque.s_log_block_size;
+DatosEXT.BytesPorINode=SuperBloque.s_rev_level ? (__u16)SuperBloque.s_inode_size : EXT_BYTES_INODE_BASICO;
+if ( (DatosEXT.BytesPorINode<EXT_BYTES_INODE_BASICO) || (DatosEXT.BytesPorINode>BytesPorBloque) || (DatosEXT.BytesPorINode&(DatosEXT.BytesPorINode-1)) )
+	return(CODERROR_SUPERBLOQUE_INVALIDO);
+
+/* No se puede leer un filesystem que use algo incompatible que no se conoce */
+if (SuperBloque.s_rev_level && (SuperBloque.s_feature_incompat&~EXT_FEATURE_INCOMPAT_SOPORTADAS))
+	return(CODERROR_FEATURE_DESCONOCIDO);
+
+/* Tamaño de los descriptores de grupo (con 64 bits pueden ser más grandes) */
+BytesPorDescriptor=sizeof(TEntradaDescGrupoEXT23);
+if (SuperBloque.s_feature_incompat&EXT4_FEATURE_INCOMPAT_64BIT)
+    {
+	BytesPorDescriptor=(__u16)SuperBloque.s_desc_size;
+	if ( (BytesPorDescriptor<sizeof(TEntradaDescGrupoEXT23)) || (BytesPorDescriptor>(unsigned)BytesPorBloque) || (BytesPorDescriptor&(BytesPorDescriptor-1)) )
+		return(CODERROR_SUPERBLOQUE_INVALIDO);
+    }
+
+/* Cantidad de bloques */
+NumeroDeBloques=(__u32)SuperBloque.s_blocks_count_lo;
+if (SuperBloque.s_feature_incompat&EXT4_FEATURE_INCOMPAT_64BIT)
+	NumeroDeBloques|=(__u64)(__u32)SuperBloque.s_blocks_count_hi<<32;
+if (NumeroDeBloques<=(__u32)SuperBloque.s_first_data_block)
+	return(CODERROR_SUPERBLOQUE_INVALIDO);
+
+/* Datos de todo filesystem */
+if ( (SuperBloque.s_feature_incompat&EXT4_FEATURE_INCOMPAT_PROPIAS) || (SuperBloque.s_feature_ro_compat&EXT4_FEATURE_RO_COMPAT_PROPIAS) )
+	DatosFS.TipoFilesystem=tfsEXT4;
+else if (SuperBloque.s_feature_compat&EXT3_FEATURE_COMPAT_HAS_JOURNAL)
+	DatosFS.TipoFilesystem=tfsEXT3;
+else
+	DatosFS.TipoFilesystem=tfsEXT2;
+DatosFS.BytesPorSector=512;
+DatosFS.BytesPorCluster=BytesPorBloque;
+DatosFS.NumeroDeClusters=NumeroDeBloques;
+
+/* Datos propios de EXT */
+DatosEXT.CaracteristicasCompatibles=SuperBloque.s_feature_compat;
+DatosEXT.CaracteristicasIncompatibles=SuperBloque.s_feature_incompat;
+DatosEXT.CaracteristicasSoloLectura=SuperBloque.s_feature_ro_compat;
+DatosEXT.NumeroDeINodes=SuperBloque.s_inodes_count;
+DatosEXT.ClustersPorGrupo=SuperBloque.s_blocks_per_group;
+DatosEXT.INodesPorGrupo=SuperBloque.s_inodes_per_group;
+DatosEXT.ClustersReservadosGDT=SuperBloque.s_reserved_gdt_blocks;
+DatosEXT.PeriodoAgrupadoFlex=(SuperBloque.s_feature_incompat&EXT4_FEATURE_INCOMPAT_FLEX_BG) ? 1<<SuperBloque.s_log_groups_per_flex : 0;
+DatosEXT.NroGrupos=(NumeroDeBloques-SuperBloque.s_first_data_block+SuperBloque.s_blocks_per_group-1)/SuperBloque.s_blocks_per_group;
+if ((__u64)DatosEXT.NroGrupos*(__u32)SuperBloque.s_inodes_per_group<(__u32)SuperBloque.s_inodes_count)
+	return(CODERROR_SUPERBLOQUE_INVALIDO);
+
+/* Los descriptores se levantan recién cuando se usan (ver CargarDatosGrupo()), acá sólo se valida el primero */
+DatosGrupos.assign(DatosEXT.NroGrupos, TDatosGrupoFSEXT());
+delete[] GruposCargados;
+GruposCargados=new std::atomic<bool>[DatosEXT.NroGrupos];
+for (i=0;i<DatosEXT.NroGrupos;i++)
+	GruposCargados[i]=false;
+if ( (CodError=CargarDatosGrupo(0, pGrupo)) != CODERROR_NINGUNO )
+	return(CodError);
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverEXT :: CargarDatosGrupo							*
+ *																	*
+ * OBJETIVO: Esta función devuelve los datos de un grupo, levantando su descriptor la primera vez que se piden.				*
+ *																	*
+ * ENTRADA: NroGrupo: Número de grupo (el primero es el 0).										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   pGrupo: Puntero a los datos del grupo en DatosGrupos, que no cambian una vez levantados.					*
+ *																	*
+ * OBSERVACIONES: Así levantar el superbloque no depende de la cantidad de grupos, que en un volumen de varios TB son decenas de	*
+ *		  miles: sólo se leen los descriptores de los grupos que se usan. Varios hilos pueden pedir el mismo grupo a la vez:	*
+ *		  el descriptor se levanta bajo MutexGrupos y recién después se marca cargado, así que quien lo ve marcado lo lee sin	*
+ *		  bloquear.														*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::CargarDatosGrupo(__u32 NroGrupo, const TDatosGrupoFSEXT *&pGrupo) const
+{
+int		CodError;
+
+/* Validar el número de grupo */
+if (NroGrupo>=(__u32)DatosFS.DatosEspecificos.EXT.NroGrupos)
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Levantar el descriptor si todavía no se hizo (fijándose de nuevo con el mutex tomado, por si otro hilo se adelantó) */
+if (!GruposCargados[NroGrupo].load(std::memory_order_acquire))
+    {
+	std::lock_guard<std::mutex>	Bloqueo(MutexGrupos);
+	if (!GruposCargados[NroGrupo].load(std::memory_order_relaxed))
+	    {
+		if ( (CodError=LeerDescriptorGrupo(NroGrupo, DatosGrupos[NroGrupo])) != CODERROR_NINGUNO )
+			return(CodError);
+		GruposCargados[NroGrupo].store(true, std::memory_order_release);
+	    }
+    }
+pGrupo=&DatosGrupos[NroGrupo];
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverEXT :: DatosGrupoEXT							*
+ *																	*
+ * OBJETIVO: Esta función devuelve los datos de un grupo para mostrarlos, levantando su descriptor si hace falta.			*
+ *																	*
+ * ENTRADA: NroGrupo: Número de grupo (el primero es el 0).										*
+ *																	*
+ * SALIDA: En el nombre de la función los datos del grupo, o NULL si no se pudo leer su descriptor.					*
+ *																	*
+ ****************************************************************************************************************************************/
+const TDatosGrupoFSEXT *TDriverEXT::DatosGrupoEXT(int NroGrupo) const
+{
+const TDatosGrupoFSEXT	*pGrupo;
+
+if ( (NroGrupo<0) || (CargarDatosGrupo(NroGrupo, pGrupo)!=CODERROR_NINGUNO) )
+	return(NULL);
+return(pGrupo);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverEXT :: LeerDescriptorGrupo							*
+ *																	*
+ * OBJETIVO: Esta función lee de la imágen el descriptor de un grupo.									*
+ *																	*
+ * ENTRADA: NroGrupo: Número de grupo (el primero es el 0).										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   DatosGrupo: Ubicación de los bitmaps y la tabla de inodes del grupo, y sus flags.						*
+ *																	*
+ * OBSERVACIONES: Con META_BG los descriptores de cada meta grupo están en el primer grupo del meta grupo, si no están todos juntos	*
+ *		  a continuación del superbloque.											*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::LeerDescriptorGrupo(__u32 NroGrupo, TDatosGrupoFSEXT &DatosGrupo) const
+{
+const TEntradaDescGrupoEXT4	*pDescriptor;
+__u32				DescriptoresPorBloque, MetaGrupo, PrimerGrupo;
+__u64				NroBloque;
+bool				Es64Bits;
+
+/* Ubicar el bloque donde está el descriptor */
+DescriptoresPorBloque=DatosFS.BytesPorCluster/BytesPorDescriptor;
+MetaGrupo=NroGrupo/DescriptoresPorBloque;
+if ( (SuperBloque.s_feature_incompat&EXT2_FEATURE_INCOMPAT_META_BG) && (MetaGrupo>=(__u32)SuperBloque.s_first_meta_bg) )
+    {
+	PrimerGrupo=MetaGrupo*DescriptoresPorBloque;
+	NroBloque=SuperBloque.s_first_data_block+(__u64)PrimerGrupo*SuperBloque.s_blocks_per_group+(GrupoTieneSuperbloque(PrimerGrupo) ? 1 : 0);
+    }
+else
+	NroBloque=SuperBloque.s_first_data_block+1+MetaGrupo;
+
+/* Levantarlo */
+pDescriptor=(const TEntradaDescGrupoEXT4 *)PunteroABytes(NroBloque*DatosFS.BytesPorCluster+(NroGrupo%DescriptoresPorBloque)*BytesPorDescriptor, BytesPorDescriptor);
+if (!pDescriptor)
+	return(CODERROR_LECTURA_DISCO);
+
+/* Los descriptores de 64 bits tienen la parte alta de cada número de bloque */
+Es64Bits=BytesPorDescriptor>=sizeof(TEntradaDescGrupoEXT4);
+DatosGrupo.ClusterBitmapBloques=(__u32)pDescriptor->bg_block_bitmap_lo | (Es64Bits ? (__u64)(__u32)pDescriptor->bg_block_bitmap_hi<<32 : 0);
+DatosGrupo.ClusterBitmapINodes=(__u32)pDescriptor->bg_inode_bitmap_lo | (Es64Bits ? (__u64)(__u32)pDescriptor->bg_inode_bitmap_hi<<32 : 0);
+DatosGrupo.ClusterTablaINodes=(__u32)pDescriptor->bg_inode_table_lo | (Es64Bits ? (__u64)(__u32)pDescriptor->bg_inode_table_hi<<32 : 0);
+DatosGrupo.ClusterTablaBloques=PrimerClusterDatosGrupo(NroGrupo, DatosGrupo.ClusterTablaINodes);
+DatosGrupo.Flags=(__u16)pDescriptor->bg_flags;
+DatosGrupo.INodesSinUsar=(__u16)pDescriptor->bg_itable_unused_lo | (Es64Bits ? (__u32)(__u16)pDescriptor->bg_itable_unused_hi<<16 : 0);
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverEXT :: PrimerClusterDatosGrupo							*
+ *																	*
+ * OBJETIVO: Esta función calcula el primer cluster de un grupo que queda después de su metadata.					*
+ *																	*
+ * ENTRADA: NroGrupo: Número de grupo (el primero es el 0).										*
+ *	    ClusterTablaINodes: Dónde empieza la tabla de inodes del grupo.								*
+ *																	*
+ * SALIDA: En el nombre de la función el número de cluster.										*
+ *																	*
+ * OBSERVACIONES: Si la tabla de inodes está dentro del grupo los datos empiezan después de ella. Con FLEX_BG las tablas de todo el	*
+ *		  agrupado flex están juntas en su primer grupo, y los demás grupos sólo tienen la copia del superbloque con los	*
+ *		  descriptores y los clusters reservados para la GDT, si es que la tienen.						*
+ *																	*
+ ****************************************************************************************************************************************/
+__u64 TDriverEXT::PrimerClusterDatosGrupo(__u32 NroGrupo, __u64 ClusterTablaINodes) const
+{
+__u32	DescriptoresPorBloque, NroGrupos, Resto, TablasEnGrupo;
+__u64	PrimerCluster, NroCluster, ClustersTablaINodes;
+
+/* Tablas de inodes que guarda el grupo */
+NroGrupos=(__u32)DatosFS.DatosEspecificos.EXT.NroGrupos;
+PrimerCluster=SuperBloque.s_first_data_block+(__u64)NroGrupo*SuperBloque.s_blocks_per_group;
+if ( (ClusterTablaINodes>=PrimerCluster) && (ClusterTablaINodes<PrimerCluster+SuperBloque.s_blocks_per_group) )
+    {
+	TablasEnGrupo=1;
+	if ( (DatosFS.DatosEspecificos.EXT.PeriodoAgrupadoFlex) && !(NroGrupo%(__u32)DatosFS.DatosEspecificos.EXT.PeriodoAgrupadoFlex) )
+		TablasEnGrupo=min((__u32)DatosFS.DatosEspecificos.EXT.PeriodoAgrupadoFlex, NroGrupos-NroGrupo);
+	ClustersTablaINodes=((__u64)SuperBloque.s_inodes_per_group*DatosFS.DatosEspecificos.EXT.BytesPorINode+DatosFS.BytesPorCluster-1)/DatosFS.BytesPorCluster;
+	return(ClusterTablaINodes+TablasEnGrupo*ClustersTablaINodes);
+    }
+
+/* Superbloque y descriptores de grupo */
+DescriptoresPorBloque=DatosFS.BytesPorCluster/BytesPorDescriptor;
+NroCluster=PrimerCluster;
+if (GrupoTieneSuperbloque(NroGrupo))
+	NroCluster++;
+if ( (SuperBloque.s_feature_incompat&EXT2_FEATURE_INCOMPAT_META_BG) && (NroGrupo/DescriptoresPorBloque>=(__u32)SuperBloque.s_first_meta_bg) )
+    {
+	/* Con META_BG el bloque de descriptores del meta grupo está en su primer, segundo y último grupo */
+	Resto=NroGrupo%DescriptoresPorBloque;
+	if ( (Resto==0) || (Resto==1) || (Resto==DescriptoresPorBloque-1) )
+		NroCluster++;
+    }
+else if (GrupoTieneSuperbloque(NroGrupo))
+    {
+	if (SuperBloque.s_feature_incompat&EXT2_FEATURE_INCOMPAT_META_BG)
+		NroCluster+=(__u32)SuperBloque.s_first_meta_bg;
+	else
+		NroCluster+=(NroGrupos+DescriptoresPorBloque-1)/DescriptoresPorBloque+(__u16)SuperBloque.s_reserved_gdt_blocks;
+    }
+return(NroCluster);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverEXT :: GrupoTieneSuperbloque							*
+ *																	*
+ * OBJETIVO: Esta función indica si un grupo tiene una copia del superbloque (y de los descriptores) al comienzo.			*
+ *																	*
+ * ENTRADA: NroGrupo: Número de grupo.													*
+ *																	*
+ * SALIDA: En el nombre de la función true si la tiene.											*
+ *																	*
+ * OBSERVACIONES: Con SPARSE_SUPER sólo la tienen los grupos 0, 1 y las potencias de 3, 5 y 7.						*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TDriverEXT::GrupoTieneSuperbloque(__u32 NroGrupo) const
+{
+__u32	Base, Potencia;
+
+if ( (NroGrupo<=1) || !(SuperBloque.s_feature_ro_compat&EXT2_FEATURE_RO_COMPAT_SPARSE_SUPER) )
+	return(true);
+for (Base=3;Base<=7;Base+=2)
+    {
+	for (Potencia=Base;Potencia<NroGrupo;Potencia*=Base);
+	if (Potencia==NroGrupo)
+		return(true);
+    }
+return(false);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverEXT :: LeerINode								*
+ *																	*
+ * OBJETIVO: Esta función devuelve un inode, buscándolo primero en el cache de inodes decodificados.					*
+ *																	*
+ * ENTRADA: NroINode: Número de inode (el primero es el 1).										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   INode: Copia del inode. Los campos extra que el inode no tiene (según i_extra_isize) quedan en cero.				*
+ *																	*
+ * OBSERVACIONES: El cache guarda los últimos MAXIMO_INODES_CACHE inodes usados, así recorrer rutas o listar varias veces los mismos	*
+ *		  directorios no vuelve a decodificar sus inodes. Está partido en fragmentos, así varios hilos lo usan a la vez.	*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::LeerINode(__u32 NroINode, TINodeEXT &INode) const
+{
+int		CodError;
+
+/* Si está en el cache, devolver la copia */
+if (CacheINodes.Buscar(NroINode, INode))
+	return(CODERROR_NINGUNO);
+
+/* Si no, decodificarlo de la tabla de inodes y guardarlo */
+if ( (CodError=DecodificarINode(NroINode, INode)) != CODERROR_NINGUNO )
+	return(CodError);
+CacheINodes.Guardar(NroINode, INode);
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverEXT :: OffsetINode								*
+ *																	*
+ * OBJETIVO: Esta función calcula la posición de un inode en la imágen.									*
+ *																	*
+ * ENTRADA: NroINode: Número de inode, ya validado (el primero es el 1).								*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Offset: Posición en bytes del inode.												*
+ *																	*
+ * OBSERVACIONES: El grupo sale de INodesPorGrupo y la tabla de inodes de su descriptor, así que no se recorre nada.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::OffsetINode(__u32 NroINode, __u64 &Offset) const
+{
+const TDatosFSEXT	&DatosEXT = DatosFS.DatosEspecificos.EXT;
+const TDatosGrupoFSEXT	*pGrupo;
+__u32			Indice;
+int			CodError;
+
+/* Ubicar el grupo y la posición dentro de su tabla de inodes */
+if ( (CodError=CargarDatosGrupo((NroINode-1)/(__u32)DatosEXT.INodesPorGrupo, pGrupo)) != CODERROR_NINGUNO )
+	return(CodError);
+Indice=(NroINode-1)%(__u32)DatosEXT.INodesPorGrupo;
+Offset=pGrupo->ClusterTablaINodes*DatosFS.BytesPorCluster+(__u64)Indice*DatosEXT.BytesPorINode;
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverEXT :: DecodificarINode							*
+ *																	*
+ * OBJETIVO: Esta función lee un inode de la tabla de inodes de su grupo.								*
+ *																	*
+ * ENTRADA: NroINode: Número de inode (el primero es el 1).										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   INode: Copia del inode. Los campos extra que el inode no tiene (según i_extra_isize) quedan en cero.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::DecodificarINode(__u32 NroINode, TINodeEXT &INode) const
+{
+const TDatosFSEXT	&DatosEXT = DatosFS.DatosEspecificos.EXT;
+const unsigned char	*pINode;
+__u64			Offset;
+int			CodError;
+
+/* Levantar el inode de la tabla de su grupo */
+if ( (NroINode<1) || (NroINode>(__u32)SuperBloque.s_inodes_count) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+if ( (CodError=OffsetINode(NroINode, Offset)) != CODERROR_NINGUNO )
+	return(CodError);
+if ( (pINode=PunteroABytes(Offset, DatosEXT.BytesPorINode)) == NULL )
+	return(CODERROR_LECTURA_DISCO);
+
+/* Copiar sólo lo que el inode realmente tiene */
+CopiarINode(pINode, INode);
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverEXT :: CopiarINode								*
+ *																	*
+ * OBJETIVO: Esta función copia un inode tal como está en la tabla de inodes.								*
+ *																	*
+ * ENTRADA: pINode: El inode en la imágen (BytesPorINode bytes).									*
+ *																	*
+ * SALIDA: INode: Copia del inode. Los campos extra que el inode no tiene (según i_extra_isize) quedan en cero.				*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverEXT::CopiarINode(const unsigned char *pINode, TINodeEXT &INode) const
+{
+unsigned	BytesValidos;
+
+memset(&INode, 0, sizeof(INode));
+BytesValidos=min((unsigned)DatosFS.DatosEspecificos.EXT.BytesPorINode, (unsigned)sizeof(INode));
+memcpy(&INode, pINode, BytesValidos);
+if (BytesValidos>EXT_BYTES_INODE_BASICO)
+    {
+	if (EXT_BYTES_INODE_BASICO+(unsigned)(__u16)INode.i_extra_isize<BytesValidos)
+		BytesValidos=EXT_BYTES_INODE_BASICO+(__u16)INode.i_extra_isize;
+	memset((unsigned char *)&INode+BytesValidos, 0, sizeof(INode)-BytesValidos);
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverEXT :: ArmarRuns								*
+ *																	*
+ * OBJETIVO: Esta función arma la lista de corridas de bloques contiguos de un inode, a partir de su árbol de extents o de sus		*
+ *	     punteros directos e indirectos.												*
+ *																	*
+ * ENTRADA: INode: El inode.														*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Runs: Las corridas, ordenadas por bloque lógico. Dos bloques lógicos consecutivos que también lo son en el disco quedan	*
+ *		 siempre en la misma corrida.												*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::ArmarRuns(const TINodeEXT &INode, std::vector<TRunEXT> &Runs) const
+{
+int		CodError, Nivel;
+__u64		BloqueLogico, BloquesArchivo;
+
+/* Inicializar salidas */
+Runs.clear();
+
+/* Con extents se recorre el árbol, cuya raíz está en i_block */
+if (INode.i_flags&EXT4_EXTENTS_FL)
+	return(ArmarRunsExtents((const unsigned char *)INode.i_block, sizeof(INode.i_block), -1, Runs));
+
+/* Si no, los primeros bloques están directo en i_block y el resto a través de bloques de punteros de 1, 2 y 3 niveles */
+BloquesArchivo=(BytesINode(INode)+DatosFS.BytesPorCluster-1)/DatosFS.BytesPorCluster;
+for (BloqueLogico=0;(BloqueLogico<EXT_BLOQUES_DIRECTOS) && (BloqueLogico<BloquesArchivo);BloqueLogico++)
+	AgregarRun(Runs, BloqueLogico, (__u32)INode.i_block[BloqueLogico], 1);
+for (Nivel=1;(Nivel<=3) && (BloqueLogico<BloquesArchivo);Nivel++)
+	if ( (CodError=ArmarRunsIndirectos((__u32)INode.i_block[EXT_BLOQUE_INDIRECTO+Nivel-1], Nivel, BloqueLogico, BloquesArchivo, Runs)) != CODERROR_NINGUNO )
+		return(CodError);
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverEXT :: ArmarRunsExtents							*
+ *																	*
+ * OBJETIVO: Esta función agrega las corridas de un nodo del árbol de extents, bajando por los nodos índice.				*
+ *																	*
+ * ENTRADA: pNodo: El nodo (encabezado seguido de las entradas).									*
+ *	    BytesNodo: Lugar que ocupa el nodo (i_block o un bloque entero).								*
+ *	    Profundidad: Profundidad que tiene que tener el nodo, o -1 para la raíz.							*
+ *	    Runs: Las corridas que se vienen armando.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Los índices de un nodo se copian antes de bajar, porque con una fuente con cache el puntero al nodo podría dejar	*
+ *		  de ser válido mientras se leen los hijos.										*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::ArmarRunsExtents(const unsigned char *pNodo, unsigned BytesNodo, int Profundidad, std::vector<TRunEXT> &Runs) const
+{
+const TExtentHeaderEXT4		*pEncabezado = (const TExtentHeaderEXT4 *)pNodo;
+const TExtentNodeEXT4		*pExtent;
+std::vector<TExtentIndexEXT4>	Indices;
+const unsigned char		*pHijo;
+int				CodError, i;
+__u64				NroBloque;
+unsigned			Bloques;
+
+/* Validar el encabezado */
+if ( (pEncabezado->eh_magic!=EXT_MAGIC_EXTENTS) || (pEncabezado->eh_depth<0) || (pEncabezado->eh_depth>EXT_PROFUNDIDAD_MAXIMA_EXTENTS) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+if ( (Profundidad>=0) && (pEncabezado->eh_depth!=Profundidad) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+if ( (pEncabezado->eh_entries<0) || (sizeof(TExtentHeaderEXT4)+(unsigned)pEncabezado->eh_entries*sizeof(TExtentNodeEXT4)>BytesNodo) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* En una hoja cada entrada es un extent */
+if (!pEncabezado->eh_depth)
+    {
+	pExtent=(const TExtentNodeEXT4 *)(pEncabezado+1);
+	for (i=0;i<pEncabezado->eh_entries;i++, pExtent++)
+	    {
+		Bloques=(__u16)pExtent->ee_len;
+		NroBloque=(__u32)pExtent->ee_start_lo | (__u64)(__u16)pExtent->ee_start_hi<<32;
+		if (Bloques>EXT_MAXIMO_LARGO_EXTENT)
+		    {
+			/* Sin inicializar, se lee como un hueco */
+			Bloques-=EXT_MAXIMO_LARGO_EXTENT;
+			NroBloque=0;
+		    }
+		AgregarRun(Runs, (__u32)pExtent->ee_block, NroBloque, Bloques);
+	    }
+	return(CODERROR_NINGUNO);
+    }
+
+/* En un nodo índice cada entrada apunta a un bloque con el nodo del nivel siguiente */
+Indices.assign((const TExtentIndexEXT4 *)(pEncabezado+1), (const TExtentIndexEXT4 *)(pEncabezado+1)+pEncabezado->eh_entries);
+Profundidad=pEncabezado->eh_depth-1;
+for (i=0;i<(int)Indices.size();i++)
+    {
+	NroBloque=(__u32)Indices[i].ei_leaf_lo | (__u64)(__u16)Indices[i].ei_leaf_hi<<32;
+	if ( (NroBloque<=(__u32)SuperBloque.s_first_data_block) || (NroBloque>=NumeroDeBloques) )
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	if ( (pHijo=PunteroABytes(NroBloque*DatosFS.BytesPorCluster, DatosFS.BytesPorCluster)) == NULL )
+		return(CODERROR_LECTURA_DISCO);
+	if ( (CodError=ArmarRunsExtents(pHijo, DatosFS.BytesPorCluster, Profundidad, Runs)) != CODERROR_NINGUNO )
+		return(CodError);
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverEXT :: ArmarRunsIndirectos							*
+ *																	*
+ * OBJETIVO: Esta función agrega las corridas apuntadas por un bloque de punteros (indirecto simple, doble o triple).			*
+ *																	*
+ * ENTRADA: NroBloque: Bloque de punteros (0 = todo lo que cubre es un hueco).								*
+ *	    Nivel: 1 si los punteros apuntan a datos, 2 o 3 si apuntan a otros bloques de punteros.					*
+ *	    BloqueLogico: Primer bloque lógico que cubre el bloque de punteros.								*
+ *	    BloquesArchivo: Cantidad de bloques del archivo, no se arman corridas más allá.						*
+ *	    Runs: Las corridas que se vienen armando.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   BloqueLogico: El primer bloque lógico que sigue a los cubiertos.								*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::ArmarRunsIndirectos(__u64 NroBloque, int Nivel, __u64 &BloqueLogico, __u64 BloquesArchivo, std::vector<TRunEXT> &Runs) const
+{
+const __u32		*pPunteros;
+std::vector<__u32>	Punteros;
+__u64			PunterosPorBloque, BloquesCubiertos;
+int			CodError, i;
+
+/* Calcular cuántos bloques cubre */
+PunterosPorBloque=DatosFS.BytesPorCluster/sizeof(__u32);
+for (BloquesCubiertos=1, i=0;i<Nivel;i++)
+	BloquesCubiertos*=PunterosPorBloque;
+if (BloquesCubiertos>BloquesArchivo-BloqueLogico)
+	BloquesCubiertos=BloquesArchivo-BloqueLogico;
+
+/* Un puntero nulo es un hueco */
+if (!NroBloque)
+    {
+	AgregarRun(Runs, BloqueLogico, 0, BloquesCubiertos);
+	BloqueLogico+=BloquesCubiertos;
+	return(CODERROR_NINGUNO);
+    }
+if ( (NroBloque<=(__u32)SuperBloque.s_first_data_block) || (NroBloque>=NumeroDeBloques) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+if ( (pPunteros=(const __u32 *)PunteroABytes(NroBloque*DatosFS.BytesPorCluster, DatosFS.BytesPorCluster)) == NULL )
+	return(CODERROR_LECTURA_DISCO);
+
+/* En el último nivel los punteros son bloques de datos */
+if (Nivel==1)
+    {
+	for (i=0;(i<(int)PunterosPorBloque) && (BloqueLogico<BloquesArchivo);i++)
+		AgregarRun(Runs, BloqueLogico++, pPunteros[i], 1);
+	return(CODERROR_NINGUNO);
+    }
+
+/* Si no, bajar un nivel (copiando los punteros, que pueden dejar de ser válidos mientras se leen los de abajo) */
+Punteros.assign(pPunteros, pPunteros+PunterosPorBloque);
+for (i=0;(i<(int)PunterosPorBloque) && (BloqueLogico<BloquesArchivo);i++)
+	if ( (CodError=ArmarRunsIndirectos(Punteros[i], Nivel-1, BloqueLogico, BloquesArchivo, Runs)) != CODERROR_NINGUNO )
+		return(CodError);
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverEXT :: AgregarRun								*
+ *																	*
+ * OBJETIVO: Esta función agrega bloques a la lista de corridas, extendiendo la última si los nuevos la continúan.			*
+ *																	*
+ * ENTRADA: Runs: Las corridas que se vienen armando.											*
+ *	    BloqueLogico: Primer bloque lógico a agregar.										*
+ *	    BloqueFisico: Bloque en el disco donde está (0 = hueco).									*
+ *	    Bloques: Cantidad de bloques.												*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverEXT::AgregarRun(std::vector<TRunEXT> &Runs, __u64 BloqueLogico, __u64 BloqueFisico, __u64 Bloques) const
+{
+TRunEXT		Run;
+
+if (!Bloques)
+	return;
+
+/* Ver si continúa la última corrida, tanto en el archivo como en el disco (o si los dos son huecos) */
+if (!Runs.empty())
+    {
+	TRunEXT	&Ultimo = Runs.back();
+	if ( (Ultimo.BloqueLogico+Ultimo.Bloques==BloqueLogico) &&
+	     ( (!Ultimo.BloqueFisico && !BloqueFisico) || (Ultimo.BloqueFisico && (Ultimo.BloqueFisico+Ultimo.Bloques==BloqueFisico)) ) )
+	    {
+		Ultimo.Bloques+=Bloques;
+		return;
+	    }
+    }
+
+/* Si no, empezar una nueva */
+Run.BloqueLogico=BloqueLogico;
+Run.BloqueFisico=BloqueFisico;
+Run.Bloques=Bloques;
+Runs.push_back(Run);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverEXT :: EmitirRuns								*
+ *																	*
+ * OBJETIVO: Esta función entrega los datos de un archivo al receptor, un tramo por cada corrida.					*
+ *																	*
+ * ENTRADA: Runs: Las corridas del archivo.												*
+ *	    BytesArchivo: Tamaño del archivo.												*
+ *	    Receptor, pParametroUsuario: Ver LeerArchivoPorTramos().									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Los huecos, tanto corridas sin bloque como bloques que no figuran en ninguna corrida, se entregan como ceros.		*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::EmitirRuns(const std::vector<TRunEXT> &Runs, __u64 BytesArchivo, TpReceptorTramo Receptor, void *pParametroUsuario) const
+{
+int		CodError;
+__u64		Offset, Inicio, Bytes;
+size_t		i;
+
+/* Recorrer las corridas en orden */
+Offset=0;
+for (i=0;(i<Runs.size()) && (Offset<BytesArchivo);i++)
+    {
+	Inicio=Runs[i].BloqueLogico*DatosFS.BytesPorCluster;
+	if (Inicio<Offset)
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	if (Inicio>=BytesArchivo)
+		break;
+
+	/* Lo que no cubre ninguna corrida es un hueco */
+	if ( (Inicio>Offset) && ((CodError=EmitirCeros(Inicio-Offset, Offset, BytesArchivo, Receptor, pParametroUsuario)) != CODERROR_NINGUNO) )
+		return(CodError);
+	Offset=Inicio;
+
+	/* Entregar la corrida, cortándola al final del archivo */
+	Bytes=min(Runs[i].Bloques*DatosFS.BytesPorCluster, BytesArchivo-Offset);
+	if (!Runs[i].BloqueFisico)
+		CodError=EmitirCeros(Bytes, Offset, BytesArchivo, Receptor, pParametroUsuario);
+	else if (Runs[i].BloqueFisico+Runs[i].Bloques>NumeroDeBloques)
+		CodError=CODERROR_FILESYSTEM_CORRUPTO;
+	else
+		CodError=EmitirTramo(Runs[i].BloqueFisico*DatosFS.BytesPorCluster, Bytes, Offset, BytesArchivo, Receptor, pParametroUsuario);
+	if (CodError!=CODERROR_NINGUNO)
+		return(CodError);
+	Offset+=Bytes;
+    }
+
+/* Lo que queda después de la última corrida también es un hueco */
+if (Offset<BytesArchivo)
+	return(EmitirCeros(BytesArchivo-Offset, Offset, BytesArchivo, Receptor, pParametroUsuario));
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverEXT :: CompletarEntrada							*
+ *																	*
+ * OBJETIVO: Esta función completa los datos de una entrada de directorio a partir de su inode.						*
+ *																	*
+ * ENTRADA: NroINode: Número de inode.													*
+ *	    INode: El inode.														*
+ *																	*
+ * SALIDA: Entrada: La entrada con todo menos el nombre.										*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverEXT::CompletarEntrada(__u32 NroINode, const TINodeEXT &INode, TEntradaDirectorio &Entrada) const
+{
+bool	HayExtra;
+
+/* Tipo de entrada */
+Entrada.Flags=0;
+if (S_ISDIR(INode.i_mode))
+	Entrada.Flags|=fedDIRECTORIO;
+if (S_ISLNK(INode.i_mode))
+	Entrada.Flags|=fedACCESO_DIRECTO;
+
+/* Tamaño y fechas (la de creación sólo existe en los inodes con campos extra) */
+HayExtra=INode.i_extra_isize!=0;
+Entrada.Bytes=BytesINode(INode);
+Entrada.FechaCreacion=INode.i_crtime ? FechaINode(INode.i_crtime, INode.i_crtime_extra, HayExtra) : FechaINode(INode.i_ctime, INode.i_ctime_extra, HayExtra);
+Entrada.FechaUltimoAcceso=FechaINode(INode.i_atime, INode.i_atime_extra, HayExtra);
+Entrada.FechaUltimaModificacion=FechaINode(INode.i_mtime, INode.i_mtime_extra, HayExtra);
+
+/* Datos propios de EXT */
+memset(&Entrada.DatosEspecificos, 0, sizeof(Entrada.DatosEspecificos));
+Entrada.DatosEspecificos.EXT.INode=NroINode;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverEXT :: BytesINode								*
+ *																	*
+ * OBJETIVO: Esta función devuelve el tamaño en bytes de un inode.									*
+ *																	*
+ * ENTRADA: INode: El inode.														*
+ *																	*
+ * SALIDA: En el nombre de la función el tamaño.											*
+ *																	*
+ ****************************************************************************************************************************************/
+__u64 TDriverEXT::BytesINode(const TINodeEXT &INode)
+{
+return((__u32)INode.i_size_lo | (__u64)(__u32)INode.i_size_high<<32);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverEXT :: FechaINode								*
+ *																	*
+ * OBJETIVO: Esta función convierte una fecha de un inode a time_t.									*
+ *																	*
+ * ENTRADA: Segundos: Segundos desde 1970 (con signo).											*
+ *	    Extra: Campo _extra de la fecha, cuyos 2 bits bajos extienden la época más allá de 2038.					*
+ *	    HayExtra: Si el inode tiene los campos extra.										*
+ *																	*
+ * SALIDA: En el nombre de la función la fecha.												*
+ *																	*
+ ****************************************************************************************************************************************/
+time_t TDriverEXT::FechaINode(__le32 Segundos, __le32 Extra, bool HayExtra)
+{
+return((time_t)Segundos+(HayExtra ? (time_t)(Extra&3)<<32 : 0));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverEXT :: ListarDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función enumera las entradas en un directorio y retorna un arreglo de elementos, uno por cada entrada.		*
+ *																	*
+ * ENTRADA: Path: Path al directorio enumerar (cadena de nombres de directorio separados por '/').					*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Entradas: Arreglo con cada una de las entradas.										*
+ *																	*
+ ****************************************************************************************************************************************/
+
+int TDriverEXT::ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas) const
+{
+/* La ruta la resuelve la clase base, pidiendo cada directorio con ListarDirectorioEntrada() */
+return(ListarDirectorioPorRuta(Path, Entradas));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TDriverEXT :: ListarDirectorioEntrada							*
+ *																	*
+ * OBJETIVO: Esta función enumera las entradas de un directorio dado por su entrada.							*
+ *																	*
+ * ENTRADA: Directorio: Entrada del directorio a enumerar.										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Entradas: Arreglo con cada una de las entradas, en el orden en que están en el disco.					*
+ *																	*
+ * OBSERVACIONES: Primero se recorren los bloques del directorio juntando nombres y números de inode, y recién después se leen los	*
+ *		  inodes, así no se mezclan las lecturas de los bloques del directorio con las de la tabla de inodes.			*
+ *		  Los bloques internos del índice htree (dir_index) se ven como una entrada con inode 0 que ocupa todo el bloque, y	*
+ *		  se saltean igual que las entradas borradas.										*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::ListarDirectorioEntrada(const TEntradaDirectorio &Directorio, std::vector<TEntradaDirectorio> &Entradas) const
+{
+int			CodError;
+TINodeEXT		INode;
+std::vector<TRunEXT>	Runs;
+const unsigned char	*pBloque;
+__u64			BloquesDirectorio, i, j;
+size_t			k;
+
+/* Inicializar salidas */
+Entradas.clear();
+
+/* Levantar el inode del directorio */
+if ( (CodError=LeerINode(Directorio.DatosEspecificos.EXT.INode, INode)) != CODERROR_NINGUNO )
+	return(CodError);
+if (!S_ISDIR(INode.i_mode))
+	return(CODERROR_DIRECTORIO_INEXISTENTE);
+
+/* Un directorio chico puede tener las entradas dentro del propio inode */
+if (INode.i_flags&EXT4_INLINE_DATA_FL)
+	CodError=ListarDirectorioInline(Directorio.DatosEspecificos.EXT.INode, Entradas);
+else
+    {
+	/* Si no, recorrer cada bloque del directorio */
+	if ( (CodError=ArmarRuns(INode, Runs)) != CODERROR_NINGUNO )
+		return(CodError);
+	BloquesDirectorio=BytesINode(INode)/DatosFS.BytesPorCluster;
+	for (i=0;(i<Runs.size()) && (CodError==CODERROR_NINGUNO);i++)
+		for (j=0;(j<Runs[i].Bloques) && (Runs[i].BloqueLogico+j<BloquesDirectorio) && (CodError==CODERROR_NINGUNO);j++)
+		    {
+			/* Un directorio no tiene huecos */
+			if ( (!Runs[i].BloqueFisico) || (Runs[i].BloqueFisico+j>=NumeroDeBloques) )
+				return(CODERROR_FILESYSTEM_CORRUPTO);
+			if ( (pBloque=PunteroABytes((Runs[i].BloqueFisico+j)*DatosFS.BytesPorCluster, DatosFS.BytesPorCluster)) == NULL )
+				return(CODERROR_LECTURA_DISCO);
+			CodError=JuntarEntradasDirectorio(pBloque, DatosFS.BytesPorCluster, Entradas);
+		    }
+    }
+if (CodError!=CODERROR_NINGUNO)
+	return(CodError);
+
+/* Completar cada entrada con los datos de su inode */
+for (k=0;k<Entradas.size();k++)
+    {
+	if ( (CodError=LeerINode(Entradas[k].DatosEspecificos.EXT.INode, INode)) != CODERROR_NINGUNO )
+		return(CodError);
+	CompletarEntrada(Entradas[k].DatosEspecificos.EXT.INode, INode, Entradas[k]);
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						TDriverEXT :: JuntarEntradasDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función agrega los nombres y números de inode de las entradas de un bloque de directorio (o de la parte de un		*
+ *	     inode con entradas inline).												*
+ *																	*
+ * ENTRADA: pRegion: Comienzo de las entradas.												*
+ *	    Bytes: Lugar que ocupan las entradas.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Entradas: Las entradas con nombre e inode agregadas al final (el resto de los datos se completa después).			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::JuntarEntradasDirectorio(const unsigned char *pRegion, unsigned Bytes, std::vector<TEntradaDirectorio> &Entradas) const
+{
+const TDirEntryEXT	*pEntrada;
+TEntradaDirectorio	Entrada;
+unsigned		Offset;
+
+/* Cada entrada dice cuánto ocupa, y ninguna cruza el final de la región */
+memset(&Entrada.DatosEspecificos, 0, sizeof(Entrada.DatosEspecificos));
+for (Offset=0;Offset<Bytes;Offset+=(__u16)pEntrada->rec_len)
+    {
+	if (!EntradaDirectorioValida(pRegion, Offset, Bytes))
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	pEntrada=(const TDirEntryEXT *)(pRegion+Offset);
+	if (!pEntrada->inode)
+		continue;
+	Entrada.Nombre.assign(pEntrada->name, pEntrada->name_len);
+	Entrada.DatosEspecificos.EXT.INode=pEntrada->inode;
+	Entradas.push_back(Entrada);
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverEXT :: ListarDirectorioInline							*
+ *																	*
+ * OBJETIVO: Esta función junta las entradas de un directorio guardado dentro de su inode (inline_data), sin leer ningún bloque.	*
+ *																	*
+ * ENTRADA: NroINode: Inode del directorio.												*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Entradas: Las entradas con nombre e inode (el resto de los datos se completa después).					*
+ *																	*
+ * OBSERVACIONES: i_block empieza con el inode del padre en lugar de las entradas "." y "..", que se arman acá para que el listado	*
+ *		  quede igual al de un directorio común.										*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::ListarDirectorioInline(__u32 NroINode, std::vector<TEntradaDirectorio> &Entradas) const
+{
+const unsigned char	*pINode, *pIBlock;
+TEntradaDirectorio	Entrada;
+unsigned		OffsetExtra, BytesExtra;
+__u64			OffsetImagen;
+int			CodError;
+
+/* Ubicar las dos partes de los datos */
+if ( (CodError=UbicarDatosInline(NroINode, OffsetImagen, pINode, OffsetExtra, BytesExtra)) != CODERROR_NINGUNO )
+	return(CodError);
+pIBlock=(const unsigned char *)((const TINodeEXT *)pINode)->i_block;
+
+/* "." y ".." */
+memset(&Entrada.DatosEspecificos, 0, sizeof(Entrada.DatosEspecificos));
+Entrada.Nombre=".";
+Entrada.DatosEspecificos.EXT.INode=NroINode;
+Entradas.push_back(Entrada);
+Entrada.Nombre="..";
+Entrada.DatosEspecificos.EXT.INode=*(const __u32 *)pIBlock;
+Entradas.push_back(Entrada);
+
+/* Las entradas siguen en i_block y continúan en el atributo extendido */
+if ( (CodError=JuntarEntradasDirectorio(pIBlock+sizeof(__u32), EXT_BYTES_INLINE_IBLOCK-sizeof(__u32), Entradas)) != CODERROR_NINGUNO )
+	return(CodError);
+if (BytesExtra)
+	return(JuntarEntradasDirectorio(pINode+OffsetExtra, BytesExtra, Entradas));
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverEXT :: UbicarDatosInline							*
+ *																	*
+ * OBJETIVO: Esta función ubica dentro de un inode la continuación de sus datos inline, en el atributo extendido "system.data".		*
+ *																	*
+ * ENTRADA: NroINode: Número de inode.													*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   OffsetImagen: Posición del inode en la imágen.										*
+ *	   pINode: El inode tal como está en la imágen (sólo válido hasta la próxima lectura).						*
+ *	   OffsetExtra, BytesExtra: Posición dentro del inode y largo de la continuación (0 si todo entra en i_block).			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::UbicarDatosInline(__u32 NroINode, __u64 &OffsetImagen, const unsigned char *&pINode, unsigned &OffsetExtra, unsigned &BytesExtra) const
+{
+unsigned		BytesINode, Inicio, Offset;
+const TEntradaXAttrEXT	*pAtributo;
+int			CodError;
+
+/* Levantar el inode entero, con su zona de atributos extendidos */
+BytesINode=DatosFS.DatosEspecificos.EXT.BytesPorINode;
+if ( (CodError=OffsetINode(NroINode, OffsetImagen)) != CODERROR_NINGUNO )
+	return(CodError);
+if ( (pINode=PunteroABytes(OffsetImagen, BytesINode)) == NULL )
+	return(CODERROR_LECTURA_DISCO);
+
+/* Sin zona de atributos, todo está en i_block */
+OffsetExtra=0;
+BytesExtra=0;
+Inicio=EXT_BYTES_INODE_BASICO+(__u16)((const TINodeEXT *)pINode)->i_extra_isize;
+if ( (BytesINode<=EXT_BYTES_INODE_BASICO) || (Inicio+sizeof(__u32)>BytesINode) || (*(const __u32 *)(pINode+Inicio)!=EXT_MAGIC_XATTR) )
+	return(CODERROR_NINGUNO);
+
+/* Buscar "system.data" entre los atributos (la lista termina con 4 bytes en cero) */
+Inicio+=sizeof(__u32);
+for (Offset=Inicio;(Offset+sizeof(__u32)<=BytesINode) && (*(const __u32 *)(pINode+Offset));Offset+=(sizeof(TEntradaXAttrEXT)+pAtributo->e_name_len+3)&~3u)
+    {
+	pAtributo=(const TEntradaXAttrEXT *)(pINode+Offset);
+	if (Offset+sizeof(TEntradaXAttrEXT)+pAtributo->e_name_len>BytesINode)
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	if ( (pAtributo->e_name_index!=EXT_XATTR_INDEX_SYSTEM) || (pAtributo->e_name_len!=strlen(EXT_XATTR_NOMBRE_INLINE)) ||
+	     (memcmp(pAtributo->e_name, EXT_XATTR_NOMBRE_INLINE, pAtributo->e_name_len)) )
+		continue;
+
+	/* El valor está en el mismo inode, contando desde el primer atributo */
+	OffsetExtra=Inicio+(__u16)pAtributo->e_value_offs;
+	BytesExtra=(__u32)pAtributo->e_value_size;
+	if ( (pAtributo->e_value_inum) || (BytesExtra>BytesINode) || (OffsetExtra+BytesExtra>BytesINode) )
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	break;
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverEXT :: EmitirDatosInline							*
+ *																	*
+ * OBJETIVO: Esta función entrega al receptor los datos de un archivo guardado dentro de su inode (inline_data).			*
+ *																	*
+ * ENTRADA: NroINode: Número de inode.													*
+ *	    BytesArchivo: Tamaño del archivo.												*
+ *	    Receptor, pParametroUsuario: Ver LeerArchivoPorTramos().									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Los tramos apuntan directamente al inode en la imágen: no se lee ningún bloque ni se copia nada.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::EmitirDatosInline(__u32 NroINode, __u64 BytesArchivo, TpReceptorTramo Receptor, void *pParametroUsuario) const
+{
+const unsigned char	*pINode;
+unsigned		OffsetExtra, BytesExtra, BytesIBlock;
+__u64			OffsetImagen;
+int			CodError;
+
+/* Ubicar las dos partes de los datos */
+if ( (CodError=UbicarDatosInline(NroINode, OffsetImagen, pINode, OffsetExtra, BytesExtra)) != CODERROR_NINGUNO )
+	return(CodError);
+BytesIBlock=min(BytesArchivo, (__u64)EXT_BYTES_INLINE_IBLOCK);
+if (BytesArchivo>BytesIBlock+BytesExtra)
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Primero lo que está en i_block y después la continuación */
+if ( (BytesIBlock) &&
+     ((CodError=EmitirTramo(OffsetImagen+((const unsigned char *)((const TINodeEXT *)pINode)->i_block-pINode), BytesIBlock, 0, BytesArchivo, Receptor, pParametroUsuario)) != CODERROR_NINGUNO) )
+	return(CodError);
+if (BytesArchivo>BytesIBlock)
+	return(EmitirTramo(OffsetImagen+OffsetExtra, BytesArchivo-BytesIBlock, BytesIBlock, BytesArchivo, Receptor, pParametroUsuario));
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverEXT :: EntradaRootDir							*
+ *																	*
+ * OBJETIVO: Esta función arma la entrada que representa al directorio raíz.								*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Entrada: La entrada del directorio raíz, que siempre es el inode EXT_ROOT_INO.						*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverEXT::EntradaRootDir(TEntradaDirectorio &Entrada) const
+{
+TDriverBase::EntradaRootDir(Entrada);
+Entrada.DatosEspecificos.EXT.INode=EXT_ROOT_INO;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TDriverEXT :: IdentificadorDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función devuelve el número que identifica a un directorio: su número de inode.					*
+ *																	*
+ * ENTRADA: Directorio: Entrada del directorio.												*
+ *																	*
+ * SALIDA: En el nombre de la función el número de inode.										*
+ *																	*
+ ****************************************************************************************************************************************/
+__u64 TDriverEXT::IdentificadorDirectorio(const TEntradaDirectorio &Directorio) const
+{
+return(Directorio.DatosEspecificos.EXT.INode);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverEXT :: MostrarEstadisticas							*
+ *																	*
+ * OBJETIVO: Esta función muestra los contadores de los caches, agregando los del cache de inodes a los de la clase base.		*
+ *																	*
+ * ENTRADA: f: Archivo donde imprimir.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverEXT::MostrarEstadisticas(FILE *f) const
+{
+__u64	Aciertos, Fallos, Total;
+
+/* Mostrar los de la clase base */
+TDriverBase::MostrarEstadisticas(f);
+
+/* Mostrar los del cache de inodes */
+Aciertos=CacheINodes.Aciertos();
+Fallos=CacheINodes.Fallos();
+Total=Aciertos+Fallos;
+fprintf(f, "Estadísticas del cache de inodes:\n");
+fprintf(f, "\tAciertos                : %llu\n", Aciertos);
+fprintf(f, "\tFallos                  : %llu\n", Fallos);
+fprintf(f, "\tTasa de aciertos        : %.2f%%\n", Total ? (100.0*Aciertos)/Total : 0.0);
+fprintf(f, "\tEntradas en cache       : %llu de %d\n", (__u64)CacheINodes.Entradas(), MAXIMO_INODES_CACHE);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverEXT :: NormalizarNombre							*
+ *																	*
+ * OBJETIVO: Esta función lleva un nombre a la forma en que se compara dentro de un directorio.						*
+ *																	*
+ * ENTRADA: Nombre: El nombre a normalizar.												*
+ *																	*
+ * SALIDA: Nombre: El nombre normalizado.												*
+ *																	*
+ * OBSERVACIONES: Igual que el programa de referencia, los nombres se comparan sin distinguir mayúsculas de minúsculas (sólo las	*
+ *		  letras ASCII), así que se pasan a minúsculas.										*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverEXT::NormalizarNombre(TString &Nombre) const
+{
+size_t	i;
+
+for (i=0;i<Nombre.size();i++)
+	if ( (Nombre[i]>='A') && (Nombre[i]<='Z') )
+		Nombre[i]+='a'-'A';
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverEXT :: BuscarEnDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función busca un nombre en un directorio usando su índice htree (dir_index), sin recorrerlo entero.			*
+ *																	*
+ * ENTRADA: Directorio: Entrada del directorio donde buscar.										*
+ *	    Nombre: Nombre a buscar.													*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si lo encontró, CODERROR_ARCHIVO_INEXISTENTE si no puede estar,			*
+ *	   CODERROR_NO_IMPLEMENTADO si el directorio no tiene índice (o usa un hash que no se conoce) o el nombre no está en el bloque	*
+ *	   que indica el índice, o el código de error.											*
+ *	   Entrada: La entrada encontrada.												*
+ *																	*
+ * OBSERVACIONES: Con el hash del nombre se baja desde la raíz (en el bloque 0) hasta un único bloque de entradas, así que encontrar	*
+ *		  un nombre lee unos pocos bloques sin importar el tamaño del directorio. Los listados siguen recorriendo todos los	*
+ *		  bloques en orden (ver ListarDirectorioEntrada()).									*
+ *		  El hash se calcula sobre el nombre normalizado (en minúsculas), así que un nombre guardado con otras mayúsculas cae	*
+ *		  en otro bloque: si no aparece, TDriverBase::BuscarEntrada() lo busca recorriendo el directorio entero.		*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::BuscarEnDirectorio(const TEntradaDirectorio &Directorio, const TString &Nombre, TEntradaDirectorio &Entrada) const
+{
+int			CodError, VersionHash;
+TINodeEXT		INode;
+std::vector<TRunEXT>	Runs;
+const unsigned char	*pBloque;
+const TDxRootInfoEXT	*pInfo;
+__u32			NroINode;
+TString			NombreDisco;
+
+/* Sólo los directorios indexados se pueden buscar por hash (con nombres cifrados o sin distinguir mayúsculas el hash es otro) */
+if (!(SuperBloque.s_feature_compat&EXT3_FEATURE_COMPAT_DIR_INDEX))
+	return(CODERROR_NO_IMPLEMENTADO);
+if ( (CodError=LeerINode(Directorio.DatosEspecificos.EXT.INode, INode)) != CODERROR_NINGUNO )
+	return(CodError);
+if ( (!S_ISDIR(INode.i_mode)) || !(INode.i_flags&EXT3_INDEX_FL) || (INode.i_flags&(EXT4_CASEFOLD_FL|EXT4_ENCRYPT_FL)) )
+	return(CODERROR_NO_IMPLEMENTADO);
+if ( (Nombre.empty()) || (Nombre.size()>EXT_LARGO_MAXIMO_NOMBRE) )
+	return(CODERROR_ARCHIVO_INEXISTENTE);
+if ( (CodError=ArmarRuns(INode, Runs)) != CODERROR_NINGUNO )
+	return(CodError);
+
+/* "." y ".." son las dos primeras entradas del bloque 0, que se puede recorrer como un bloque común */
+if ( (Nombre==".") || (Nombre=="..") )
+	CodError=BuscarEnBloqueDirectorio(Runs, 0, Nombre, NroINode, NombreDisco);
+else
+    {
+	/* Levantar la raíz del índice */
+	if ( (CodError=LeerBloqueLogico(Runs, 0, pBloque)) != CODERROR_NINGUNO )
+		return(CodError);
+	pInfo=(const TDxRootInfoEXT *)(pBloque+EXT_OFFSET_DX_ROOT_INFO);
+	VersionHash=pInfo->hash_version;
+	if ( (VersionHash<=EXT_DX_HASH_TEA) && (SuperBloque.s_flags&EXT_FLAGS_UNSIGNED_HASH) )
+		VersionHash+=EXT_DX_HASH_LEGACY_UNSIGNED;
+	if ( (VersionHash>EXT_DX_HASH_TEA_UNSIGNED) || (pInfo->indirect_levels>=EXT_MAXIMO_NIVELES_DX) || (pInfo->info_length<sizeof(TDxRootInfoEXT)) )
+		return(CODERROR_NO_IMPLEMENTADO);
+
+	/* Bajar por el índice */
+	CodError=BuscarEnNodoDx(Runs, pBloque, EXT_OFFSET_DX_ROOT_INFO+pInfo->info_length, pInfo->indirect_levels, HashNombreDx(Nombre, VersionHash), Nombre, NroINode, NombreDisco);
+	if (CodError==CODERROR_ARCHIVO_INEXISTENTE)
+		return(CODERROR_NO_IMPLEMENTADO);
+    }
+if (CodError!=CODERROR_NINGUNO)
+	return(CodError);
+
+/* Completar la entrada con su inode */
+if ( (CodError=LeerINode(NroINode, INode)) != CODERROR_NINGUNO )
+	return(CodError);
+CompletarEntrada(NroINode, INode, Entrada);
+Entrada.Nombre=NombreDisco;
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverEXT :: BuscarEnNodoDx							*
+ *																	*
+ * OBJETIVO: Esta función busca un nombre bajando por un nodo del índice htree.								*
+ *																	*
+ * ENTRADA: Runs: Corridas del directorio.												*
+ *	    pNodo: Bloque del nodo (la raíz o un nodo interno).										*
+ *	    Offset: Posición de las entradas del nodo dentro del bloque.								*
+ *	    Niveles: Cantidad de niveles de nodos internos que hay debajo (0 = las entradas apuntan a bloques de entradas).		*
+ *	    Hash: Hash del nombre.													*
+ *	    Nombre: Nombre a buscar.													*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si lo encontró, CODERROR_ARCHIVO_INEXISTENTE si no está, o el código de error.	*
+ *	   NroINode: Inode de la entrada encontrada.											*
+ *	   NombreDisco: Su nombre como está guardado en el directorio.									*
+ *																	*
+ * OBSERVACIONES: Cada entrada tiene el menor hash del bloque al que apunta, y el bit 0 prendido si ese hash ya venía del bloque	*
+ *		  anterior (colisiones repartidas en dos bloques), en cuyo caso también hay que buscar en el siguiente.			*
+ *		  Las entradas se copian antes de bajar, porque con una fuente con cache el nodo podría dejar de ser válido.		*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::BuscarEnNodoDx(const std::vector<TRunEXT> &Runs, const unsigned char *pNodo, unsigned Offset, int Niveles,
+			       __u32 Hash, const TString &Nombre, __u32 &NroINode, TString &NombreDisco) const
+{
+const TDxEntryEXT		*pEntradas;
+std::vector<TDxEntryEXT>	Entradas;
+const unsigned char		*pHijo;
+unsigned			Cantidad, Limite, Inicio, Fin, Medio, i;
+int				CodError;
+
+/* La primera entrada tiene limit y count en lugar del hash */
+if (Offset+sizeof(TDxEntryEXT)>(unsigned)DatosFS.BytesPorCluster)
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+pEntradas=(const TDxEntryEXT *)(pNodo+Offset);
+Limite=((const __u16 *)pEntradas)[0];
+Cantidad=((const __u16 *)pEntradas)[1];
+if ( (!Cantidad) || (Cantidad>Limite) || (Offset+Limite*sizeof(TDxEntryEXT)>(unsigned)DatosFS.BytesPorCluster) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+Entradas.assign(pEntradas, pEntradas+Cantidad);
+
+/* Buscar la última entrada cuyo hash no supera al buscado (la primera cubre desde 0) */
+Inicio=1;
+Fin=Cantidad;
+while (Inicio<Fin)
+    {
+	Medio=(Inicio+Fin)/2;
+	if ((__u32)Entradas[Medio].hash>Hash)
+		Fin=Medio;
+	else
+		Inicio=Medio+1;
+    }
+
+/* Bajar por esa entrada, y por las siguientes mientras continúen el mismo hash */
+for (i=Inicio-1;;)
+    {
+	if (Niveles)
+	    {
+		if ( (CodError=LeerBloqueLogico(Runs, (__u32)Entradas[i].block&0x0FFFFFFF, pHijo)) != CODERROR_NINGUNO )
+			return(CodError);
+		CodError=BuscarEnNodoDx(Runs, pHijo, EXT_OFFSET_DX_NODE, Niveles-1, Hash, Nombre, NroINode, NombreDisco);
+	    }
+	else
+		CodError=BuscarEnBloqueDirectorio(Runs, (__u32)Entradas[i].block&0x0FFFFFFF, Nombre, NroINode, NombreDisco);
+	if (CodError!=CODERROR_ARCHIVO_INEXISTENTE)
+		return(CodError);
+	if ( (++i>=Cantidad) || (((__u32)Entradas[i].hash&~1u)!=Hash) )
+		return(CODERROR_ARCHIVO_INEXISTENTE);
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						TDriverEXT :: BuscarEnBloqueDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función busca un nombre recorriendo las entradas de un bloque de un directorio.					*
+ *																	*
+ * ENTRADA: Runs: Corridas del directorio.												*
+ *	    BloqueLogico: Bloque del directorio a recorrer.										*
+ *	    Nombre: Nombre a buscar, ya normalizado.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si lo encontró, CODERROR_ARCHIVO_INEXISTENTE si no está, o el código de error.	*
+ *	   NroINode: Inode de la entrada encontrada.											*
+ *	   NombreDisco: Su nombre como está guardado en el directorio.									*
+ *																	*
+ * OBSERVACIONES: Los nombres se comparan sin distinguir mayúsculas de minúsculas, igual que en NormalizarNombre().			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::BuscarEnBloqueDirectorio(const std::vector<TRunEXT> &Runs, __u64 BloqueLogico, const TString &Nombre, __u32 &NroINode,
+					 TString &NombreDisco) const
+{
+const unsigned char	*pBloque;
+const TDirEntryEXT	*pEntrada;
+unsigned		Offset;
+int			CodError;
+
+/* Recorrer las entradas del bloque */
+if ( (CodError=LeerBloqueLogico(Runs, BloqueLogico, pBloque)) != CODERROR_NINGUNO )
+	return(CodError);
+for (Offset=0;Offset<(unsigned)DatosFS.BytesPorCluster;Offset+=(__u16)pEntrada->rec_len)
+    {
+	if (!EntradaDirectorioValida(pBloque, Offset, DatosFS.BytesPorCluster))
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	pEntrada=(const TDirEntryEXT *)(pBloque+Offset);
+	if ( (pEntrada->inode) && (pEntrada->name_len==Nombre.size()) && (!strncasecmp(pEntrada->name, Nombre.data(), pEntrada->name_len)) )
+	    {
+		NroINode=pEntrada->inode;
+		NombreDisco.assign(pEntrada->name, pEntrada->name_len);
+		return(CODERROR_NINGUNO);
+	    }
+    }
+
 /* Salir */
-return(CODERROR_NO_IMPLEMENTADO);
+return(CODERROR_ARCHIVO_INEXISTENTE);
 }
 
+
 /****************************************************************************************************************************************
  *																	*
- *						  TDriverEXT :: ListarDirectorio							*
+ *						     TDriverEXT :: LeerBloqueLogico							*
  *																	*
- * OBJETIVO: Esta función enumera las entradas en un directorio y retorna un arreglo de elementos, uno por cada entrada.		*
+ * OBJETIVO: Esta función devuelve un puntero a un bloque de un archivo dado su número de bloque dentro del archivo.			*
  *																	*
- * ENTRADA: Path: Path al directorio enumerar (cadena de nombres de directorio separados por '/').					*
+ * ENTRADA: Runs: Corridas del archivo.													*
+ *	    BloqueLogico: Número de bloque dentro del archivo.										*
  *																	*
  * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
- *	   Entradas: Arreglo con cada una de las entradas.										*
+ *	   pBloque: Puntero al bloque en la imágen.											*
+ *																	*
+ * OBSERVACIONES: Las corridas están ordenadas por bloque lógico, así que la que lo contiene se busca por bisección.			*
  *																	*
  ****************************************************************************************************************************************/
-
-int TDriverEXT::ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas)
+int TDriverEXT::LeerBloqueLogico(const std::vector<TRunEXT> &Runs, __u64 BloqueLogico, const unsigned char *&pBloque) const
 {
+size_t		Inicio, Fin, Medio;
+__u64		NroBloque;
+
+/* Buscar la primera corrida que empieza después del bloque: el bloque está en la anterior, si está */
+Inicio=0;
+Fin=Runs.size();
+while (Inicio<Fin)
+    {
+	Medio=(Inicio+Fin)/2;
+	if (Runs[Medio].BloqueLogico>BloqueLogico)
+		Fin=Medio;
+	else
+		Inicio=Medio+1;
+    }
+if ( (!Inicio) || (!Runs[Inicio-1].BloqueFisico) || (BloqueLogico>=Runs[Inicio-1].BloqueLogico+Runs[Inicio-1].Bloques) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Levantarlo */
+NroBloque=Runs[Inicio-1].BloqueFisico+(BloqueLogico-Runs[Inicio-1].BloqueLogico);
+if (NroBloque>=NumeroDeBloques)
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+if ( (pBloque=PunteroABytes(NroBloque*DatosFS.BytesPorCluster, DatosFS.BytesPorCluster)) == NULL )
+	return(CODERROR_LECTURA_DISCO);
+
 /* Salir */
-return(CODERROR_NO_IMPLEMENTADO);
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TDriverEXT :: EntradaDirectorioValida							*
+ *																	*
+ * OBJETIVO: Esta función verifica que una entrada de un bloque de directorio esté completa dentro del bloque.				*
+ *																	*
+ * ENTRADA: pBloque: Bloque del directorio.												*
+ *	    Offset: Posición de la entrada dentro del bloque.										*
+ *	    BytesBloque: Tamaño del bloque.												*
+ *																	*
+ * SALIDA: En el nombre de la función true si la entrada es válida.									*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TDriverEXT::EntradaDirectorioValida(const unsigned char *pBloque, unsigned Offset, unsigned BytesBloque)
+{
+const TDirEntryEXT	*pEntrada = (const TDirEntryEXT *)(pBloque+Offset);
+
+/* Cada entrada dice cuánto ocupa, es múltiplo de 4 y ninguna cruza el final del bloque */
+if (Offset+sizeof(TDirEntryEXT)>BytesBloque)
+	return(false);
+return( ((__u16)pEntrada->rec_len>=sizeof(TDirEntryEXT)+pEntrada->name_len) && !((__u16)pEntrada->rec_len&3) &&
+	(Offset+(__u16)pEntrada->rec_len<=BytesBloque) );
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverEXT :: HashNombreDx							*
+ *																	*
+ * OBJETIVO: Esta función calcula el hash de un nombre con el que se ordena el índice htree de los directorios.				*
+ *																	*
+ * ENTRADA: Nombre: El nombre.														*
+ *	    VersionHash: Una de las constantes EXT_DX_HASH_xxx.										*
+ *																	*
+ * SALIDA: En el nombre de la función el hash (con el bit 0 en cero).									*
+ *																	*
+ * OBSERVACIONES: Es el mismo cálculo que hace el kernel de Linux (fs/ext4/hash.c), con la semilla del superbloque.			*
+ *																	*
+ ****************************************************************************************************************************************/
+__u32 TDriverEXT::HashNombreDx(const TString &Nombre, int VersionHash) const
+{
+__u32		Buffer[4], Entrada[8], Hash;
+const char	*pNombre;
+int		Largo;
+bool		SinSigno;
+
+/* La semilla por omisión es la de MD4 */
+Buffer[0]=0x67452301;
+Buffer[1]=0xEFCDAB89;
+Buffer[2]=0x98BADCFE;
+Buffer[3]=0x10325476;
+if (SuperBloque.s_hash_seed[0] || SuperBloque.s_hash_seed[1] || SuperBloque.s_hash_seed[2] || SuperBloque.s_hash_seed[3])
+	memcpy(Buffer, SuperBloque.s_hash_seed, sizeof(Buffer));
+
+/* Calcular el hash que corresponda */
+pNombre=Nombre.data();
+Largo=Nombre.size();
+SinSigno=VersionHash>=EXT_DX_HASH_LEGACY_UNSIGNED;
+switch (VersionHash)
+    {
+	case EXT_DX_HASH_LEGACY:
+	case EXT_DX_HASH_LEGACY_UNSIGNED:
+		Hash=HashLegacyDx(pNombre, Largo, SinSigno);
+		break;
+	case EXT_DX_HASH_HALF_MD4:
+	case EXT_DX_HASH_HALF_MD4_UNSIGNED:
+		for (;Largo>0;Largo-=32, pNombre+=32)
+		    {
+			ArmarEntradaHashDx(pNombre, Largo, Entrada, 8, SinSigno);
+			TransformarHalfMD4Dx(Buffer, Entrada);
+		    }
+		Hash=Buffer[1];
+		break;
+	default:
+		for (;Largo>0;Largo-=16, pNombre+=16)
+		    {
+			ArmarEntradaHashDx(pNombre, Largo, Entrada, 4, SinSigno);
+			TransformarTEADx(Buffer, Entrada);
+		    }
+		Hash=Buffer[0];
+		break;
+    }
+
+/* El bit 0 marca continuación en el índice, y el último valor está reservado como fin de directorio */
+Hash&=~1u;
+if (Hash==(EXT_HTREE_EOF_32BIT<<1))
+	Hash=(EXT_HTREE_EOF_32BIT-1)<<1;
+return(Hash);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverEXT :: HashLegacyDx							*
+ *																	*
+ * OBJETIVO: Esta función calcula el hash original (legacy) de un nombre.								*
+ *																	*
+ * ENTRADA: pNombre, Largo: El nombre.													*
+ *	    SinSigno: Si los caracteres se toman sin signo.										*
+ *																	*
+ * SALIDA: En el nombre de la función el hash.												*
+ *																	*
+ ****************************************************************************************************************************************/
+__u32 TDriverEXT::HashLegacyDx(const char *pNombre, int Largo, bool SinSigno)
+{
+__u32	Hash, Hash0 = 0x12A3FE2D, Hash1 = 0x37ABE8F9;
+int	Caracter;
+
+while (Largo--)
+    {
+	Caracter=SinSigno ? (int)(unsigned char)*pNombre++ : (int)(signed char)*pNombre++;
+	Hash=Hash1+(Hash0^(Caracter*7152373));
+	if (Hash&0x80000000)
+		Hash-=0x7FFFFFFF;
+	Hash1=Hash0;
+	Hash0=Hash;
+    }
+return(Hash0<<1);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverEXT :: ArmarEntradaHashDx							*
+ *																	*
+ * OBJETIVO: Esta función arma el bloque de entrada de TEA y half MD4 a partir de un pedazo del nombre.					*
+ *																	*
+ * ENTRADA: pNombre, Largo: Lo que queda del nombre (se usan a lo sumo Palabras*4 caracteres).						*
+ *	    Palabras: Cantidad de palabras de 32 bits a armar.										*
+ *	    SinSigno: Si los caracteres se toman sin signo.										*
+ *																	*
+ * SALIDA: Entrada: Las palabras, completadas con un relleno que depende del largo.							*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverEXT::ArmarEntradaHashDx(const char *pNombre, int Largo, __u32 *Entrada, int Palabras, bool SinSigno)
+{
+__u32	Relleno, Valor;
+int	i;
+
+Relleno=(__u32)Largo | ((__u32)Largo<<8);
+Relleno|=Relleno<<16;
+Valor=Relleno;
+if (Largo>Palabras*4)
+	Largo=Palabras*4;
+for (i=0;i<Largo;i++)
+    {
+	Valor=(SinSigno ? (int)(unsigned char)pNombre[i] : (int)(signed char)pNombre[i])+(Valor<<8);
+	if ((i%4)==3)
+	    {
+		*Entrada++=Valor;
+		Valor=Relleno;
+		Palabras--;
+	    }
+    }
+if (--Palabras>=0)
+	*Entrada++=Valor;
+while (--Palabras>=0)
+	*Entrada++=Relleno;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverEXT :: TransformarTEADx							*
+ *																	*
+ * OBJETIVO: Esta función aplica 16 vueltas de TEA a las dos primeras palabras del buffer del hash.					*
+ *																	*
+ * ENTRADA: Buffer: Estado del hash.													*
+ *	    Entrada: Las 4 palabras del pedazo de nombre.										*
+ *																	*
+ * SALIDA: Buffer: El estado actualizado.												*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverEXT::TransformarTEADx(__u32 *Buffer, const __u32 *Entrada)
+{
+__u32	Suma = 0, b0 = Buffer[0], b1 = Buffer[1];
+int	n;
+
+for (n=0;n<16;n++)
+    {
+	Suma+=0x9E3779B9;
+	b0+=((b1<<4)+Entrada[0])^(b1+Suma)^((b1>>5)+Entrada[1]);
+	b1+=((b0<<4)+Entrada[2])^(b0+Suma)^((b0>>5)+Entrada[3]);
+    }
+Buffer[0]+=b0;
+Buffer[1]+=b1;
+}
+
+
+/* Funciones y paso de MD4 (sacados de fs/ext4/hash.c) */
+#define	MD4_F(x, y, z)		((z)^((x)&((y)^(z))))
+#define	MD4_G(x, y, z)		(((x)&(y))+(((x)^(y))&(z)))
+#define	MD4_H(x, y, z)		((x)^(y)^(z))
+#define	MD4_PASO(f, a, b, c, d, x, s)	(a+=f(b, c, d)+(x), a=(a<<(s))|(a>>(32-(s))))
+#define	MD4_K2			013240474631u
+#define	MD4_K3			015666365641u
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverEXT :: TransformarHalfMD4Dx							*
+ *																	*
+ * OBJETIVO: Esta función aplica la transformación half MD4 (MD4 con 3 rondas de 8 pasos) al buffer del hash.				*
+ *																	*
+ * ENTRADA: Buffer: Estado del hash.													*
+ *	    Entrada: Las 8 palabras del pedazo de nombre.										*
+ *																	*
+ * SALIDA: Buffer: El estado actualizado.												*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverEXT::TransformarHalfMD4Dx(__u32 *Buffer, const __u32 *Entrada)
+{
+__u32	a = Buffer[0], b = Buffer[1], c = Buffer[2], d = Buffer[3];
+
+/* Ronda 1 */
+MD4_PASO(MD4_F, a, b, c, d, Entrada[0],  3);
+MD4_PASO(MD4_F, d, a, b, c, Entrada[1],  7);
+MD4_PASO(MD4_F, c, d, a, b, Entrada[2], 11);
+MD4_PASO(MD4_F, b, c, d, a, Entrada[3], 19);
+MD4_PASO(MD4_F, a, b, c, d, Entrada[4],  3);
+MD4_PASO(MD4_F, d, a, b, c, Entrada[5],  7);
+MD4_PASO(MD4_F, c, d, a, b, Entrada[6], 11);
+MD4_PASO(MD4_F, b, c, d, a, Entrada[7], 19);
+
+/* Ronda 2 */
+MD4_PASO(MD4_G, a, b, c, d, Entrada[1]+MD4_K2,  3);
+MD4_PASO(MD4_G, d, a, b, c, Entrada[3]+MD4_K2,  5);
+MD4_PASO(MD4_G, c, d, a, b, Entrada[5]+MD4_K2,  9);
+MD4_PASO(MD4_G, b, c, d, a, Entrada[7]+MD4_K2, 13);
+MD4_PASO(MD4_G, a, b, c, d, Entrada[0]+MD4_K2,  3);
+MD4_PASO(MD4_G, d, a, b, c, Entrada[2]+MD4_K2,  5);
+MD4_PASO(MD4_G, c, d, a, b, Entrada[4]+MD4_K2,  9);
+MD4_PASO(MD4_G, b, c, d, a, Entrada[6]+MD4_K2, 13);
+
+/* Ronda 3 */
+MD4_PASO(MD4_H, a, b, c, d, Entrada[3]+MD4_K3,  3);
+MD4_PASO(MD4_H, d, a, b, c, Entrada[7]+MD4_K3,  9);
+MD4_PASO(MD4_H, c, d, a, b, Entrada[2]+MD4_K3, 11);
+MD4_PASO(MD4_H, b, c, d, a, Entrada[6]+MD4_K3, 15);
+MD4_PASO(MD4_H, a, b, c, d, Entrada[1]+MD4_K3,  3);
+MD4_PASO(MD4_H, d, a, b, c, Entrada[5]+MD4_K3,  9);
+MD4_PASO(MD4_H, c, d, a, b, Entrada[0]+MD4_K3, 11);
+MD4_PASO(MD4_H, b, c, d, a, Entrada[4]+MD4_K3, 15);
+
+Buffer[0]+=a;
+Buffer[1]+=b;
+Buffer[2]+=c;
+Buffer[3]+=d;
 }
 
+
 /****************************************************************************************************************************************
  *																	*
  *						     TDriverEXT :: LeerArchivo								*
@@ -87,12 +1676,486 @@ return(CODERROR_NO_IMPLEMENTADO);
  * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
  *	   Data: Buffer alocado con malloc() con los datos del archivo.									*
  *	   DataLen: Tamaño en bytes del buffer devuelto.										*
- *																	*						*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::LeerArchivo(const char *Path, unsigned char *&Data, __u64 &DataLen) const
+{
+/* Juntar los tramos que entrega LeerArchivoPorTramos() en un único buffer */
+return(LeerArchivoCompleto(Path, Data, DataLen));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverEXT :: LeerArchivoPorTramos							*
+ *																	*
+ * OBJETIVO: Esta función lee un archivo de la imágen entregándolo de a tramos contiguos, sin copiarlo.					*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo a leer.												*
+ *	    Receptor: Función a la que se le entrega cada tramo, en orden.								*
+ *	    pParametroUsuario: Valor que se le pasa sin modificar al receptor.								*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Cada corrida de bloques contiguos (un extent, o punteros consecutivos) se entrega como un único tramo.		*
+ *		  Un link simbólico se lee como su destino; los cortos están guardados directamente en i_block.				*
+ *		  Los archivos con inline_data se entregan directo desde el inode, sin leer bloques.					*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::LeerArchivoPorTramos(const char *Path, TpReceptorTramo Receptor, void *pParametroUsuario) const
+{
+int					CodError;
+TEntradaDirectorio			Entrada;
+TINodeEXT				INode;
+std::vector<TRunEXT>			Runs;
+TTramoArchivo				Tramo;
+std::unique_lock<std::recursive_mutex>	Bloqueo = SerializarLectura();
+
+/* Buscar el archivo */
+if ( (CodError=BuscarEntrada(Path, Entrada)) != CODERROR_NINGUNO )
+	return(CodError);
+if (Entrada.Flags&fedDIRECTORIO)
+	return(CODERROR_ARCHIVO_INEXISTENTE);
+if ( (CodError=LeerINode(Entrada.DatosEspecificos.EXT.INode, INode)) != CODERROR_NINGUNO )
+	return(CodError);
+
+/* Archivo chico con los datos dentro del inode */
+Tramo.BytesArchivo=BytesINode(INode);
+if (INode.i_flags&EXT4_INLINE_DATA_FL)
+	return(EmitirDatosInline(Entrada.DatosEspecificos.EXT.INode, Tramo.BytesArchivo, Receptor, pParametroUsuario));
+
+/* Link simbólico corto: el destino está en i_block */
+if ( S_ISLNK(INode.i_mode) && (Tramo.BytesArchivo<sizeof(INode.i_block)) && !(INode.i_flags&EXT4_EXTENTS_FL) )
+    {
+	if (!Tramo.BytesArchivo)
+		return(CODERROR_NINGUNO);
+	Tramo.Datos=(const unsigned char *)INode.i_block;
+	Tramo.Bytes=Tramo.BytesArchivo;
+	Tramo.Offset=0;
+	return(Receptor(Tramo, pParametroUsuario));
+    }
+
+/* Entregar el archivo de a corridas */
+if ( (CodError=ArmarRuns(INode, Runs)) != CODERROR_NINGUNO )
+	return(CodError);
+return(EmitirRuns(Runs, Tramo.BytesArchivo, Receptor, pParametroUsuario));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverEXT :: RecorrerVolumen							*
+ *																	*
+ * OBJETIVO: Esta función entrega cada archivo y directorio del volumen con su ruta completa, leyendo las tablas de inodes en orden.	*
+ *																	*
+ * ENTRADA: Receptor, pParametroUsuario: Ver TDriverBase::RecorrerVolumen().								*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: En vez de bajar por el árbol leyendo el inode de cada entrada, que salta por todas las tablas de inodes, se hace un	*
+ *		  inventario de los inodes en uso recorriendo la tabla de cada grupo de punta a punta, después se leen los bloques de	*
+ *		  todos los directorios ordenados por su posición en el disco juntando los nombres, y las rutas se arman con		*
+ *		  ArmarRutaRecorrido() subiendo por el padre de cada directorio. Las entradas salen en el orden de los bloques de	*
+ *		  directorio, una por cada nombre (un archivo con varios hard links sale varias veces), y no salen las que cuelgan de	*
+ *		  un directorio que no llega al raíz. El recorrido no pasa por el cache de inodes.					*
+ *		  Los grupos no dependen uno de otro, así que cada paso se reparte con EjecutarEnParalelo() a razón de una tarea por	*
+ *		  grupo, y los resultados se juntan en el orden de los grupos: la salida es la misma con cualquier cantidad de hilos.	*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::RecorrerVolumen(TpReceptorEntrada Receptor, void *pParametroUsuario) const
+{
+int						CodError;
+TRecorridoEXT					Recorrido;
+std::vector<TNombreEXT>				Nombres;
+std::unordered_map<__u64, TDirectorioRecorrido>	Directorios;
+TDirectorioRecorrido				*pDirectorio;
+const TDatosGrupoFSEXT				*pGrupo;
+TEntradaDirectorio				Entrada;
+const TString					*pRuta;
+TString						Ruta;
+size_t						NroGrupos, NroGrupo, i;
+std::unique_lock<std::recursive_mutex>		Bloqueo = SerializarLectura();
+
+/* Levantar antes todos los descriptores, así las tareas no se esperan una a otra para levantarlos */
+NroGrupos=DatosFS.DatosEspecificos.EXT.NroGrupos;
+for (NroGrupo=0;NroGrupo<NroGrupos;NroGrupo++)
+	if ( (CodError=CargarDatosGrupo(NroGrupo, pGrupo)) != CODERROR_NINGUNO )
+		return(CodError);
+Recorrido.pDriver=this;
+Recorrido.Grupos.resize(NroGrupos);
+
+/* Inventario de los inodes en uso, grupo por grupo */
+if ( (CodError=EjecutarEnParalelo(NroGrupos, TareaInventarioGrupo, &Recorrido)) != CODERROR_NINGUNO )
+	return(CodError);
+for (NroGrupo=0;NroGrupo<NroGrupos;NroGrupo++)
+    {
+	Recorrido.INodes.insert(Recorrido.INodes.end(), Recorrido.Grupos[NroGrupo].INodes.begin(), Recorrido.Grupos[NroGrupo].INodes.end());
+	std::vector<TEntradaDirectorio>().swap(Recorrido.Grupos[NroGrupo].INodes);
+    }
+
+/* Corridas de bloques de los directorios de cada grupo, ordenadas por su posición en el disco */
+if ( (CodError=EjecutarEnParalelo(NroGrupos, TareaTramosGrupo, &Recorrido)) != CODERROR_NINGUNO )
+	return(CodError);
+for (NroGrupo=0;NroGrupo<NroGrupos;NroGrupo++)
+    {
+	Recorrido.Tramos.insert(Recorrido.Tramos.end(), Recorrido.Grupos[NroGrupo].Tramos.begin(), Recorrido.Grupos[NroGrupo].Tramos.end());
+	Nombres.insert(Nombres.end(), Recorrido.Grupos[NroGrupo].NombresInline.begin(), Recorrido.Grupos[NroGrupo].NombresInline.end());
+	std::vector<TEntradaCacheINodes>().swap(Recorrido.Grupos[NroGrupo].INodesDirectorio);
+    }
+std::sort(Recorrido.Tramos.begin(), Recorrido.Tramos.end(), TramoMenor);
+
+/* Juntar los nombres leyendo las corridas que empiezan en cada grupo */
+for (NroGrupo=0, i=0;NroGrupo<NroGrupos;NroGrupo++)
+    {
+	Recorrido.Grupos[NroGrupo].PrimerTramo=i;
+	while ( (i<Recorrido.Tramos.size()) &&
+		((Recorrido.Tramos[i].BloqueFisico-SuperBloque.s_first_data_block)/SuperBloque.s_blocks_per_group<=NroGrupo) )
+		i++;
+	Recorrido.Grupos[NroGrupo].FinTramos=NroGrupo+1<NroGrupos ? i : Recorrido.Tramos.size();
+    }
+if ( (CodError=EjecutarEnParalelo(NroGrupos, TareaNombresGrupo, &Recorrido)) != CODERROR_NINGUNO )
+	return(CodError);
+for (NroGrupo=0;NroGrupo<NroGrupos;NroGrupo++)
+	Nombres.insert(Nombres.end(), Recorrido.Grupos[NroGrupo].Nombres.begin(), Recorrido.Grupos[NroGrupo].Nombres.end());
+Recorrido.Grupos.clear();
+
+/* Indexar los directorios por inode. El raíz ya tiene su ruta */
+Directorios[EXT_ROOT_INO].Estado=erARMADA;
+for (i=0;i<Nombres.size();i++)
+    {
+	if ( (!(Recorrido.INodes[Nombres[i].PosicionINode].Flags&fedDIRECTORIO)) ||
+	     (Directorios.count(Recorrido.INodes[Nombres[i].PosicionINode].DatosEspecificos.EXT.INode)) )
+		continue;
+	pDirectorio=&Directorios[Recorrido.INodes[Nombres[i].PosicionINode].DatosEspecificos.EXT.INode];
+	pDirectorio->IdPadre=Nombres[i].INodePadre;
+	pDirectorio->Nombre=Nombres[i].Nombre;
+	pDirectorio->Estado=erSIN_ARMAR;
+    }
+
+/* Entregar cada nombre con la ruta de su padre */
+for (i=0;i<Nombres.size();i++)
+    {
+	if (ArmarRutaRecorrido(Nombres[i].INodePadre, Directorios, pRuta)!=CODERROR_NINGUNO)
+		continue;
+	Ruta=*pRuta;
+	Ruta+='/';
+	Ruta+=Nombres[i].Nombre;
+	Entrada=Recorrido.INodes[Nombres[i].PosicionINode];
+	Entrada.Nombre.swap(Nombres[i].Nombre);
+	if ( (CodError=Receptor(Ruta, Entrada, pParametroUsuario)) != CODERROR_NINGUNO )
+		return(CodError);
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverEXT :: TareaInventarioGrupo							*
+ *																	*
+ * OBJETIVO: Esta función es la tarea que hace el inventario de los inodes en uso de un grupo.						*
+ *																	*
+ * ENTRADA: NroGrupo: Número de grupo.													*
+ *	    pParametroUsuario: El TRecorridoEXT del recorrido.										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::TareaInventarioGrupo(size_t NroGrupo, void *pParametroUsuario)
+{
+TRecorridoEXT	*pRecorrido = (TRecorridoEXT *)pParametroUsuario;
+
+return(pRecorrido->pDriver->EscanearGrupoINodes(NroGrupo, pRecorrido->Grupos[NroGrupo].INodes, pRecorrido->Grupos[NroGrupo].INodesDirectorio));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverEXT :: TareaTramosGrupo							*
+ *																	*
+ * OBJETIVO: Esta función es la tarea que junta las corridas de bloques de los directorios de un grupo.					*
+ *																	*
+ * ENTRADA: NroGrupo: Número de grupo.													*
+ *	    pParametroUsuario: El TRecorridoEXT del recorrido, con el inventario de todo el volumen ya armado.				*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::TareaTramosGrupo(size_t NroGrupo, void *pParametroUsuario)
+{
+TRecorridoEXT		*pRecorrido = (TRecorridoEXT *)pParametroUsuario;
+TRecorridoGrupoEXT	&Grupo = pRecorrido->Grupos[NroGrupo];
+int			CodError;
+size_t			i;
+
+for (i=0;i<Grupo.INodesDirectorio.size();i++)
+	if ( (CodError=pRecorrido->pDriver->JuntarTramosDirectorio(Grupo.INodesDirectorio[i], pRecorrido->INodes, Grupo.Tramos,
+								    Grupo.NombresInline)) != CODERROR_NINGUNO )
+		return(CodError);
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverEXT :: TareaNombresGrupo							*
+ *																	*
+ * OBJETIVO: Esta función es la tarea que lee los nombres de las corridas de directorio que empiezan en un grupo.			*
+ *																	*
+ * ENTRADA: NroGrupo: Número de grupo.													*
+ *	    pParametroUsuario: El TRecorridoEXT del recorrido, con las corridas ya ordenadas y repartidas.				*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::TareaNombresGrupo(size_t NroGrupo, void *pParametroUsuario)
+{
+TRecorridoEXT		*pRecorrido = (TRecorridoEXT *)pParametroUsuario;
+TRecorridoGrupoEXT	&Grupo = pRecorrido->Grupos[NroGrupo];
+
+return(pRecorrido->pDriver->LeerNombresTramos(pRecorrido->Tramos, Grupo.PrimerTramo, Grupo.FinTramos, pRecorrido->INodes, Grupo.Nombres));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverEXT :: LeerNombresTramos							*
+ *																	*
+ * OBJETIVO: Esta función junta los nombres de un rango de corridas de directorio, leyéndolas de a lotes.				*
+ *																	*
+ * ENTRADA: Tramos: Las corridas.													*
+ *	    Primero, Fin: Rango de corridas a leer (de Primero a Fin-1).								*
+ *	    INodes: El inventario de inodes en uso, ordenado por número de inode.							*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Nombres: Los nombres agregados al final, en el orden de las corridas.							*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::LeerNombresTramos(const std::vector<TTramoDirectorioEXT> &Tramos, size_t Primero, size_t Fin,
+				  const std::vector<TEntradaDirectorio> &INodes, std::vector<TNombreEXT> &Nombres) const
+{
+int				CodError;
+std::vector<TEntradaDirectorio>	Entradas;
+const unsigned char		*pBloques;
+__u64				BloquesLote, Cantidad, j, k;
+size_t				i;
+
+BloquesLote=EXT_BYTES_LOTE_RECORRIDO/DatosFS.BytesPorCluster;
+if (!BloquesLote)
+	BloquesLote=1;
+for (i=Primero;i<Fin;i++)
+	for (j=0;j<Tramos[i].Bloques;j+=Cantidad)
+	    {
+		Cantidad=min(BloquesLote, Tramos[i].Bloques-j);
+		if ( (pBloques=PunteroABytes((Tramos[i].BloqueFisico+j)*DatosFS.BytesPorCluster, Cantidad*DatosFS.BytesPorCluster)) == NULL )
+			return(CODERROR_LECTURA_DISCO);
+		Entradas.clear();
+		for (k=0;k<Cantidad;k++)
+			if ( (CodError=JuntarEntradasDirectorio(pBloques+k*DatosFS.BytesPorCluster, DatosFS.BytesPorCluster, Entradas)) != CODERROR_NINGUNO )
+				return(CodError);
+		AgregarNombresVolumen(Tramos[i].NroINode, Entradas, INodes, Nombres);
+	    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverEXT :: EscanearGrupoINodes							*
+ *																	*
+ * OBJETIVO: Esta función agrega al inventario los inodes en uso de un grupo, leyendo su tabla de inodes en orden.			*
+ *																	*
+ * ENTRADA: NroGrupo: Número de grupo (el primero es el 0).										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   INodes: Una entrada sin nombre por cada inode en uso, agregadas al final (quedan ordenadas por número de inode).		*
+ *	   INodesDirectorio: Copia de los inodes de los directorios, agregados al final.						*
+ *																	*
+ * OBSERVACIONES: Los inodes en uso son los marcados en el bitmap de inodes. Con checksums en los descriptores, un grupo con		*
+ *		  INODE_UNINIT no tiene ninguno y los del final de la tabla que nunca se usaron (bg_itable_unused) ni se leen, así	*
+ *		  que tampoco se mira basura de una tabla que mkfs no llegó a inicializar.						*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::EscanearGrupoINodes(__u32 NroGrupo, std::vector<TEntradaDirectorio> &INodes, std::vector<TEntradaCacheINodes> &INodesDirectorio) const
+{
+const TDatosFSEXT		&DatosEXT = DatosFS.DatosEspecificos.EXT;
+int				CodError;
+const TDatosGrupoFSEXT		*pGrupo;
+const unsigned char		*pBitmap, *pTabla;
+std::vector<unsigned char>	Bitmap;
+TINodeEXT			INode;
+__u32				INodesGrupo, INodesLote, Primero, Cantidad, Indice, NroINode;
+
+/* Ver cuántos inodes de la tabla pueden estar en uso */
+if ( (CodError=CargarDatosGrupo(NroGrupo, pGrupo)) != CODERROR_NINGUNO )
+	return(CodError);
+INodesGrupo=min((__u32)DatosEXT.INodesPorGrupo, (__u32)SuperBloque.s_inodes_count-NroGrupo*(__u32)DatosEXT.INodesPorGrupo);
+if (SuperBloque.s_feature_ro_compat&(EXT4_FEATURE_RO_COMPAT_GDT_CSUM | EXT4_FEATURE_RO_COMPAT_METADATA_CSUM))
+    {
+	if (pGrupo->Flags&EXT4_BG_INODE_UNINIT)
+		return(CODERROR_NINGUNO);
+	INodesGrupo-=min(pGrupo->INodesSinUsar, INodesGrupo);
+    }
+if (!INodesGrupo)
+	return(CODERROR_NINGUNO);
+
+/* Copiar el bitmap, que tiene que durar mientras se lee la tabla */
+if ( (pBitmap=PunteroABytes(pGrupo->ClusterBitmapINodes*DatosFS.BytesPorCluster, (INodesGrupo+7)/8)) == NULL )
+	return(CODERROR_LECTURA_DISCO);
+Bitmap.assign(pBitmap, pBitmap+(INodesGrupo+7)/8);
+
+/* Recorrer la tabla de a lotes */
+INodesLote=EXT_BYTES_LOTE_RECORRIDO/DatosEXT.BytesPorINode;
+for (Primero=0;Primero<INodesGrupo;Primero+=Cantidad)
+    {
+	Cantidad=min(INodesLote, INodesGrupo-Primero);
+	if ( (pTabla=PunteroABytes(pGrupo->ClusterTablaINodes*DatosFS.BytesPorCluster+(__u64)Primero*DatosEXT.BytesPorINode,
+				   (__u64)Cantidad*DatosEXT.BytesPorINode)) == NULL )
+		return(CODERROR_LECTURA_DISCO);
+	for (Indice=Primero;Indice<Primero+Cantidad;Indice++)
+	    {
+		if (!(Bitmap[Indice/8]&(1<<(Indice%8))))
+			continue;
+		CopiarINode(pTabla+(__u64)(Indice-Primero)*DatosEXT.BytesPorINode, INode);
+		if ( (!INode.i_mode) || (!INode.i_links_count) )
+			continue;
+		NroINode=NroGrupo*(__u32)DatosEXT.INodesPorGrupo+Indice+1;
+		INodes.push_back(TEntradaDirectorio());
+		CompletarEntrada(NroINode, INode, INodes.back());
+		if (S_ISDIR(INode.i_mode))
+		    {
+			INodesDirectorio.push_back(TEntradaCacheINodes());
+			INodesDirectorio.back().NroINode=NroINode;
+			INodesDirectorio.back().INode=INode;
+		    }
+	    }
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverEXT :: JuntarTramosDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función agrega las corridas de bloques de un directorio, para leerlas después junto con las de los demás.		*
+ *																	*
+ * ENTRADA: Directorio: El directorio y su inode.											*
+ *	    INodes: El inventario de inodes en uso.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Tramos: Las corridas del directorio, recortadas a su tamaño y agregadas al final.						*
+ *	   Nombres: Los nombres del directorio, agregados al final, si es un directorio inline que no tiene bloques.			*
+ *																	*
  ****************************************************************************************************************************************/
-int TDriverEXT::LeerArchivo(const char *Path, unsigned char *&Data, unsigned &DataLen)
+int TDriverEXT::JuntarTramosDirectorio(const TEntradaCacheINodes &Directorio, const std::vector<TEntradaDirectorio> &INodes,
+				       std::vector<TTramoDirectorioEXT> &Tramos, std::vector<TNombreEXT> &Nombres) const
 {
+int				CodError;
+std::vector<TRunEXT>		Runs;
+std::vector<TEntradaDirectorio>	Entradas;
+__u64				BloquesDirectorio;
+size_t				i;
+
+/* Un directorio chico puede tener las entradas dentro del propio inode */
+if (Directorio.INode.i_flags&EXT4_INLINE_DATA_FL)
+    {
+	if ( (CodError=ListarDirectorioInline(Directorio.NroINode, Entradas)) != CODERROR_NINGUNO )
+		return(CodError);
+	AgregarNombresVolumen(Directorio.NroINode, Entradas, INodes, Nombres);
+	return(CODERROR_NINGUNO);
+    }
+
+/* Si no, quedarse con las corridas que caen dentro del tamaño del directorio */
+if ( (CodError=ArmarRuns(Directorio.INode, Runs)) != CODERROR_NINGUNO )
+	return(CodError);
+BloquesDirectorio=BytesINode(Directorio.INode)/DatosFS.BytesPorCluster;
+for (i=0;(i<Runs.size()) && (Runs[i].BloqueLogico<BloquesDirectorio);i++)
+    {
+	/* Un directorio no tiene huecos */
+	Tramos.push_back(TTramoDirectorioEXT());
+	Tramos.back().BloqueFisico=Runs[i].BloqueFisico;
+	Tramos.back().Bloques=min(Runs[i].Bloques, BloquesDirectorio-Runs[i].BloqueLogico);
+	Tramos.back().NroINode=Directorio.NroINode;
+	if ( (!Tramos.back().BloqueFisico) || (Tramos.back().BloqueFisico+Tramos.back().Bloques>NumeroDeBloques) )
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+    }
+
 /* Salir */
-return(CODERROR_NO_IMPLEMENTADO);
+return(CODERROR_NINGUNO);
 }
 
 
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverEXT :: AgregarNombresVolumen							*
+ *																	*
+ * OBJETIVO: Esta función agrega los nombres de un directorio que apuntan a inodes en uso.						*
+ *																	*
+ * ENTRADA: INodePadre: Inode del directorio.												*
+ *	    Entradas: Las entradas del directorio, con nombre e inode.									*
+ *	    INodes: El inventario de inodes en uso, ordenado por número de inode.							*
+ *																	*
+ * SALIDA: Nombres: Los nombres agregados al final, sin "." ni "..".									*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverEXT::AgregarNombresVolumen(__u32 INodePadre, const std::vector<TEntradaDirectorio> &Entradas,
+				       const std::vector<TEntradaDirectorio> &INodes, std::vector<TNombreEXT> &Nombres) const
+{
+std::vector<TEntradaDirectorio>::const_iterator	itINode;
+size_t						i;
+
+for (i=0;i<Entradas.size();i++)
+    {
+	if ( (Entradas[i].Nombre==".") || (Entradas[i].Nombre=="..") )
+		continue;
+	itINode=std::lower_bound(INodes.begin(), INodes.end(), Entradas[i].DatosEspecificos.EXT.INode, INodeMenor);
+	if ( (itINode==INodes.end()) || (itINode->DatosEspecificos.EXT.INode!=Entradas[i].DatosEspecificos.EXT.INode) )
+		continue;
+	Nombres.push_back(TNombreEXT());
+	Nombres.back().INodePadre=INodePadre;
+	Nombres.back().PosicionINode=itINode-INodes.begin();
+	Nombres.back().Nombre=Entradas[i].Nombre;
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverEXT :: INodeMenor								*
+ *																	*
+ * OBJETIVO: Esta función compara una entrada del inventario de inodes con un número de inode, para buscarlo con std::lower_bound.	*
+ *																	*
+ * ENTRADA: Entrada: Entrada del inventario.												*
+ *	    NroINode: Número de inode buscado.												*
+ *																	*
+ * SALIDA: En el nombre de la función true si la entrada es de un inode anterior.							*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TDriverEXT::INodeMenor(const TEntradaDirectorio &Entrada, __u32 NroINode)
+{
+return(Entrada.DatosEspecificos.EXT.INode<NroINode);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverEXT :: TramoMenor								*
+ *																	*
+ * OBJETIVO: Esta función compara dos corridas de directorio por su posición en el disco, para ordenarlas con std::sort.		*
+ *																	*
+ * ENTRADA: Tramo1, Tramo2: Las corridas.												*
+ *																	*
+ * SALIDA: En el nombre de la función true si la primera empieza antes.									*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TDriverEXT::TramoMenor(const TTramoDirectorioEXT &Tramo1, const TTramoDirectorioEXT &Tramo2)
+{
+return(Tramo1.BloqueFisico<Tramo2.BloqueFisico);
+}
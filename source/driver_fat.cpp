@@ -3,7 +3,7 @@
 #include <cstring>  // Para strchr
 #include <ctime> // Para struct tm y mktime()
 
-// Estructura del Boot Sector (BPB - BIOS Parameter Block) para FAT12
+// Estructura del Boot Sector (BPB - BIOS Parameter Block) para FAT12/FAT16/FAT32
 typedef struct __attribute__((packed)) { //usamos packed para evitar el padding
     __u8  Jump[3]; // Jump x si el disco estar formateado en Fat
     char  OEM[8]; // Nombre del SO con el que se formateo
@@ -14,14 +14,66 @@ typedef struct __attribute__((packed)) { //usamos packed para evitar el padding
     __u16 EntradasRootDir;      // Limite para FAT12
     __u16 TotalSectores16;    // (si entra; si es cero, no es FAT12)
     __u8  MediaDescriptor;
-    __u16 SectoresPorFAT;       
+    __u16 SectoresPorFAT;       // Cero en FAT32: se usa SectoresPorFAT32
     __u16 SectoresPorTrack;
     __u16 NumeroDeHeads;
     __u32 SectoresOcultos;
     __u32 TotalSectores32;
-    // ... aquí irían más campos para FAT32, pero para FAT12/16 no los necesitamos
+    // A partir de acá los campos sólo valen para FAT32 (en FAT12/16 en este lugar está el BPB extendido)
+    __u32 SectoresPorFAT32;
+    __u16 FlagsFAT32;           // bit 7 prendido: sólo se usa la FAT indicada en los bits 0-3
+    __u16 VersionFAT32;
+    __u32 ClusterRootDir;       // El root de FAT32 es una cadena de clusters como cualquier directorio
+    __u16 SectorFSInfo;
+    __u16 SectorCopiaBoot;
 } TBiosParameterBlockFAT;
 
+// Sector FSInfo de FAT32 (sólo nos interesan las firmas y los contadores)
+typedef struct __attribute__((packed)) {
+    __u32 FirmaInicial;         // 0x41615252
+    __u8  Reservado1[480];
+    __u32 FirmaEstructura;      // 0x61417272
+    __u32 ClustersLibres;       // 0xFFFFFFFF si no se conoce
+    __u32 ProximoClusterLibre;  // 0xFFFFFFFF si no se conoce
+    __u8  Reservado2[12];
+    __u32 FirmaFinal;           // 0xAA550000
+} TFSInfoFAT32;
+
+// Formas de leer la entrada Indice de la FAT según el ancho de las entradas. Sin saltos: la paridad en FAT12 se resuelve con un shift
+template <int BitsPorEntrada> static inline __u32 LeerEntradaFAT(const unsigned char *pFAT, __u64 Indice);
+
+template <> inline __u32 LeerEntradaFAT<12>(const unsigned char *pFAT, __u64 Indice)
+{
+    // FAT12 usa entradas de 12 bits (1.5 bytes): par = 12 bits inferiores, impar = 12 bits superiores
+    const unsigned char *p = pFAT + (Indice * 3) / 2;
+    return ((p[0] | (p[1] << 8)) >> ((Indice & 1) * 4)) & 0x0FFF;
+}
+
+template <> inline __u32 LeerEntradaFAT<16>(const unsigned char *pFAT, __u64 Indice)
+{
+    const unsigned char *p = pFAT + Indice * 2;
+    return p[0] | (p[1] << 8);
+}
+
+template <> inline __u32 LeerEntradaFAT<32>(const unsigned char *pFAT, __u64 Indice)
+{
+    // Los 4 bits superiores de cada entrada de FAT32 son reservados
+    const unsigned char *p = pFAT + Indice * 4;
+    return (p[0] | (p[1] << 8) | (p[2] << 16) | ((__u32)p[3] << 24)) & 0x0FFFFFFF;
+}
+
+// Decodifica Entradas entradas de la FAT al arreglo plano, normalizando las marcas de fin de cadena
+template <int BitsPorEntrada> static void DesempaquetarFAT(const unsigned char *pFAT, __u32 *pSiguiente, __u64 Entradas)
+{
+    const __u32 finDeCadena = (BitsPorEntrada == 12) ? 0x0FF8 : (BitsPorEntrada == 16) ? 0xFFF8 : 0x0FFFFFF8;
+
+    for (__u64 i = 0; i < Entradas; i++)
+    {
+        __u32 valor = LeerEntradaFAT<BitsPorEntrada>(pFAT, i);
+        pSiguiente[i] = (valor >= finDeCadena) ? FAT_FIN_DE_CADENA : valor;
+    }
+}
+
 /********************************
  *				*
  *	 Clase TDriverFAT	*
@@ -34,13 +86,12 @@ typedef struct __attribute__((packed)) { //usamos packed para evitar el padding
  *																	*
  * OBJETIVO: Inicializar la clase recién creada.											*
  *																	*
- * ENTRADA: DiskData: Puntero a un bloque de memoria con la imágen del disco a analizar.						*
- *	    LongitudDiskData: Tamaño, en bytes, de la imágen a analizar.								*
+ * ENTRADA: FuenteBloques: Fuente de la que leer la imágen del disco a analizar.							*
  *																	*
  * SALIDA: Nada.															*
  *																	*
  ****************************************************************************************************************************************/
-TDriverFAT::TDriverFAT(const unsigned char *DiskData, unsigned LongitudDiskData) : TDriverBase(DiskData, LongitudDiskData)
+TDriverFAT::TDriverFAT(TFuenteBloques *FuenteBloques) : TDriverBase(FuenteBloques)
 {
 }
 
@@ -66,7 +117,7 @@ TDriverFAT::~TDriverFAT()
  *  Devuelve un puntero directo al inicio del cluster solicitado.
  */
 
-const unsigned char* TDriverFAT::PunteroACluster(unsigned int NroCluster)
+const unsigned char* TDriverFAT::PunteroACluster(unsigned int NroCluster) const
 {
     // Los clusters 0 y 1 no son punteros a datos.
     if (NroCluster < 2)
@@ -74,8 +125,17 @@ const unsigned char* TDriverFAT::PunteroACluster(unsigned int NroCluster)
         return nullptr;
     }
 
+    // Devolver el puntero a ese sector usando la función de la clase base (pidiendo el cluster entero contiguo)
+    return this->PunteroASector(this->SectorDeCluster(NroCluster), this->DatosFS.BytesPorCluster);
+}
+
+/**
+ *  Devuelve el número de sector donde arranca el cluster solicitado.
+ */
+__u64 TDriverFAT::SectorDeCluster(unsigned int NroCluster) const
+{
     // 1. Obtener los datos específicos de FAT
-    TDatosFSFAT& fatData = this->DatosFS.DatosEspecificos.FAT;
+    const TDatosFSFAT& fatData = this->DatosFS.DatosEspecificos.FAT;
 
     // 2. Calcular el tamaño del Root Directory (solo para FAT12/16)
     unsigned int sectoresRootDir = 0;
@@ -92,45 +152,12 @@ const unsigned char* TDriverFAT::PunteroACluster(unsigned int NroCluster)
 
     // 4. Calcular el sector de inicio para el cluster N
     // (NroCluster - 2) porque el Cluster #2 está en el offset 0 del área de datos.
-    unsigned int sectorDelCluster = primerSectorDeDatos 
-                                  + ((NroCluster - 2) * fatData.SectoresPorCluster);
-
-    // 5. Devolver el puntero a ese sector usando la función de la clase base
-    return this->PunteroASector(sectorDelCluster);
+    return primerSectorDeDatos + ((__u64)(NroCluster - 2) * fatData.SectoresPorCluster);
 }
 
 
 /* =================== Funciones auxilares  =================== */
-void TDriverFAT::PopPathComponent(const char *pPath, std::string& pComponente, std::string& pResto)
-{   
-    //buffers iniciales
-    pComponente = "";
-    pResto = "";
-
-    //chequear si el path esta vacio
-    if (!pPath || pPath[0] == '\0')
-    {
-        return;}
-
-    // buscar la posicion del primer '/' dentro del arreglo
-    const char* primerSlash = strchr(pPath, '/');
-    
-    if (primerSlash == nullptr)
-    {
-        // si no hay '/' , el path entero esta completo
-        pComponente = pPath;
-    }
-    else
-    {
-        // sino, separamos el arreglo en dos partes pos y pre slash
-        //pre
-        pComponente.assign(pPath, primerSlash - pPath);
-        // post
-        pResto = primerSlash + 1;
-    }
-}
-
-time_t TDriverFAT::FatTimeToTimeT(__u16 pFatDate, __u16 pFatTime)
+time_t TDriverFAT::FatTimeToTimeT(__u16 pFatDate, __u16 pFatTime) const
 {
     struct tm t = {}; // Inicializar la estructura de tiempo a ceros
 
@@ -159,7 +186,7 @@ time_t TDriverFAT::FatTimeToTimeT(__u16 pFatDate, __u16 pFatTime)
     return mktime(&t);
 }
 
-bool TDriverFAT::ParsearEntradaFAT(TDirEntryFAT* pRawEntry, TEntradaDirectorio& pEntrada){
+bool TDriverFAT::ParsearEntradaFAT(const TDirEntryFAT* pRawEntry, TEntradaDirectorio& pEntrada) const{
     // 1. ignorar entradas de Nombre de Archivo Largo (LFN)
     if (pRawEntry->FileAttributes == FAT_LFN) {return false;}
 
@@ -207,69 +234,140 @@ bool TDriverFAT::ParsearEntradaFAT(TDirEntryFAT* pRawEntry, TEntradaDirectorio&
     pEntrada.FechaUltimaModificacion = this->FatTimeToTimeT(pRawEntry->ModificationDate, pRawEntry->ModificationTime);
 
     // 7. Rellenar atributos especificos de FAT, ej:: en que cluster arranca el archivo?
-    pEntrada.DatosEspecificos.FAT.PrimerCluster = pRawEntry->StartClusterL; // para FAT12, la cadena es solo un cluster
+    pEntrada.DatosEspecificos.FAT.PrimerCluster = pRawEntry->StartClusterL;
+    // en FAT32 los 16 bits altos del cluster están en StartClusterH (en FAT12/16 es reservado)
+    if (this->DatosFS.TipoFilesystem == tfsFAT32) pEntrada.DatosEspecificos.FAT.PrimerCluster |= (unsigned)pRawEntry->StartClusterH << 16;
     
     return true; // Es una entrada válida
 }
 
 int TDriverFAT::BuscarCadenaDeClusters(unsigned int PrimerCluster, 
-                                        __u64 Longitud, // Ignoramos este parámetro
-                                        std::vector<unsigned> &Clusters)
+                                        __u64 Longitud, // Sólo se usa para reservar lugar en el vector
+                                        std::vector<unsigned> &Clusters) const
 {
     Clusters.clear(); //inicializar la lista en cero
     
     // los clusters 0 y 1 son especiales y no pueden ser parte de un archivo de usuario
     if (PrimerCluster < 2){return 0;} //error 
 
-    TDatosFSFAT& fatData = this->DatosFS.DatosEspecificos.FAT;
-    
-    // 1. Apuntar al inicio de la PRIMERA FAT
-    const unsigned char* pFAT = this->PunteroASector(fatData.SectoresReservados);
-    if (pFAT == nullptr) return -1; // Error
+    // La FAT ya está decodificada en SiguienteCluster (ver DecodificarFAT)
+    if (this->SiguienteCluster.empty()) return CODERROR_LECTURA_DISCO;
+    if (Longitud > 0) Clusters.reserve((Longitud + this->DatosFS.BytesPorCluster - 1) / this->DatosFS.BytesPorCluster);
 
-    unsigned int clusterActual = PrimerCluster;
+    const __u32 *pSiguiente = this->SiguienteCluster.data();
+    __u32 cantidadEntradas = this->SiguienteCluster.size();
+    __u32 clusterActual = PrimerCluster;
     
-    // 2. Iterar hasta encontrar el marcador de Fin de Cadena (EOC)
-    while (true)
+    // Recorrer la cadena hasta el marcador de Fin de Cadena (o un cluster fuera de la FAT)
+    while (clusterActual >= 2 && clusterActual < cantidadEntradas)
     {
-        // 3. Agregar el cluster actual a nuestra lista
+        // Agregar el cluster actual a nuestra lista
         Clusters.push_back(clusterActual);
 
-        unsigned int siguienteCluster = 0;
+        // Una cadena más larga que la cantidad de clusters del disco tiene un ciclo
+        if (Clusters.size() > (size_t)this->DatosFS.NumeroDeClusters) return CODERROR_FILESYSTEM_CORRUPTO;
 
-        // 4. Leer la siguiente entrada de la FAT12 
+        // Avanzar al siguiente cluster: una lectura del arreglo decodificado
+        clusterActual = pSiguiente[clusterActual];
+    }
 
-        // FAT12 usa entradas de 12 bits (1.5 bytes). Por ende, se levantan de memoria 3 bytes y se separa el cluster de interes por si es par o impar 
-        // calculo donde arranca este cluster
-        unsigned int offset = (clusterActual * 3) / 2; 
-        
-        // Leemos 16 bits (2 bytes) desde esa posición
-        unsigned short valor16 = *( (const unsigned short*)(pFAT + offset) );
-        
-        //Separar por la paridad del cluster:: en Little Endian
-        if (clusterActual % 2 == 0)
+    return CODERROR_NINGUNO; 
+}
+
+
+/**
+ *  Decodifica la FAT en uso una sola vez a un arreglo plano SiguienteCluster, con una entrada de 32 bits por cluster.
+ *  Las marcas de fin de cadena quedan como FAT_FIN_DE_CADENA, así el recorrido de una cadena no depende del formato de la FAT.
+ */
+int TDriverFAT::DecodificarFAT()
+{
+    TDatosFSFAT& fatData = this->DatosFS.DatosEspecificos.FAT;
+    __u64 bytesFAT = (__u64)fatData.SectoresPorFAT * this->DatosFS.BytesPorSector;
+
+    // 1. Apuntar al inicio de la FAT en uso (la tabla entera tiene que quedar contigua)
+    const unsigned char* pFAT = this->PunteroASector(fatData.SectoresReservados + (__u64)this->FATActiva * fatData.SectoresPorFAT, bytesFAT);
+    if (pFAT == nullptr) return CODERROR_LECTURA_DISCO;
+
+    // 2. Cantidad de entradas: los clusters del disco más los dos reservados, sin pasarse de lo que entra en la FAT
+    int bitsPorEntrada = (this->DatosFS.TipoFilesystem == tfsFAT12) ? 12 : (this->DatosFS.TipoFilesystem == tfsFAT16) ? 16 : 32;
+    __u64 entradas = (__u64)this->DatosFS.NumeroDeClusters + 2;
+    __u64 entradasEnFAT = (bytesFAT * 8) / bitsPorEntrada;
+    if (entradas > entradasEnFAT) entradas = entradasEnFAT;
+
+    this->SiguienteCluster.resize(entradas);
+
+    // 3. Desempaquetar con el lazo especializado para el ancho de entrada de este formato
+    switch (bitsPorEntrada)
+    {
+        case 12: DesempaquetarFAT<12>(pFAT, this->SiguienteCluster.data(), entradas); break;
+        case 16: DesempaquetarFAT<16>(pFAT, this->SiguienteCluster.data(), entradas); break;
+        default: DesempaquetarFAT<32>(pFAT, this->SiguienteCluster.data(), entradas); break;
+    }
+
+    return CODERROR_NINGUNO;
+}
+
+
+/**
+ *  Junta una cadena de clusters en extents (cluster inicial, cantidad), uniendo los clusters consecutivos.
+ */
+void TDriverFAT::ArmarExtents(const std::vector<unsigned> &Clusters, std::vector<TExtentFAT> &Extents)
+{
+    Extents.clear();
+
+    for (size_t i = 0; i < Clusters.size(); i++)
+    {
+        // Si el cluster sigue al último del extent actual, lo alarga; si no, arranca uno nuevo
+        if (!Extents.empty() && Extents.back().PrimerCluster + Extents.back().Clusters == Clusters[i])
         {
-            // Cluster PAR: tomar los 12 bits inferiores 
-            siguienteCluster = valor16 & 0x0FFF;
+            Extents.back().Clusters++;
         }
         else
         {
-            // Cluster IMPAR: tomar los 12 bits superiores
-            siguienteCluster = valor16 >> 4;
+            TExtentFAT extent;
+            extent.PrimerCluster = Clusters[i];
+            extent.Clusters = 1;
+            Extents.push_back(extent);
         }
-        
-        // EOC (End of Chain) para FAT12 
-        if (siguienteCluster >= 0x0FF8) goto fin_de_cadena;
-        
-        // 5. IF NOT :: Avanzar al siguiente cluster
-        clusterActual = siguienteCluster;
-        
-        // chequeo de nuevo:: los clusters 0 y 1 son especiales y no pueden ser parte de un archivo de usuario
-        if (clusterActual < 2) goto fin_de_cadena;
     }
+}
 
-fin_de_cadena:
-    return CODERROR_NINGUNO; 
+
+/**
+ *  Lee el sector FSInfo de FAT32 y guarda los contadores de clusters libres. Si el sector no es válido quedan en -1 (desconocidos).
+ */
+void TDriverFAT::LeerFSInfo(unsigned int NroSector)
+{
+    TDatosFSFAT& fatData = this->DatosFS.DatosEspecificos.FAT;
+    fatData.ClustersLibres = -1;
+    fatData.ProximoClusterLibre = -1;
+
+    // 0 y 0xFFFF indican que no hay FSInfo
+    if (NroSector == 0 || NroSector == 0xFFFF || NroSector >= (unsigned)fatData.SectoresReservados) return;
+
+    const TFSInfoFAT32 *fsInfo = reinterpret_cast<const TFSInfoFAT32*>(this->PunteroASector(NroSector, sizeof(TFSInfoFAT32)));
+    if (fsInfo == nullptr) return;
+    if (fsInfo->FirmaInicial != 0x41615252 || fsInfo->FirmaEstructura != 0x61417272 || fsInfo->FirmaFinal != 0xAA550000) return;
+
+    // 0xFFFFFFFF = desconocido; un valor mayor a la cantidad de clusters tampoco sirve
+    if (fsInfo->ClustersLibres <= (__u32)this->DatosFS.NumeroDeClusters) fatData.ClustersLibres = fsInfo->ClustersLibres;
+    if (fsInfo->ProximoClusterLibre >= 2 && fsInfo->ProximoClusterLibre < (__u32)this->DatosFS.NumeroDeClusters + 2) fatData.ProximoClusterLibre = fsInfo->ProximoClusterLibre;
+}
+
+
+/**
+ *  Devuelve la cadena de clusters del directorio raíz. En FAT12/16 el root no está en clusters y se marca con el cluster cero.
+ */
+int TDriverFAT::BuscarClustersRootDir(std::vector<unsigned int> &Clusters) const
+{
+    if (this->DatosFS.TipoFilesystem == tfsFAT32)
+    {
+        return this->BuscarCadenaDeClusters(this->DatosFS.DatosEspecificos.FAT.PrimerClusterRootDir, 0, Clusters);
+    }
+
+    Clusters.clear();
+    Clusters.push_back(0);
+    return CODERROR_NINGUNO;
 }
 
 
@@ -314,34 +412,59 @@ int TDriverFAT::LevantarDatosSuperbloque()
     fatData.SectoresReservados = bpb->SectoresReservados;
     fatData.CopiasFAT = bpb->CopiasFAT;
     fatData.EntradasRootDir = bpb->EntradasRootDir;
-    fatData.SectoresPorFAT = bpb->SectoresPorFAT;
+    //en FAT32 el campo de 16 bits vale cero y el tamaño de la FAT está en el BPB de FAT32
+    fatData.SectoresPorFAT = (bpb->SectoresPorFAT != 0) ? bpb->SectoresPorFAT : bpb->SectoresPorFAT32;
     fatData.SectoresOcultos = bpb->SectoresOcultos;
-    
-    // chequeo adicional, FAT12-16 tienen el root en un sector especial. c.c rechazo el FS
-    if (bpb->EntradasRootDir == 0) return CODERROR_FILESYSTEM_DESCONOCIDO;
+    if (fatData.SectoresPorFAT == 0) return CODERROR_SUPERBLOQUE_INVALIDO;
 
     this->DatosFS.BytesPorSector = bpb->BytesPorSector;
     //Calculo para numeros total de clusters
-    __u32 totalSectoresDelDisco = (bpb->TotalSectores16 != 0) ? bpb->TotalSectores16 : bpb->TotalSectores32; // nuestro FS es FAT16, nunca se usa TotalSectores32
-    __u32 bytesDelRootDir = bpb->EntradasRootDir * 32; //cada entrada del root ocupa 32 bytes
+    __u32 totalSectoresDelDisco = (bpb->TotalSectores16 != 0) ? bpb->TotalSectores16 : bpb->TotalSectores32;
+    __u32 bytesDelRootDir = bpb->EntradasRootDir * 32; //cada entrada del root ocupa 32 bytes (FAT32 no tiene root fijo)
     // division entera haciendo ceiling
     __u32 sectoresRootDir = (bytesDelRootDir + bpb->BytesPorSector - 1) / bpb->BytesPorSector; //cuanto ocupa el root
-    __u32 sectoresDeMetadata = bpb->SectoresReservados + (bpb->CopiasFAT * bpb->SectoresPorFAT) + sectoresRootDir ; // reservados + FATS + root
+    __u64 sectoresDeMetadata = bpb->SectoresReservados + ((__u64)bpb->CopiasFAT * fatData.SectoresPorFAT) + sectoresRootDir ; // reservados + FATS + root
+    if (totalSectoresDelDisco <= sectoresDeMetadata) return CODERROR_SUPERBLOQUE_INVALIDO;
     __u32 totalSectoresDeDatos = totalSectoresDelDisco - sectoresDeMetadata; //el resto es sectores de usuario
     __u32 totalClusters = totalSectoresDelDisco / bpb->SectoresPorCluster;
-    if (totalClusters >= 4085) return CODERROR_FILESYSTEM_DESCONOCIDO; //tester :: FAT12 solo puede mapear hasta 4085 sectores (2^12-1-totalSectoresDeDatos)
     fatData.TotalSectores = totalSectoresDelDisco;
     this->DatosFS.NumeroDeClusters = totalClusters;
 
+    //el formato se decide por la cantidad de clusters de datos (FAT12 < 4085 <= FAT16 < 65525 <= FAT32),
+    //salvo que el BPB sea de FAT32 (sin SectoresPorFAT de 16 bits), como hace Linux con los FAT32 chicos
+    __u32 clustersDeDatos = totalSectoresDeDatos / bpb->SectoresPorCluster;
+    if (bpb->SectoresPorFAT == 0)       this->DatosFS.TipoFilesystem = tfsFAT32;
+    else if (clustersDeDatos < 4085)    this->DatosFS.TipoFilesystem = tfsFAT12;
+    else if (clustersDeDatos < 65525)   this->DatosFS.TipoFilesystem = tfsFAT16;
+    else                                this->DatosFS.TipoFilesystem = tfsFAT32;
+
     __u32 BytesPorCluster = this->DatosFS.BytesPorSector * fatData.SectoresPorCluster;
     this->DatosFS.BytesPorCluster = BytesPorCluster;
-    // division entera haciendo ceiling
-    fatData.ClustersRootDir = (bpb->EntradasRootDir * 32 + BytesPorCluster - 1) / BytesPorCluster;
 
-    this->DatosFS.TipoFilesystem = static_cast<decltype(this->DatosFS.TipoFilesystem)>(1); //en mi enum, 1 es FAT12
+    this->FATActiva = 0;
+    if (this->DatosFS.TipoFilesystem == tfsFAT32)
+    {
+        // FAT32 no tiene root fijo: el root arranca en el cluster que dice el BPB
+        if (bpb->EntradasRootDir != 0 || bpb->ClusterRootDir < 2) return CODERROR_SUPERBLOQUE_INVALIDO;
+        fatData.ClustersRootDir = 0;
+        fatData.PrimerClusterRootDir = bpb->ClusterRootDir;
 
-    //devolver 0
-    return CODERROR_NINGUNO;
+        // si el espejado está apagado, la FAT válida es la que indican los bits 0-3
+        if ((bpb->FlagsFAT32 & 0x80) && (bpb->FlagsFAT32 & 0x0F) < bpb->CopiasFAT) this->FATActiva = bpb->FlagsFAT32 & 0x0F;
+
+        // el sector FSInfo es opcional: si las firmas no coinciden se ignora
+        this->LeerFSInfo(bpb->SectorFSInfo);
+    }
+    else
+    {
+        // FAT12-16 tienen el root en un lugar especial. Sin entradas, el FS está dañado
+        if (bpb->EntradasRootDir == 0) return CODERROR_SUPERBLOQUE_INVALIDO;
+        // division entera haciendo ceiling
+        fatData.ClustersRootDir = (bpb->EntradasRootDir * 32 + BytesPorCluster - 1) / BytesPorCluster;
+    }
+
+    //decodificar la FAT una sola vez, para que seguir cadenas sea leer un arreglo
+    return this->DecodificarFAT();
 }
 
 
@@ -362,112 +485,94 @@ int TDriverFAT::LevantarDatosSuperbloque()
 
 /**
  * ListarDirectorio (1) :: es un wrapper entre mi funcion propia de FAT y la interfaz del driver base.
- * Esta es la funcion heredada de driver_base.cpp 
+ * Esta es la funcion heredada de driver_base.cpp. La ruta la resuelve la clase base con su cache de rutas,
+ * pidiendo cada directorio con ListarDirectorioEntrada.
  */
 
 int TDriverFAT::ListarDirectorio(const char *Path, 
-                                 std::vector<TEntradaDirectorio> &Entradas) //Entradas se pasa con referencia -> vector original
+                                 std::vector<TEntradaDirectorio> &Entradas) const //Entradas se pasa con referencia -> vector original
 {
-    std::vector<unsigned int> clustersRoot; //inicializar una cadena vacia de clusters
-    
-    // 1. Limpiar el path del caracter '/'
-    const char* pathSinRoot = Path;
-    if (pathSinRoot[0] == '/'){pathSinRoot++;}
-
-    // 2. Obtener los clusters del Directorio Raíz (en FAT12 es cero)
-    clustersRoot.push_back(0); 
-    
-    // 3. Iniciar la llamada a ListarDirectorio (2):: navegadora
-    return this->ListarDirectorio(clustersRoot, pathSinRoot, Entradas);
+    return this->ListarDirectorioPorRuta(Path, Entradas);
 }
 
 /**
-/*Funcion ListarDirectorio (2):: navegadora
-*/
+ * ListarDirectorio (2) :: lista un directorio dado por su entrada (la usa la clase base para resolver rutas)
+ */
 
-int TDriverFAT::ListarDirectorio(std::vector<unsigned int> &ClustersDirActual, const char *SubDirs, std::vector<TEntradaDirectorio> &Entradas) 
+int TDriverFAT::ListarDirectorioEntrada(const TEntradaDirectorio &Directorio, std::vector<TEntradaDirectorio> &Entradas) const
 {
-    // 1. Partir el path actual 
-    std::string componenteActual;
-    std::string restoDelPath;
-    PopPathComponent(SubDirs, componenteActual, restoDelPath);
-
-    // 2. Obtener las entradas del directorio donde estamos parados
-    std::vector<TEntradaDirectorio> entradasActuales; //inicializo un estructura nueva de TEntradaDirectorio para listar mi directorio actual y los subsiguientes
-
-    // 2b. Llamo a mi funcion ListarDirectorio (3):: lectora. Le paso mi vector de entradas
-    int err = this->ListarDirectorio(ClustersDirActual, entradasActuales);
-    if (err != 0){return err;} // Error al leer el directorio
-
-    // 3. CASO BASE: chequeamos la condicion del path; si esta vacio, no queda mas recursividad
-    if (componenteActual.empty())
-    {
-        // Llegamos al directorio final. Guardamos los resultados en Entradas y salimos del bucle
-        Entradas = entradasActuales;
-        return CODERROR_NINGUNO; // CODERROR_NINGUNO
-    }
+    // 1. Obtener la cadena de clusters del directorio
+    std::vector<unsigned int> clustersDir;
+    unsigned int primerCluster = Directorio.DatosEspecificos.FAT.PrimerCluster;
+    int err;
+
+    // el root (y el ".." de un directorio que cuelga del root) está marcado con el cluster cero
+    if (primerCluster == 0) err = this->BuscarClustersRootDir(clustersDir);
+    else err = this->BuscarCadenaDeClusters(primerCluster, 0, clustersDir);
+    if (err != CODERROR_NINGUNO) return err;
+
+    // 2. Llamar a mi funcion ListarDirectorio (3):: lectora, que llena directo el vector del que llama
+    return this->ListarDirectorio(clustersDir, Entradas);
+}
 
-    // 4. CASO RECURSIVO: Buscar el siguiente subdirectorio
-    for (const TEntradaDirectorio& entrada : entradasActuales)
-    {
-        // Comparar el nombre de la entrada con el componente del path
-        if (entrada.Nombre == componenteActual.c_str())
-        {
-            // ¡Lo encontramos!
-            
-            // 4a. Verificar que SEA un directorio
-            // Usamos el flag genérico de driver_base.h
-            if (!(entrada.Flags & fedDIRECTORIO))
-            {
-                return -1; // Error: Se intentó listar un archivo
-            }
-            
-            // 4b. Obtener la cadena de clusters de este subdirectorio
-            // Usamos el cluster guardado en la unión
-            unsigned int primerCluster = entrada.DatosEspecificos.FAT.PrimerCluster;
-            std::vector<unsigned int> clustersSiguienteDir;
-            
-            err = this->BuscarCadenaDeClusters(primerCluster, 0, clustersSiguienteDir);
-            if (err != 0)
-            {
-                return err; // Error leyendo la FAT
-            }
+/**
+ * Entrada del directorio raíz: cluster cero, igual que el ".." de los directorios que cuelgan del root
+ */
+void TDriverFAT::EntradaRootDir(TEntradaDirectorio &Entrada) const
+{
+    TDriverBase::EntradaRootDir(Entrada);
+    Entrada.DatosEspecificos.FAT.PrimerCluster = 0;
+}
 
-            // 4c. Llamada recursiva con el resto del path
-            return this->ListarDirectorio(clustersSiguienteDir, restoDelPath.c_str(), Entradas);
-        }
-    }
+/**
+ * Un directorio se identifica por su primer cluster. En FAT32 el root tiene cluster propio, pero ".." lo nombra con el cero
+ */
+__u64 TDriverFAT::IdentificadorDirectorio(const TEntradaDirectorio &Directorio) const
+{
+    unsigned int primerCluster = Directorio.DatosEspecificos.FAT.PrimerCluster;
+    if (this->DatosFS.TipoFilesystem == tfsFAT32 && primerCluster == (unsigned)this->DatosFS.DatosEspecificos.FAT.PrimerClusterRootDir) return 0;
+    return primerCluster;
+}
 
-    // 5. Si salimos del 'for', es porque no encontramos el componente
-    return -1; // CODERROR_PATH_NO_ENCONTRADO
+/**
+ * FAT no distingue mayúsculas de minúsculas: se compara en minúsculas y sin espacios en los extremos
+ */
+void TDriverFAT::NormalizarNombre(TString &Nombre) const
+{
+    size_t a = 0, b = Nombre.size();
+    while (a < b && Nombre[a] == ' ') ++a;
+    while (b > a && Nombre[b-1] == ' ') --b;
+    Nombre = Nombre.substr(a, b - a);
+    for (size_t i = 0; i < Nombre.size(); ++i) Nombre[i] = tolower((unsigned char)Nombre[i]);
 }
 
 
 /**
-/*Funcion ListarDirectorio (3):: lectora
-*/
-int TDriverFAT::ListarDirectorio(std::vector<unsigned int> &Clusters, std::vector<TEntradaDirectorio> &Entradas) { 
+ * ListarDirectorio (3) :: lectora
+ */
+int TDriverFAT::ListarDirectorio(const std::vector<unsigned int> &Clusters, std::vector<TEntradaDirectorio> &Entradas) const { 
     //vaciar todas las entradas que habia hasta ahora: me interesa listar solo el DIR que me pasaron por path
     Entradas.clear();
     
-    TDirEntryFAT* rawEntry; // La struct cruda de driver_fat.h
+    const TDirEntryFAT* rawEntry; // La struct cruda de driver_fat.h
     TEntradaDirectorio nuevaEntrada; // La struct limpia de driver_base.h (generica)
     
     // un alias para los atributos de FAT
-    TDatosFSFAT& fatData = this->DatosFS.DatosEspecificos.FAT;
+    const TDatosFSFAT& fatData = this->DatosFS.DatosEspecificos.FAT;
 
-    // --- CASO 1: leer la raiz para FAT12  ---> el root esta marcado con el cluster cero
+    // --- CASO 1: leer la raiz para FAT12/16  ---> el root esta marcado con el cluster cero
     if (Clusters.size() == 1 && Clusters[0] == 0)
     {
-        // calculamos offset :: FAT12 tiene primero el sectores reservados (SPB + Reservados) + FATS 
+        // calculamos offset :: FAT12/16 tiene primero el sectores reservados (SPB + Reservados) + FATS 
         unsigned int offsetRootDirSectores = fatData.SectoresReservados + (fatData.CopiasFAT * fatData.SectoresPorFAT);
-        const unsigned char* pBufferRoot = this->PunteroASector(offsetRootDirSectores);
+        const unsigned char* pBufferRoot = this->PunteroASector(offsetRootDirSectores, fatData.EntradasRootDir * 32);
+        if (pBufferRoot == nullptr) return CODERROR_LECTURA_DISCO;
         
         // iteramos por el número fijo de entradas
         for (int i = 0; i < fatData.EntradasRootDir; i++)
         {
             // casteamos el puntero a nuestra struct cruda TDirEntryFAT
-            rawEntry = (TDirEntryFAT*)(pBufferRoot + (i * 32));
+            rawEntry = (const TDirEntryFAT*)(pBufferRoot + (i * 32));
             
             // 0x00 = fin del directorio
             if (rawEntry->Name[0] == 0x00) break;
@@ -497,7 +602,7 @@ int TDriverFAT::ListarDirectorio(std::vector<unsigned int> &Clusters, std::vecto
             for (unsigned int i = 0; i < entradasPorCluster; i++)
             {
                 // Casteamos el puntero a nuestra struct cruda TDirEntryFAT
-                rawEntry = (TDirEntryFAT*)(pBufferCluster + (i * 32));
+                rawEntry = (const TDirEntryFAT*)(pBufferCluster + (i * 32));
 
                 // 0x00 = Fin del directorio
                 if (rawEntry->Name[0] == 0x00)
@@ -550,136 +655,76 @@ fin_del_directorio:
  * OBSERVACIONES: Los valores Data y DataLen sólo devuelven valores válidos si se retorna CODERROR_NINGUNO.				*
  *																	*
  ****************************************************************************************************************************************/
-int TDriverFAT::LeerArchivo(const char *Path, unsigned char *&Data, unsigned &DataLen)
+int TDriverFAT::LeerArchivo(const char *Path, unsigned char *&Data, __u64 &DataLen) const
 {
-        // Inicializar salidas
-    Data = nullptr;
-    DataLen = 0;
-
-    // 1) Listar el directorio que contiene el archivo
-    std::vector<TEntradaDirectorio> entradas;
-
-    // Extraer nombre de archivo y directorio padre
-    std::string sPath(Path);
-    size_t pos = sPath.find_last_of('/');
-    std::string nombreArchivo = (pos == std::string::npos) ? sPath : sPath.substr(pos + 1);
-    std::string dirPath;
-
-    // Manejar casos especiales
-    if (pos == std::string::npos)
-        dirPath = ".";
-    else if (pos == 0)
-        dirPath = "/";
-    else
-        dirPath = sPath.substr(0, pos);
-
-    // 2) Listar el directorio padre
-    int err = this->ListarDirectorio(dirPath.c_str(), entradas);
-    if (err != 0)
-    {
-        // Intentar listar el directorio completo (caso raíz)
-        int err2 = this->ListarDirectorio(Path, entradas);
-        if (err2 != 0) return err2;
-        err = err2;
-    }
-
-    // 3) Buscar la entrada correspondiente
-    auto trim = [](const std::string &s)->std::string {
-        size_t a = 0, b = s.size();
-        while (a < b && s[a] == ' ') ++a;
-        while (b > a && s[b-1] == ' ') --b;
-        return s.substr(a, b - a);
-    };
-    auto lower_inplace = [](std::string &s){ for (size_t i = 0; i < s.size(); ++i) s[i] = tolower((unsigned char)s[i]); };
-
-    for (const TEntradaDirectorio& entrada : entradas)
-    {
-        std::string rawNombre = entrada.Nombre.c_str();
-        std::string rawBuscado = nombreArchivo;
-
-        std::string nombreEntrada = trim(rawNombre);
-        std::string buscado = trim(rawBuscado);
-        lower_inplace(nombreEntrada);
-        lower_inplace(buscado);
-
-        printf("Nombre Entrada: %s, Buscado: %s, normalizados: '%s' vs '%s'\n", rawNombre.c_str(), rawBuscado.c_str(), nombreEntrada.c_str(), buscado.c_str());
-
-        //Si coincide el nombre de la entrada con el buscado, procedemos a leer el archivo
-        if (nombreEntrada == buscado)
-        {
-
-            // 4) Obtener cadena de clusters del archivo
-            std::vector<unsigned int> clustersArchivo;
+    // Juntar los tramos que entrega LeerArchivoPorTramos en un único buffer alocado
+    return this->LeerArchivoCompleto(Path, Data, DataLen);
+}
 
-            //Entregar el primer cluster del archivo
-            unsigned int primerCluster = entrada.DatosEspecificos.FAT.PrimerCluster;
 
-            err = this->BuscarCadenaDeClusters(primerCluster, entrada.Bytes, clustersArchivo);
-            if (err != 0)
-            {
-                return err; // Propagar error (p. ej. lectura FAT)
-            }
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverFAT :: LeerArchivoPorTramos							*
+ *																	*
+ * OBJETIVO: Esta función lee un archivo de la imágen entregándolo de a tramos contiguos, sin copiarlo.					*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo a leer.												*
+ *	    Receptor: Función a la que se le entrega cada tramo, en orden.								*
+ *	    pParametroUsuario: Valor que se le pasa sin modificar al receptor.								*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverFAT::LeerArchivoPorTramos(const char *Path, TpReceptorTramo Receptor, void *pParametroUsuario) const
+{
+    // Con una fuente que no admite varios hilos, de a una lectura por vez (ver TDriverBase::SerializarLectura)
+    std::unique_lock<std::recursive_mutex> bloqueo = this->SerializarLectura();
 
-            // 5) Leer los datos del archivo cluster por cluster
-            unsigned int bytesLeidos = 0;
-            //Calculo los bytes por cluster -> Muchos Datos Previamente Calculados en LevantarDatosSuperbloque
-            unsigned int bytesPorCluster = this->DatosFS.BytesPorCluster;
-            //Calculo el total de bytes del archivo
-            unsigned int totalBytesArchivo = entrada.Bytes;
-            //Calculo el total de clusters a ocupar, es decir cuantos clusters necesito para leer todo el archivo
-            unsigned int TotalDeClustersAOcupar = (totalBytesArchivo + bytesPorCluster - 1) / bytesPorCluster; // ceil
-
-            // Reservamos buffer de salida directamente en ⁠ Data ⁠
-            // El tamaño es el tam del archivo, es decir totalBytesArchivo
-            DataLen = totalBytesArchivo;
-    
-            //Aloco memoria para Data
-            Data = (unsigned char*) malloc(DataLen);
-            if (!Data)
-            {
-                DataLen = 0;
-                return CODERROR_FALTA_MEMORIA;
-            }
-            //Creo una lista con los Clusters del Archivo:
-            std::vector<unsigned int> ClustersDelArchivo;
+    // 1) Buscar la entrada del archivo (la clase base resuelve la ruta con su cache)
+    TEntradaDirectorio entrada;
+    int err = this->BuscarEntrada(Path, entrada);
+    if (err != CODERROR_NINGUNO) return err;
 
-            //Hago un for para llenar el vector con los clusters del archivo
-            //Se puede optimizar con funciones ya hechas -> No se me ocurrio como
-            for (unsigned int i = 0; i < TotalDeClustersAOcupar; i++)
-            {
-                // Asigno el primer cluster del archivo
-                int clusterDondeArranca = primerCluster;
-                //Guardo en el vector el cluster del archivo todos los clusters que ocupa a partir del primer cluster
-                ClustersDelArchivo.push_back(clusterDondeArranca + i);
-            }
+    // 2) Un directorio no se puede leer como archivo
+    if (entrada.Flags & fedDIRECTORIO) return CODERROR_ARCHIVO_INEXISTENTE;
 
-            // Copiar cluster por cluster hacia Data usando offset
-            unsigned int offset = 0;
-            for (unsigned int cluster : ClustersDelArchivo)
-            {
-                //saco la data del cluster en donde esta el archivo
-                //Esto lo hago por cada cluster que tiene el archivo
-                const unsigned char* pClusterData = this->PunteroACluster(cluster);
+    // 3) Obtener cadena de clusters del archivo
+    std::vector<unsigned int> clustersArchivo;
 
-                //Calculo cuantos bytes quedan por copiar, es decir los bytes que quedan por leer del total del archivo
-                unsigned int bytesRestantes = (DataLen > offset) ? (DataLen - offset) : 0;
-                if (bytesRestantes == 0) break;
+    //Entregar el primer cluster del archivo
+    unsigned int primerCluster = entrada.DatosEspecificos.FAT.PrimerCluster;
 
-                //Calculo cuantos bytes copiar
-                unsigned int bytesACopiar = (bytesRestantes < bytesPorCluster) ? bytesRestantes : bytesPorCluster;
+    err = this->BuscarCadenaDeClusters(primerCluster, entrada.Bytes, clustersArchivo);
+    if (err != 0)
+    {
+        return err; // Propagar error (p. ej. lectura FAT)
+    }
 
-                //Voy copiando los datos al buffer Data, cluster por cluster
-                memcpy(Data + offset, pClusterData, bytesACopiar);
-                offset += bytesACopiar;
-            }
+    // 4) Juntar la cadena en extents: cada corrida de clusters físicamente contiguos es un único tramo en la imagen
+    std::vector<TExtentFAT> extents;
+    this->ArmarExtents(clustersArchivo, extents);
 
+    // 5) Entregar los datos del archivo de a tramos, apuntando directo a la imagen
+    //Calculo los bytes por cluster -> Muchos Datos Previamente Calculados en LevantarDatosSuperbloque
+    unsigned int bytesPorCluster = this->DatosFS.BytesPorCluster;
+    //Calculo el total de bytes del archivo
+    __u64 totalBytesArchivo = entrada.Bytes;
 
-            return CODERROR_NINGUNO;
-        }
+    __u64 offset = 0;
+    for (size_t i = 0; i < extents.size() && offset < totalBytesArchivo; i++)
+    {
+        //Calculo cuantos bytes entregar: el extent completo, salvo al final del archivo
+        __u64 bytesExtent = (__u64)extents[i].Clusters * bytesPorCluster;
+        if (bytesExtent > totalBytesArchivo - offset) bytesExtent = totalBytesArchivo - offset;
+
+        err = this->EmitirTramo(this->SectorDeCluster(extents[i].PrimerCluster) * this->DatosFS.BytesPorSector, bytesExtent,
+                                offset, totalBytesArchivo, Receptor, pParametroUsuario);
+        if (err != CODERROR_NINGUNO) return err;
+        offset += bytesExtent;
     }
-    
 
-    // Si no encontró el archivo dentro de las entradas
-    return CODERROR_ARCHIVO_INEXISTENTE; // o CODERROR_ARCHIVO_NO_ENCONTRADO
+    // La cadena no alcanza a cubrir el tamaño que dice la entrada de directorio
+    if (offset < totalBytesArchivo) return CODERROR_FILESYSTEM_CORRUPTO;
 
+    return CODERROR_NINGUNO;
 }
@@ -12,14 +12,18 @@
  *																	*
  * OBJETIVO: Inicializar la clase recién creada.											*
  *																	*
- * ENTRADA: DiskData: Puntero a un bloque de memoria con la imágen del disco a analizar.						*
- *	    LongitudDiskData: Tamaño, en bytes, de la imágen a analizar.								*
+ * ENTRADA: FuenteBloques: Fuente de la que leer la imágen del disco a analizar.							*
  *																	*
  * SALIDA: Nada.															*
  *																	*
  ****************************************************************************************************************************************/
-TDriverNTFS::TDriverNTFS(const unsigned char *DiskData, unsigned LongitudDiskData) : TDriverBase(DiskData, LongitudDiskData)
+TDriverNTFS::TDriverNTFS(TFuenteBloques *FuenteBloques) : TDriverBase(FuenteBloques)
 {
+OffsetParticion=0;
+RegistrosMFT=0;
+BuffersIndiceLeidos=0;
+CacheRegistros.Dimensionar(MAXIMO_REGISTROS_CACHE);
+CacheStreams.Dimensionar(MAXIMO_STREAMS_CACHE);
 }
 
 
@@ -49,14 +53,1897 @@ TDriverNTFS::~TDriverNTFS()
  *																	*
  * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores. Sino uno de los siguientes valores:				*
  *		CODERROR_SUPERBLOQUE_INVALIDO   : El superbloque está dañado o no corresponde a un disco con ningún formato.		*
- *		CODERROR_FILESYSTEM_DESCONOCIDO : El superbloque es válido, pero no corresponde a un FyleSystem soportado por esta	*
+ *		CODERROR_FILESYSTEM_DESCONOCIDO : El superbloque es válido, pero no corresponde a un FyleSystem soportado por esta	*
  *						  clase.										*
  *																	*
+ * OBSERVACIONES: Además del boot sector se levanta el registro del propio $MFT, para saber en qué clusters está cada registro.		*
+ *		  Sus runs se decodifican una sola vez, acá, y quedan en la tabla que usa LeerRegistroMFT().				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::LevantarDatosSuperbloque()
+{
+const BOOT_SECTOR			*pBoot;
+TDatosFSNTFS				&DatosNTFS = DatosFS.DatosEspecificos.NTFS;
+const FILE_RECORD_SEGMENT_HEADER	*pRegistro;
+const ATTRIBUTE_RECORD_HEADER		*pAtributo;
+std::vector<TDataRun>			Runs;
+std::vector<unsigned char>		Registro;
+TDataRun				Run;
+int					CodError, BytesPorSector, SectoresPorCluster, BytesPorRegistro, BytesPorBuffer;
+
+/* Buscar el boot sector, al comienzo de la imágen o de una partición */
+if ( (CodError=UbicarBootSector(pBoot)) != CODERROR_NINGUNO )
+	return(CodError);
+
+/* Validar la geometría */
+BytesPorSector=pBoot->BytesPerSector;
+SectoresPorCluster=pBoot->SectorsPerCluster>0x80 ? 1<<(256-pBoot->SectorsPerCluster) : pBoot->SectorsPerCluster;
+if ( (BytesPorSector<256) || (BytesPorSector>4096) || (BytesPorSector&(BytesPorSector-1)) )
+	return(CODERROR_SUPERBLOQUE_INVALIDO);
+if ( (SectoresPorCluster<=0) || (SectoresPorCluster&(SectoresPorCluster-1)) || ((__u64)BytesPorSector*SectoresPorCluster>2*1024*1024) )
+	return(CODERROR_SUPERBLOQUE_INVALIDO);
+if ( (pBoot->TotalSectors<(LONGLONG)SectoresPorCluster) || (pBoot->MftStartLcn>=pBoot->TotalSectors/SectoresPorCluster) )
+	return(CODERROR_SUPERBLOQUE_INVALIDO);
+
+/* Tamaño de los registros del $MFT y de los buffers de índice */
+BytesPorRegistro=BytesEstructura(pBoot->ClustersPerFileRecordSegment, BytesPorSector*SectoresPorCluster);
+BytesPorBuffer=BytesEstructura(pBoot->ClustersPerIndexBuffer, BytesPorSector*SectoresPorCluster);
+if ( (BytesPorRegistro<NTFS_BYTES_SECTOR_FIXUP) || (BytesPorRegistro>65536) || (BytesPorBuffer<NTFS_BYTES_SECTOR_FIXUP) || (BytesPorBuffer>65536) )
+	return(CODERROR_SUPERBLOQUE_INVALIDO);
+
+/* Datos de todo filesystem */
+DatosFS.TipoFilesystem=tfsNTFS;
+DatosFS.BytesPorSector=BytesPorSector;
+DatosFS.BytesPorCluster=BytesPorSector*SectoresPorCluster;
+DatosFS.NumeroDeClusters=pBoot->TotalSectors/SectoresPorCluster;
+
+/* Datos propios de NTFS */
+DatosNTFS.TotalSectores=pBoot->TotalSectors;
+DatosNTFS.SectoresPorCluster=SectoresPorCluster;
+DatosNTFS.ClusterMFT=pBoot->MftStartLcn;
+DatosNTFS.ClusterMFTMirror=pBoot->Mft2StartLcn;
+DatosNTFS.BytesPorFileRecordSegment=BytesPorRegistro;
+DatosNTFS.BytesPorIndexBuffer=BytesPorBuffer;
+DatosNTFS.OffsetParticionEnSectores=OffsetParticion/NTFS_BYTES_SECTOR_MBR;
+
+/* El primer registro del $MFT describe al propio $MFT: leerlo del cluster que dice el boot sector como si fuera el único */
+Run.Inicio=DatosNTFS.ClusterMFT;
+Run.Cantidad=(BytesPorRegistro+DatosFS.BytesPorCluster-1)/DatosFS.BytesPorCluster;
+Runs.assign(1, Run);
+ArmarTablaMFT(Runs);
+RegistrosMFT=1;
+Registro.resize(BytesPorRegistro);
+if ( (CodError=CopiarRegistroMFT(NTFS_ELEM_MFT, &Registro[0])) != CODERROR_NINGUNO )
+	return(CodError);
+pRegistro=(const FILE_RECORD_SEGMENT_HEADER *)&Registro[0];
+
+/* Y de ahí sacar los clusters de todos los demás */
+if ( (CodError=BuscarAtributo(pRegistro, NTFS_STRUCT_DATA, "", pAtributo)) != CODERROR_NINGUNO )
+	return(CodError==CODERROR_NO_ENCONTRADO ? CODERROR_FILESYSTEM_CORRUPTO : CodError);
+if ( (!pAtributo->NonResidentFlag) || (pAtributo->Form.NonResident.FirstVCN) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+if ( (CodError=ParsearDataRuns(pAtributo, Runs)) != CODERROR_NINGUNO )
+	return(CodError);
+ArmarTablaMFT(Runs);
+RegistrosMFT=pAtributo->Form.NonResident.RealSize/BytesPorRegistro;
+if (RegistrosMFT<=NTFS_ELEM_ROOT_DIR)
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* La tabla de mayúsculas, para buscar en los índices. Sin ella sólo se igualan las letras ASCII y se listan los directorios */
+if (CargarMayusculas()!=CODERROR_NINGUNO)
+	TablaMayusculas.clear();
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverNTFS :: UbicarBootSector							*
+ *																	*
+ * OBJETIVO: Esta función busca el boot sector del volumen NTFS.									*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si lo encontró, CODERROR_SUPERBLOQUE_INVALIDO si no.				*
+ *	   pBoot: El boot sector.													*
+ *																	*
+ * OBSERVACIONES: Si la imágen es de un disco entero el volumen está en una partición de la tabla del MBR. En ese caso todas las	*
+ *		  posiciones del volumen se corren OffsetParticion bytes.								*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::UbicarBootSector(const BOOT_SECTOR *&pBoot)
+{
+const unsigned char	*pMBR;
+const PARTITION_ENTRY	*pParticion;
+int			i;
+
+/* Ver si la imágen es directamente del volumen */
+OffsetParticion=0;
+if ( (pBoot=(const BOOT_SECTOR *)PunteroABytes(0, sizeof(BOOT_SECTOR))) == NULL )
+	return(CODERROR_SUPERBLOQUE_INVALIDO);
+if (!memcmp(pBoot->OemId, NTFS_OEM_ID, sizeof(pBoot->OemId)))
+	return(CODERROR_NINGUNO);
+
+/* Si no, buscar una partición NTFS en el MBR */
+pMBR=(const unsigned char *)pBoot;
+if (pBoot->EndOfSectorMarker!=NTFS_FIRMA_MBR)
+	return(CODERROR_SUPERBLOQUE_INVALIDO);
+for (i=0;i<NTFS_CANTIDAD_PARTICIONES;i++)
+    {
+	pParticion=(const PARTITION_ENTRY *)(pMBR+NTFS_OFFSET_TABLA_PARTICIONES)+i;
+	if ( (pParticion->SystemId!=NTFS_TIPO_PARTICION) || (!pParticion->StartingSector) )
+		continue;
+	if ( (pBoot=(const BOOT_SECTOR *)PunteroABytes((__u64)pParticion->StartingSector*NTFS_BYTES_SECTOR_MBR, sizeof(BOOT_SECTOR))) == NULL )
+		return(CODERROR_SUPERBLOQUE_INVALIDO);
+	if (!memcmp(pBoot->OemId, NTFS_OEM_ID, sizeof(pBoot->OemId)))
+	    {
+		OffsetParticion=(__u64)pParticion->StartingSector*NTFS_BYTES_SECTOR_MBR;
+		return(CODERROR_NINGUNO);
+	    }
+	pMBR=PunteroABytes(0, sizeof(BOOT_SECTOR));
+    }
+
+/* Salir */
+return(CODERROR_SUPERBLOQUE_INVALIDO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverNTFS :: BytesEstructura							*
+ *																	*
+ * OBJETIVO: Esta función calcula el tamaño de un registro del $MFT o de un buffer de índice según lo dice el boot sector.		*
+ *																	*
+ * ENTRADA: Clusters: Valor del boot sector. Si es positivo es la cantidad de clusters, si es negativo el tamaño es 2^-Clusters.	*
+ *	    BytesPorCluster: Tamaño de cluster.												*
+ *																	*
+ * SALIDA: En el nombre de la función el tamaño en bytes, o 0 si el valor no es válido.							*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::BytesEstructura(CHAR Clusters, int BytesPorCluster)
+{
+int	Bytes;
+
+/* Calcular el tamaño */
+if ((signed char)Clusters>0)
+	Bytes=(signed char)Clusters*BytesPorCluster;
+else if ((signed char)Clusters>-31)
+	Bytes=1<<-(signed char)Clusters;
+else
+	return(0);
+
+/* Tiene que ser una potencia de 2 */
+return(Bytes&(Bytes-1) ? 0 : Bytes);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverNTFS :: ArmarTablaMFT							*
+ *																	*
+ * OBJETIVO: Esta función instala los runs del $MFT y arma la tabla con la que se ubica cada registro.					*
+ *																	*
+ * ENTRADA: Runs: Los runs del atributo $DATA del $MFT.											*
+ *																	*
+ * SALIDA: Nada. Runs queda vacío, porque se pasan a RunsMFT sin copiarlos.								*
+ *																	*
+ * OBSERVACIONES: VCNsMFT[i] es el primer VCN del run i, o sea la suma de los largos de los anteriores. Con eso el run de cualquier	*
+ *		  registro se encuentra con una búsqueda binaria en vez de recorrer los runs desde el primero.				*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverNTFS::ArmarTablaMFT(std::vector<TDataRun> &Runs)
+{
+size_t	i;
+
+/* Pasar los runs y acumular sus largos */
+RunsMFT.clear();
+RunsMFT.swap(Runs);
+VCNsMFT.resize(RunsMFT.size()+1);
+VCNsMFT[0]=0;
+for (i=0;i<RunsMFT.size();i++)
+	VCNsMFT[i+1]=VCNsMFT[i]+RunsMFT[i].Cantidad;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverNTFS :: LeerRegistroMFT							*
+ *																	*
+ * OBJETIVO: Esta función devuelve un registro del $MFT con los fixups ya aplicados, buscándolo primero en el cache de registros.	*
+ *																	*
+ * ENTRADA: IndiceMFT: Número de registro.												*
+ *	    NroSecuencia: Número de secuencia que tiene que tener el registro, o 0 si no importa.					*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Registro: El registro, compartido con el cache. Mientras quien llama lo tenga sigue siendo válido, aunque se lo desaloje.	*
+ *	   pRegistro: El encabezado del registro, dentro de Registro.									*
+ *																	*
+ * OBSERVACIONES: El cache guarda los últimos MAXIMO_REGISTROS_CACHE registros usados, así recorrer rutas o listar varios directorios	*
+ *		  no vuelve a copiar y corregir los mismos registros. La imágen no cambia, así que alcanza con guardarlos por número	*
+ *		  y comparar la secuencia del registro guardado. El cache está partido en fragmentos y los registros no se		*
+ *		  modifican una vez guardados, así que varios hilos pueden leer el mismo registro a la vez.				*
+ *		  Los registros sin usar también se devuelven; le toca a quien llama mirar NTFS_REGISTRO_EN_USO.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::LeerRegistroMFT(__u64 IndiceMFT, USHORT NroSecuencia, TRegistroMFT &Registro, const FILE_RECORD_SEGMENT_HEADER *&pRegistro) const
+{
+std::shared_ptr< std::vector<unsigned char> >	pDatos;
+int						CodError;
+
+/* Si no está en el cache, copiarlo del $MFT y guardarlo */
+if (!CacheRegistros.Buscar(IndiceMFT, Registro))
+    {
+	pDatos=std::make_shared< std::vector<unsigned char> >(DatosFS.DatosEspecificos.NTFS.BytesPorFileRecordSegment);
+	if ( (CodError=CopiarRegistroMFT(IndiceMFT, &(*pDatos)[0])) != CODERROR_NINGUNO )
+		return(CodError);
+	Registro=pDatos;
+	CacheRegistros.Guardar(IndiceMFT, Registro);
+    }
+
+/* Validar la secuencia */
+pRegistro=(const FILE_RECORD_SEGMENT_HEADER *)&(*Registro)[0];
+if ( (NroSecuencia) && (pRegistro->SequenceNumber!=NroSecuencia) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverNTFS :: CopiarRegistroMFT							*
+ *																	*
+ * OBJETIVO: Esta función copia un registro del $MFT a memoria y le aplica los fixups.							*
+ *																	*
+ * ENTRADA: IndiceMFT: Número de registro.												*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   pDestino: El registro corregido (BytesPorFileRecordSegment bytes).								*
+ *																	*
+ * OBSERVACIONES: El run donde empieza el registro se busca en VCNsMFT; si el registro sigue en el run siguiente LeerDeRuns() sigue	*
+ *		  desde ahí.														*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::CopiarRegistroMFT(__u64 IndiceMFT, unsigned char *pDestino) const
+{
+int		CodError;
+unsigned	BytesPorRegistro;
+__u64		Offset;
+VCN		NroVCN;
+size_t		NroRun;
+
+/* Validar el número */
+if (IndiceMFT>=RegistrosMFT)
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Buscar el run del registro */
+BytesPorRegistro=DatosFS.DatosEspecificos.NTFS.BytesPorFileRecordSegment;
+Offset=IndiceMFT*BytesPorRegistro;
+NroVCN=Offset/DatosFS.BytesPorCluster;
+if (NroVCN>=VCNsMFT.back())
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+NroRun=BuscarRunMFT(NroVCN);
+
+/* Copiar el registro desde ese run y corregirlo */
+if ( (CodError=LeerDeRuns(RunsMFT, Offset, BytesPorRegistro, pDestino, NroRun, VCNsMFT[NroRun]*DatosFS.BytesPorCluster)) != CODERROR_NINGUNO )
+	return(CodError);
+return(ValidarRegistroMFT(pDestino));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverNTFS :: BuscarRunMFT							*
+ *																	*
+ * OBJETIVO: Esta función busca en qué run del $MFT está un cluster.									*
+ *																	*
+ * ENTRADA: NroVCN: El cluster, que tiene que ser menor a VCNsMFT.back().								*
+ *																	*
+ * SALIDA: En el nombre de la función la posición del run en RunsMFT.									*
+ *																	*
+ * OBSERVACIONES: Es el último run que empieza antes del cluster, buscado en forma binaria en VCNsMFT.					*
+ *																	*
+ ****************************************************************************************************************************************/
+size_t TDriverNTFS::BuscarRunMFT(VCN NroVCN) const
+{
+size_t	Desde, Hasta, Medio;
+
+Desde=0;
+Hasta=RunsMFT.size()-1;
+while (Desde<Hasta)
+    {
+	Medio=(Desde+Hasta+1)/2;
+	if (VCNsMFT[Medio]<=NroVCN)
+		Desde=Medio;
+	else
+		Hasta=Medio-1;
+    }
+return(Desde);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverNTFS :: ValidarRegistroMFT							*
+ *																	*
+ * OBJETIVO: Esta función corrige un registro del $MFT ya copiado a memoria y valida su encabezado.					*
+ *																	*
+ * ENTRADA: pRegistro: El registro (BytesPorFileRecordSegment bytes), tal como está en la imágen.					*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   pRegistro: El registro corregido.												*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::ValidarRegistroMFT(unsigned char *pRegistro) const
+{
+const FILE_RECORD_SEGMENT_HEADER	*pHeader;
+int					CodError;
+unsigned				BytesPorRegistro;
+
+/* Aplicar los fixups */
+BytesPorRegistro=DatosFS.DatosEspecificos.NTFS.BytesPorFileRecordSegment;
+if ( (CodError=AplicarFixups(pRegistro, BytesPorRegistro, NTFS_FIRMA_FILE)) != CODERROR_NINGUNO )
+	return(CodError);
+
+/* Validar dónde están los atributos */
+pHeader=(const FILE_RECORD_SEGMENT_HEADER *)pRegistro;
+if ( (pHeader->RealSizeOfFileRecord>BytesPorRegistro) || (pHeader->FirstAttributeOffset>=pHeader->RealSizeOfFileRecord) ||
+     (pHeader->FirstAttributeOffset&7) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverNTFS :: AplicarFixups							*
+ *																	*
+ * OBJETIVO: Esta función restaura los últimos bytes de cada sector de un bloque protegido con el update sequence array.		*
+ *																	*
+ * ENTRADA: pBloque: El bloque (un registro del $MFT o un buffer de índice), ya copiado a memoria.					*
+ *	    Bytes: Tamaño del bloque.													*
+ *	    Firma: Firma que tiene que tener el bloque ("FILE" o "INDX").								*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   pBloque: El bloque corregido.												*
+ *																	*
+ * OBSERVACIONES: Al grabar el bloque se reemplazan los dos últimos bytes de cada sector por el número de secuencia, y los originales	*
+ *		  se guardan en el arreglo. Si algún sector no tiene el número es porque quedó a medio grabar.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::AplicarFixups(unsigned char *pBloque, unsigned Bytes, const char *Firma) const
+{
+const MULTI_SECTOR_HEADER	*pHeader;
+USHORT				*pArreglo, *pFinSector;
+unsigned			Sectores, i;
+
+/* Validar la firma y el tamaño del arreglo */
+pHeader=(const MULTI_SECTOR_HEADER *)pBloque;
+Sectores=Bytes/NTFS_BYTES_SECTOR_FIXUP;
+if (memcmp(pHeader->Signature, Firma, sizeof(pHeader->Signature)))
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+if ( (pHeader->UpdateSequenceArraySize!=Sectores+1) || (pHeader->UpdateSequenceArrayOffset&1) ||
+     (pHeader->UpdateSequenceArrayOffset+2*(Sectores+1)>Bytes) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Restaurar el final de cada sector */
+pArreglo=(USHORT *)(pBloque+pHeader->UpdateSequenceArrayOffset);
+for (i=0;i<Sectores;i++)
+    {
+	pFinSector=(USHORT *)(pBloque+(i+1)*NTFS_BYTES_SECTOR_FIXUP-sizeof(USHORT));
+	if (*pFinSector!=pArreglo[0])
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	*pFinSector=pArreglo[i+1];
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverNTFS :: BuscarAtributo							*
+ *																	*
+ * OBJETIVO: Esta función busca un atributo dentro de un registro del $MFT.								*
+ *																	*
+ * ENTRADA: pRegistro: El registro, con los fixups aplicados.										*
+ *	    Tipo: Tipo de atributo (NTFS_STRUCT_*).											*
+ *	    Nombre: Nombre del atributo en UTF-8 ("" para el atributo sin nombre).							*
+ *	    Id: Número de atributo dentro del registro (AttributeId), o -1 para buscarlo por nombre.					*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si lo encontró, CODERROR_NO_ENCONTRADO si no está, caso contrario el código	*
+ *	   de error.															*
+ *	   pAtributo: El atributo, dentro del registro.											*
+ *																	*
+ * OBSERVACIONES: Los nombres de los atributos, como los de los archivos, no distinguen mayúsculas de minúsculas.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::BuscarAtributo(const FILE_RECORD_SEGMENT_HEADER *pRegistro, ATTRIBUTE_TYPE_CODE Tipo, const char *Nombre,
+				const ATTRIBUTE_RECORD_HEADER *&pAtributo, int Id) const
+{
+unsigned	Offset;
+TString		NombreAtributo, Buscado;
+
+/* Recorrer los atributos, que terminan con una marca y están ordenados por tipo */
+for (Offset=pRegistro->FirstAttributeOffset;Offset+2*sizeof(ULONG)<=pRegistro->RealSizeOfFileRecord;Offset+=pAtributo->RecordLength)
+    {
+	pAtributo=(const ATTRIBUTE_RECORD_HEADER *)((const unsigned char *)pRegistro+Offset);
+	if ( (pAtributo->TypeCode==NTFS_STRUCT_END) || (pAtributo->TypeCode>Tipo) )
+		break;
+	if ( (pAtributo->RecordLength<offsetof(ATTRIBUTE_RECORD_HEADER, Form.Resident.Padding)) || (pAtributo->RecordLength&7) ||
+	     (Offset+pAtributo->RecordLength>pRegistro->RealSizeOfFileRecord) ||
+	     ((unsigned)pAtributo->NameOffset+2*pAtributo->NameLength>pAtributo->RecordLength) )
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	if (pAtributo->TypeCode!=Tipo)
+		continue;
+
+	/* Es del tipo buscado, comparar el número o el nombre */
+	if (Id>=0)
+	    {
+		if (pAtributo->AttributeId==Id)
+			return(CODERROR_NINGUNO);
+		continue;
+	    }
+	NombreUTF8((const unsigned char *)pAtributo+pAtributo->NameOffset, pAtributo->NameLength, NombreAtributo);
+	if (NombreAtributo==Nombre)
+		return(CODERROR_NINGUNO);
+	if ( (*Nombre) && (pAtributo->NameLength) )
+	    {
+		if (Buscado.empty())
+		    {
+			Buscado=Nombre;
+			NormalizarNombre(Buscado);
+		    }
+		NormalizarNombre(NombreAtributo);
+		if (NombreAtributo==Buscado)
+			return(CODERROR_NINGUNO);
+	    }
+    }
+
+/* Salir */
+return(CODERROR_NO_ENCONTRADO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverNTFS :: ValorResidente							*
+ *																	*
+ * OBJETIVO: Esta función devuelve el valor de un atributo residente.									*
+ *																	*
+ * ENTRADA: pAtributo: El atributo, dentro de un registro ya validado.									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   pValor: El valor, dentro del registro.											*
+ *	   Bytes: Tamaño del valor.													*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::ValorResidente(const ATTRIBUTE_RECORD_HEADER *pAtributo, const unsigned char *&pValor, __u32 &Bytes) const
+{
+/* El valor tiene que estar dentro del atributo */
+if ( (pAtributo->NonResidentFlag) || (pAtributo->RecordLength<sizeof(pAtributo->Form.Resident)+offsetof(ATTRIBUTE_RECORD_HEADER, Form)) ||
+     ((__u64)pAtributo->Form.Resident.ValueOffset+pAtributo->Form.Resident.ValueLength>pAtributo->RecordLength) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Devolverlo */
+pValor=(const unsigned char *)pAtributo+pAtributo->Form.Resident.ValueOffset;
+Bytes=pAtributo->Form.Resident.ValueLength;
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverNTFS :: ParsearDataRuns							*
+ *																	*
+ * OBJETIVO: Esta función decodifica los data runs de un atributo no residente.								*
+ *																	*
+ * ENTRADA: pAtributo: El atributo, dentro de un registro ya validado.									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Runs: Los runs, en orden de VCN a partir de FirstVCN. Los dispersos tienen Inicio=NTFS_LCN_DISPERSO.				*
+ *																	*
+ * OBSERVACIONES: En el disco cada run tiene el largo y la distancia con signo al LCN del run anterior, codificados con la cantidad	*
+ *		  de bytes que dice su primer byte. Un run sin distancia no tiene clusters asignados.					*
+ *		  Los runs se decodifican una sola vez por atributo; después se recorren en memoria.					*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::ParsearDataRuns(const ATTRIBUTE_RECORD_HEADER *pAtributo, std::vector<TDataRun> &Runs) const
+{
+const unsigned char	*p, *pFin;
+const DATA_RUN		*pRun;
+__u64			Clusters;
+__le64			Distancia;
+LCN			Actual;
+TDataRun		Run;
+int			i;
+
+/* Inicializar salidas */
+Runs.clear();
+
+/* Los runs van desde DataRunsOffset hasta el final del atributo, o hasta un byte en cero */
+if ( (!pAtributo->NonResidentFlag) || (pAtributo->RecordLength<offsetof(ATTRIBUTE_RECORD_HEADER, Form.NonResident.InitializedSize)+sizeof(LONGLONG)) ||
+     (pAtributo->Form.NonResident.DataRunsOffset>pAtributo->RecordLength) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+p=(const unsigned char *)pAtributo+pAtributo->Form.NonResident.DataRunsOffset;
+pFin=(const unsigned char *)pAtributo+pAtributo->RecordLength;
+Actual=0;
+while ( (p<pFin) && (*p) )
+    {
+	/* Validar los tamaños */
+	pRun=(const DATA_RUN *)p++;
+	if ( (!pRun->Length) || (pRun->Length>8) || (pRun->Start>8) || (p+pRun->Length+pRun->Start>pFin) )
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+
+	/* Largo, sin signo */
+	Clusters=0;
+	for (i=pRun->Length-1;i>=0;i--)
+		Clusters=Clusters<<8 | p[i];
+	p+=pRun->Length;
+
+	/* Distancia al run anterior, con signo */
+	if (!pRun->Start)
+		Run.Inicio=NTFS_LCN_DISPERSO;
+	else
+	    {
+		Distancia=(signed char)p[pRun->Start-1];
+		for (i=pRun->Start-2;i>=0;i--)
+			Distancia=Distancia*256 + p[i];
+		Actual+=Distancia;
+		if ( (Actual>=(__u64)DatosFS.NumeroDeClusters) || (Clusters>(__u64)DatosFS.NumeroDeClusters-Actual) )
+			return(CODERROR_FILESYSTEM_CORRUPTO);
+		Run.Inicio=Actual;
+		p+=pRun->Start;
+	    }
+
+	/* Agregarlo, partido si no entra en Cantidad */
+	while (Clusters)
+	    {
+		Run.Cantidad=Clusters<0x80000000ULL ? Clusters : 0x80000000U;
+		Runs.push_back(Run);
+		Clusters-=Run.Cantidad;
+		if (Run.Inicio!=NTFS_LCN_DISPERSO)
+			Run.Inicio+=Run.Cantidad;
+	    }
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverNTFS :: LeerDeRuns							*
+ *																	*
+ * OBJETIVO: Esta función copia un rango de bytes de un atributo no residente a memoria.						*
+ *																	*
+ * ENTRADA: Runs: Los runs del atributo.												*
+ *	    Offset: Posición del rango dentro del atributo.										*
+ *	    Bytes: Longitud del rango.													*
+ *	    PrimerRun, InicioPrimerRun: Run desde el que buscar y su posición dentro del atributo, si quien llama ya sabe que el rango	*
+ *					empieza ahí o más adelante.									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   pDestino: Los datos.														*
+ *																	*
+ * OBSERVACIONES: Se usa para los registros del $MFT y los buffers de índice, que pueden quedar partidos entre dos runs.		*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::LeerDeRuns(const std::vector<TDataRun> &Runs, __u64 Offset, __u64 Bytes, unsigned char *pDestino, size_t PrimerRun,
+			    __u64 InicioPrimerRun) const
+{
+const unsigned char	*pOrigen;
+__u64			InicioRun, BytesRun, Parte;
+size_t			i;
+
+/* Buscar el run donde empieza el rango y copiar desde ahí */
+InicioRun=InicioPrimerRun;
+for (i=PrimerRun;(i<Runs.size()) && (Bytes);i++)
+    {
+	BytesRun=(__u64)Runs[i].Cantidad*DatosFS.BytesPorCluster;
+	if (Offset>=InicioRun+BytesRun)
+	    {
+		InicioRun+=BytesRun;
+		continue;
+	    }
+
+	/* Copiar la parte del rango que cae en este run */
+	Parte=min(Bytes, InicioRun+BytesRun-Offset);
+	if (Runs[i].Inicio==NTFS_LCN_DISPERSO)
+		memset(pDestino, 0, Parte);
+	else
+	    {
+		if ( (pOrigen=PunteroABytes(OffsetParticion+Runs[i].Inicio*DatosFS.BytesPorCluster+Offset-InicioRun, Parte)) == NULL )
+			return(CODERROR_LECTURA_DISCO);
+		memcpy(pDestino, pOrigen, Parte);
+	    }
+	pDestino+=Parte;
+	Offset+=Parte;
+	Bytes-=Parte;
+	InicioRun+=BytesRun;
+    }
+
+/* Salir */
+return(Bytes ? CODERROR_FILESYSTEM_CORRUPTO : CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverNTFS :: SepararStream							*
+ *																	*
+ * OBJETIVO: Esta función separa de una ruta el nombre del stream que se quiere leer.							*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo, con el stream a continuación del último nombre (archivo:stream o archivo:stream:$DATA).		*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, CODERROR_ARCHIVO_INEXISTENTE si el tipo no es $DATA.		*
+ *	   Ruta: Ruta al archivo, sin el stream.											*
+ *	   Stream: Nombre del stream, vacío para el stream principal.									*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::SepararStream(const char *Path, TString &Ruta, TString &Stream)
+{
+const char	*pNombre, *pSeparador, *pTipo;
+
+/* El stream va en el último nombre de la ruta */
+pNombre=strrchr(Path, '/');
+pNombre=pNombre ? pNombre+1 : Path;
+if ( (pSeparador=strchr(pNombre, NTFS_SEPARADOR_STREAM)) == NULL )
+    {
+	Ruta=Path;
+	Stream.clear();
+	return(CODERROR_NINGUNO);
+    }
+Ruta.assign(Path, pSeparador-Path);
+
+/* Después del nombre del stream puede venir su tipo */
+pSeparador++;
+if ( (pTipo=strchr(pSeparador, NTFS_SEPARADOR_STREAM)) == NULL )
+    {
+	Stream=pSeparador;
+	return(CODERROR_NINGUNO);
+    }
+Stream.assign(pSeparador, pTipo-pSeparador);
+return(strcasecmp(pTipo+1, NTFS_TIPO_STREAM) ? CODERROR_ARCHIVO_INEXISTENTE : CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverNTFS :: CargarStream							*
+ *																	*
+ * OBJETIVO: Esta función devuelve un stream de un archivo listo para leer, buscándolo primero en el cache de streams.			*
+ *																	*
+ * ENTRADA: IndiceMFT: Registro base del archivo.											*
+ *	    NroSecuencia: Número de secuencia que tiene que tener el registro, o 0 si no importa.					*
+ *	    Nombre: Nombre del stream, ya normalizado con NormalizarNombre() ("" para el principal).					*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, CODERROR_ARCHIVO_INEXISTENTE si el archivo no tiene ese	*
+ *	   stream, caso contrario el código de error.											*
+ *	   pStream: El stream, compartido con el cache. Sigue siendo válido aunque se lo desaloje mientras quien llama lo tenga.	*
+ *																	*
+ * OBSERVACIONES: El cache guarda los últimos MAXIMO_STREAMS_CACHE streams usados con sus runs ya decodificados, así leer otra vez	*
+ *		  un stream, o varios del mismo archivo, no vuelve a recorrer sus registros ni a decodificar sus runs. El stream se	*
+ *		  arma fuera del cache y se guarda ya completo, así otro hilo nunca ve uno a medio armar.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::CargarStream(__u64 IndiceMFT, USHORT NroSecuencia, const TString &Nombre, std::shared_ptr<const TStreamNTFS> &pStream) const
+{
+TRegistroMFT				Registro;
+const FILE_RECORD_SEGMENT_HEADER	*pRegistro;
+std::shared_ptr<TStreamNTFS>		pNuevo;
+TString					Clave;
+int					CodError;
+
+/* Si está en el cache, devolverlo */
+Clave.assign((const char *)&IndiceMFT, sizeof(IndiceMFT));
+Clave.append(Nombre);
+if (CacheStreams.Buscar(Clave, pStream))
+	return( (NroSecuencia) && (pStream->NroSecuencia!=NroSecuencia) ? CODERROR_FILESYSTEM_CORRUPTO : CODERROR_NINGUNO );
+
+/* Si no, levantar el registro base */
+if ( (CodError=LeerRegistroMFT(IndiceMFT, NroSecuencia, Registro, pRegistro)) != CODERROR_NINGUNO )
+	return(CodError);
+if (!(pRegistro->Flags&NTFS_REGISTRO_EN_USO))
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Armar el stream y guardarlo en el cache */
+pNuevo=std::make_shared<TStreamNTFS>();
+pNuevo->NroSecuencia=pRegistro->SequenceNumber;
+pNuevo->Residente=false;
+pNuevo->BytesArchivo=pNuevo->BytesInicializados=0;
+pNuevo->Flags=0;
+pNuevo->UnidadCompresion=0;
+if ( (CodError=ArmarStream(pRegistro, Nombre, *pNuevo)) != CODERROR_NINGUNO )
+	return(CodError);
+pStream=pNuevo;
+CacheStreams.Guardar(Clave, pStream);
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverNTFS :: ArmarStream							*
+ *																	*
+ * OBJETIVO: Esta función junta los datos de un atributo $DATA a partir del registro base del archivo.					*
+ *																	*
+ * ENTRADA: pRegistro: Registro base del archivo.											*
+ *	    Nombre: Nombre del stream, ya normalizado.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, CODERROR_ARCHIVO_INEXISTENTE si el archivo no tiene ese	*
+ *	   stream con nombre, caso contrario el código de error.									*
+ *	   Stream: El stream (vacío si el archivo no tiene stream principal).								*
+ *																	*
+ * OBSERVACIONES: Si los atributos no entran en el registro base, éste tiene un $ATTRIBUTE_LIST que dice en qué registro está cada	*
+ *		  uno, y un $DATA con muchos runs puede quedar partido en fragmentos en distintos registros.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::ArmarStream(const FILE_RECORD_SEGMENT_HEADER *pRegistro, const TString &Nombre, TStreamNTFS &Stream) const
+{
+int				CodError;
+const ATTRIBUTE_RECORD_HEADER	*pAtributo;
+
+/* Con lista de atributos, seguirla */
+if ( (CodError=BuscarAtributo(pRegistro, NTFS_STRUCT_ATTRIBUTE_LIST, "", pAtributo)) == CODERROR_NINGUNO )
+	return(ArmarStreamFragmentado(pAtributo, Nombre, Stream));
+if (CodError!=CODERROR_NO_ENCONTRADO)
+	return(CodError);
+
+/* Sin lista, es un único atributo en el registro base */
+if ( (CodError=BuscarAtributo(pRegistro, NTFS_STRUCT_DATA, Nombre.c_str(), pAtributo)) != CODERROR_NINGUNO )
+    {
+	if (CodError==CODERROR_NO_ENCONTRADO)
+		return(StreamAusente(Nombre, Stream));
+	return(CodError);
+    }
+return(AgregarFragmento(pAtributo, Stream));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverNTFS :: ArmarStreamFragmentado							*
+ *																	*
+ * OBJETIVO: Esta función junta los fragmentos de un atributo $DATA siguiendo la lista de atributos del archivo.			*
+ *																	*
+ * ENTRADA: pLista: El atributo $ATTRIBUTE_LIST del registro base.									*
+ *	    Nombre: Nombre del stream, ya normalizado.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, CODERROR_ARCHIVO_INEXISTENTE si el archivo no tiene ese	*
+ *	   stream con nombre, caso contrario el código de error.									*
+ *	   Stream: El stream (vacío si el archivo no tiene stream principal).								*
+ *																	*
+ * OBSERVACIONES: La lista tiene una entrada por atributo (o por fragmento), ordenadas por tipo, nombre y primer VCN, con el registro	*
+ *		  donde está y su número dentro de ese registro. La lista se copia antes de leer los otros registros, porque puede	*
+ *		  no ser residente.													*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::ArmarStreamFragmentado(const ATTRIBUTE_RECORD_HEADER *pLista, const TString &Nombre, TStreamNTFS &Stream) const
+{
+int					CodError;
+const unsigned char			*pValor;
+__u32					Bytes;
+std::vector<unsigned char>		Lista;
+std::vector<TDataRun>			Runs;
+const ATTRIBUTE_LIST_ENTRY		*pEntrada;
+TRegistroMFT				Registro;
+const FILE_RECORD_SEGMENT_HEADER	*pRegistro;
+const ATTRIBUTE_RECORD_HEADER		*pAtributo;
+TString					NombreEntrada;
+size_t					Offset;
+bool					Encontrado;
+
+/* Copiar la lista */
+if (!pLista->NonResidentFlag)
+    {
+	if ( (CodError=ValorResidente(pLista, pValor, Bytes)) != CODERROR_NINGUNO )
+		return(CodError);
+	Lista.assign(pValor, pValor+Bytes);
+    }
+else
+    {
+	/* Lo que pasa de InitializedSize se lee como ceros */
+	if ( (pLista->Form.NonResident.RealSize>NTFS_MAXIMO_BYTES_UNIDAD) ||
+	     (pLista->Form.NonResident.RealSize>pLista->Form.NonResident.AllocatedLength) ||
+	     (pLista->Form.NonResident.InitializedSize>pLista->Form.NonResident.RealSize) )
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	if ( (CodError=ParsearDataRuns(pLista, Runs)) != CODERROR_NINGUNO )
+		return(CodError);
+	Lista.assign(pLista->Form.NonResident.RealSize, 0);
+	if ( (pLista->Form.NonResident.InitializedSize) &&
+	     ((CodError=LeerDeRuns(Runs, 0, pLista->Form.NonResident.InitializedSize, &Lista[0])) != CODERROR_NINGUNO) )
+		return(CodError);
+    }
+
+/* Recorrer las entradas del stream buscado, que vienen en orden de VCN */
+Encontrado=false;
+for (Offset=0;Offset+offsetof(ATTRIBUTE_LIST_ENTRY, AttributeName)<=Lista.size();Offset+=pEntrada->RecordLength)
+    {
+	pEntrada=(const ATTRIBUTE_LIST_ENTRY *)&Lista[Offset];
+	if ( (pEntrada->RecordLength<offsetof(ATTRIBUTE_LIST_ENTRY, AttributeName)) || (Offset+pEntrada->RecordLength>Lista.size()) ||
+	     (pEntrada->AttributeNameOffset+2*pEntrada->AttributeNameLength>pEntrada->RecordLength) )
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	if (pEntrada->TypeCode!=NTFS_STRUCT_DATA)
+		continue;
+	NombreUTF8((const unsigned char *)pEntrada+pEntrada->AttributeNameOffset, pEntrada->AttributeNameLength, NombreEntrada);
+	NormalizarNombre(NombreEntrada);
+	if (NombreEntrada!=Nombre)
+		continue;
+
+	/* Levantar el registro del fragmento y buscarlo ahí por su número */
+	if ( (CodError=LeerRegistroMFT(pEntrada->SegmentReference.MFTIndex, pEntrada->SegmentReference.Sequence, Registro, pRegistro)) != CODERROR_NINGUNO )
+		return(CodError);
+	if (!(pRegistro->Flags&NTFS_REGISTRO_EN_USO))
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	if ( (CodError=BuscarAtributo(pRegistro, NTFS_STRUCT_DATA, "", pAtributo, pEntrada->AttributeId)) != CODERROR_NINGUNO )
+		return(CodError==CODERROR_NO_ENCONTRADO ? CODERROR_FILESYSTEM_CORRUPTO : CodError);
+	if ( (CodError=AgregarFragmento(pAtributo, Stream)) != CODERROR_NINGUNO )
+		return(CodError);
+	Encontrado=true;
+    }
+
+/* Salir */
+if (!Encontrado)
+	return(StreamAusente(Nombre, Stream));
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverNTFS :: StreamAusente							*
+ *																	*
+ * OBJETIVO: Esta función resuelve qué pasa cuando el archivo no tiene el atributo $DATA buscado.					*
+ *																	*
+ * ENTRADA: Nombre: Nombre del stream, ya normalizado.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO para el stream principal, CODERROR_ARCHIVO_INEXISTENTE para uno con nombre.	*
+ *	   Stream: Vacío, si es el principal.												*
+ *																	*
+ * OBSERVACIONES: No todo archivo tiene stream principal: los de sistema como $Secure guardan todo en índices y streams con		*
+ *		  nombre. Ese caso se lee como un archivo vacío y no como un filesystem corrupto.					*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::StreamAusente(const TString &Nombre, TStreamNTFS &Stream)
+{
+if (!Nombre.empty())
+	return(CODERROR_ARCHIVO_INEXISTENTE);
+Stream.Residente=true;
+Stream.Valor.clear();
+Stream.BytesArchivo=Stream.BytesInicializados=0;
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverNTFS :: AgregarFragmento							*
+ *																	*
+ * OBJETIVO: Esta función agrega al stream un fragmento de su atributo $DATA.								*
+ *																	*
+ * ENTRADA: pAtributo: El fragmento, dentro de un registro leído con LeerRegistroMFT().							*
+ *	    Stream: El stream armado hasta ahora.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Stream: El stream con los datos del fragmento agregados.									*
+ *																	*
+ * OBSERVACIONES: Cada fragmento tiene sus propios runs, que empiezan en su FirstVCN. Los tamaños y la compresión sólo son válidos	*
+ *		  en el primero. Un atributo residente no se fragmenta.									*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::AgregarFragmento(const ATTRIBUTE_RECORD_HEADER *pAtributo, TStreamNTFS &Stream) const
+{
+int			CodError;
+const unsigned char	*pValor;
+__u32			Bytes;
+std::vector<TDataRun>	Runs;
+VCN			Siguiente;
+size_t			i;
+
+/* Residente: es el único fragmento */
+if (!pAtributo->NonResidentFlag)
+    {
+	if ( (Stream.Residente) || (!Stream.Runs.empty()) )
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	if ( (CodError=ValorResidente(pAtributo, pValor, Bytes)) != CODERROR_NINGUNO )
+		return(CodError);
+	Stream.Residente=true;
+	Stream.Valor.assign(pValor, pValor+Bytes);
+	Stream.BytesArchivo=Stream.BytesInicializados=Bytes;
+	return(CODERROR_NINGUNO);
+    }
+
+/* No residente: tiene que seguir donde terminó el fragmento anterior */
+if (Stream.Residente)
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+for (i=0,Siguiente=0;i<Stream.Runs.size();i++)
+	Siguiente+=Stream.Runs[i].Cantidad;
+if (pAtributo->Form.NonResident.FirstVCN!=Siguiente)
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+if (!Siguiente)
+    {
+	Stream.BytesArchivo=pAtributo->Form.NonResident.RealSize;
+	Stream.BytesInicializados=pAtributo->Form.NonResident.InitializedSize;
+	Stream.Flags=pAtributo->Flags;
+	Stream.UnidadCompresion=pAtributo->Form.NonResident.CompressionUnitSize;
+    }
+
+/* Agregar sus runs */
+if ( (CodError=ParsearDataRuns(pAtributo, Runs)) != CODERROR_NINGUNO )
+	return(CodError);
+Stream.Runs.insert(Stream.Runs.end(), Runs.begin(), Runs.end());
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverNTFS :: EmitirStream							*
+ *																	*
+ * OBJETIVO: Esta función entrega los datos de un stream al receptor, de a tramos.							*
+ *																	*
+ * ENTRADA: Stream: El stream.														*
+ *	    Receptor, pParametroUsuario: Ver LeerArchivoPorTramos().									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Un stream residente se entrega desde la copia del valor, que se tomó del registro ya corregido y no de la imágen,	*
+ *		  porque puede cruzar el final de un sector que tiene el número de secuencia en vez de los datos.			*
+ *		  En uno comprimido UnidadCompresion es el logaritmo en base 2 de los clusters de cada unidad.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::EmitirStream(const TStreamNTFS &Stream, TpReceptorTramo Receptor, void *pParametroUsuario) const
+{
+TTramoArchivo	Tramo;
+
+/* Residente: un único tramo */
+if (Stream.Residente)
+    {
+	if (Stream.Valor.empty())
+		return(CODERROR_NINGUNO);
+	Tramo.Datos=&Stream.Valor[0];
+	Tramo.Bytes=Tramo.BytesArchivo=Stream.Valor.size();
+	Tramo.Offset=0;
+	return(Receptor(Tramo, pParametroUsuario));
+    }
+
+/* No residente: de a runs */
+if (!(Stream.Flags&NTFS_ATRIBUTO_COMPRIMIDO))
+	return(EmitirRuns(Stream.Runs, Stream.BytesArchivo, Stream.BytesInicializados, Receptor, pParametroUsuario));
+
+/* Comprimido: de a unidades de compresión, que tienen que ser de bloques LZNT1 enteros */
+if ((Stream.Flags&NTFS_ATRIBUTO_COMPRIMIDO)!=NTFS_COMPRESION_LZNT1)
+	return(CODERROR_NO_IMPLEMENTADO);
+if ( (!Stream.UnidadCompresion) || (Stream.UnidadCompresion>16) ||
+     (((__u64)DatosFS.BytesPorCluster<<Stream.UnidadCompresion)>NTFS_MAXIMO_BYTES_UNIDAD) ||
+     (((__u64)DatosFS.BytesPorCluster<<Stream.UnidadCompresion)%NTFS_BYTES_BLOQUE_LZNT1) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+return(EmitirRunsComprimidos(Stream.Runs, 1<<Stream.UnidadCompresion, Stream.BytesArchivo, Stream.BytesInicializados, Receptor,
+			     pParametroUsuario));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverNTFS :: EmitirRuns							*
+ *																	*
+ * OBJETIVO: Esta función entrega los datos de un atributo no residente al receptor, un tramo por cada run.				*
+ *																	*
+ * ENTRADA: Runs: Los runs del atributo.												*
+ *	    BytesArchivo: Tamaño del atributo.												*
+ *	    BytesInicializados: Hasta dónde tiene datos válidos el atributo; lo que sigue se lee como ceros.				*
+ *	    Receptor, pParametroUsuario: Ver LeerArchivoPorTramos().									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Los runs dispersos se entregan como ceros, sin leer la imágen.							*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::EmitirRuns(const std::vector<TDataRun> &Runs, __u64 BytesArchivo, __u64 BytesInicializados, TpReceptorTramo Receptor,
+			    void *pParametroUsuario) const
+{
+int		CodError;
+__u64		Offset, Bytes, BytesDisco;
+size_t		i;
+
+/* Recorrer los runs en orden */
+Offset=0;
+for (i=0;(i<Runs.size()) && (Offset<BytesArchivo);i++)
+    {
+	/* Cortar el run al final del archivo, y la parte con datos en lo inicializado */
+	Bytes=min((__u64)Runs[i].Cantidad*DatosFS.BytesPorCluster, BytesArchivo-Offset);
+	BytesDisco=Offset<BytesInicializados ? min(Bytes, BytesInicializados-Offset) : 0;
+	if (Runs[i].Inicio==NTFS_LCN_DISPERSO)
+		BytesDisco=0;
+
+	/* Entregar los datos y después los ceros */
+	if ( (BytesDisco) &&
+	     ((CodError=EmitirTramo(OffsetParticion+Runs[i].Inicio*DatosFS.BytesPorCluster, BytesDisco, Offset, BytesArchivo, Receptor, pParametroUsuario)) != CODERROR_NINGUNO) )
+		return(CodError);
+	if ( (Bytes>BytesDisco) &&
+	     ((CodError=EmitirCeros(Bytes-BytesDisco, Offset+BytesDisco, BytesArchivo, Receptor, pParametroUsuario)) != CODERROR_NINGUNO) )
+		return(CodError);
+	Offset+=Bytes;
+    }
+
+/* Los runs tienen que cubrir todo el archivo */
+return(Offset<BytesArchivo ? CODERROR_FILESYSTEM_CORRUPTO : CODERROR_NINGUNO);
+}
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverNTFS :: EmitirRunsComprimidos							*
+ *																	*
+ * OBJETIVO: Esta función entrega los datos de un atributo comprimido al receptor, descomprimiendo de a una unidad de compresión.	*
+ *																	*
+ * ENTRADA: Runs: Los runs del atributo.												*
+ *	    ClustersUnidad: Clusters de cada unidad de compresión.									*
+ *	    BytesArchivo, BytesInicializados, Receptor, pParametroUsuario: Ver EmitirRuns().						*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Cada unidad se guarda de una de tres formas: sin clusters asignados es un hueco, con todos asignados está sin		*
+ *		  comprimir, y con algunos asignados seguidos de un run disperso está comprimida con LZNT1 en esos clusters.		*
+ *		  Sólo los datos comprimidos se copian a memoria; las unidades sin comprimir se entregan directo de la imágen y los	*
+ *		  huecos sin leerla.													*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::EmitirRunsComprimidos(const std::vector<TDataRun> &Runs, unsigned ClustersUnidad, __u64 BytesArchivo,
+				       __u64 BytesInicializados, TpReceptorTramo Receptor, void *pParametroUsuario) const
+{
+int				CodError;
+std::vector<TDataRun>		Piezas;
+std::vector<unsigned char>	Comprimido, Descomprimido;
+const unsigned char		*pOrigen;
+TTramoArchivo			Tramo;
+TDataRun			Pieza;
+__u64				Offset, BytesUnidad, Bytes, BytesDatos, Hechos, Parte;
+unsigned			Faltan, Asignados, Clusters, UsadosRun;
+size_t				i, j;
+bool				HuboDispersos;
+
+/* Recorrer el archivo de a unidades, avanzando sobre los runs */
+BytesUnidad=(__u64)ClustersUnidad*DatosFS.BytesPorCluster;
+Tramo.BytesArchivo=BytesArchivo;
+i=0;
+UsadosRun=0;
+for (Offset=0;Offset<BytesArchivo;Offset+=Bytes)
+    {
+	/* Juntar los clusters de la unidad: primero los asignados y después los dispersos */
+	Piezas.clear();
+	Asignados=0;
+	HuboDispersos=false;
+	for (Faltan=ClustersUnidad;(Faltan) && (i<Runs.size());Faltan-=Clusters)
+	    {
+		Clusters=min(Runs[i].Cantidad-UsadosRun, Faltan);
+		if (Runs[i].Inicio==NTFS_LCN_DISPERSO)
+			HuboDispersos=true;
+		else if (HuboDispersos)
+			return(CODERROR_FILESYSTEM_CORRUPTO);
+		else
+		    {
+			Pieza.Inicio=Runs[i].Inicio+UsadosRun;
+			Pieza.Cantidad=Clusters;
+			Piezas.push_back(Pieza);
+			Asignados+=Clusters;
+		    }
+		if ( (UsadosRun+=Clusters) == Runs[i].Cantidad )
+		    {
+			i++;
+			UsadosRun=0;
+		    }
+	    }
+	if (Faltan)
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+
+	/* Parte de la unidad que es del archivo, y parte de esa que tiene datos */
+	Bytes=min(BytesUnidad, BytesArchivo-Offset);
+	BytesDatos=Offset<BytesInicializados ? min(Bytes, BytesInicializados-Offset) : 0;
+	if (!Asignados)
+		BytesDatos=0;
+
+	if ( (BytesDatos) && (Asignados==ClustersUnidad) )
+	    {
+		/* Unidad sin comprimir: directo de la imágen */
+		for (j=0,Hechos=0;(j<Piezas.size()) && (Hechos<BytesDatos);j++,Hechos+=Parte)
+		    {
+			Parte=min((__u64)Piezas[j].Cantidad*DatosFS.BytesPorCluster, BytesDatos-Hechos);
+			if ( (CodError=EmitirTramo(OffsetParticion+Piezas[j].Inicio*DatosFS.BytesPorCluster, Parte, Offset+Hechos, BytesArchivo,
+						   Receptor, pParametroUsuario)) != CODERROR_NINGUNO )
+				return(CodError);
+		    }
+	    }
+	else if (BytesDatos)
+	    {
+		/* Unidad comprimida: copiar sus clusters, descomprimirla y entregarla desde memoria */
+		Comprimido.resize((size_t)Asignados*DatosFS.BytesPorCluster);
+		Descomprimido.resize(BytesUnidad);
+		for (j=0,Hechos=0;j<Piezas.size();j++,Hechos+=Parte)
+		    {
+			Parte=(__u64)Piezas[j].Cantidad*DatosFS.BytesPorCluster;
+			if ( (pOrigen=PunteroABytes(OffsetParticion+Piezas[j].Inicio*DatosFS.BytesPorCluster, Parte)) == NULL )
+				return(CODERROR_LECTURA_DISCO);
+			memcpy(&Comprimido[Hechos], pOrigen, Parte);
+		    }
+		if ( (CodError=DescomprimirLZNT1(&Comprimido[0], Comprimido.size(), &Descomprimido[0], BytesUnidad)) != CODERROR_NINGUNO )
+			return(CodError);
+		Tramo.Datos=&Descomprimido[0];
+		Tramo.Bytes=BytesDatos;
+		Tramo.Offset=Offset;
+		if ( (CodError=Receptor(Tramo, pParametroUsuario)) != CODERROR_NINGUNO )
+			return(CodError);
+	    }
+
+	/* El resto de la unidad son ceros */
+	if ( (Bytes>BytesDatos) &&
+	     ((CodError=EmitirCeros(Bytes-BytesDatos, Offset+BytesDatos, BytesArchivo, Receptor, pParametroUsuario)) != CODERROR_NINGUNO) )
+		return(CodError);
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverNTFS :: DescomprimirLZNT1							*
+ *																	*
+ * OBJETIVO: Esta función descomprime una unidad de compresión guardada con LZNT1.							*
+ *																	*
+ * ENTRADA: pOrigen: Los clusters asignados de la unidad.										*
+ *	    BytesOrigen: Tamaño de esos clusters.											*
+ *	    BytesDestino: Tamaño de la unidad descomprimida, múltiplo de NTFS_BYTES_BLOQUE_LZNT1.					*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   pDestino: La unidad descomprimida.												*
+ *																	*
+ * OBSERVACIONES: Cada bloque de 4 KiB tiene un encabezado con su largo comprimido y si está comprimido. Los comprimidos son grupos	*
+ *		  de un byte de banderas y ocho elementos: un byte literal, o una referencia de 16 bits a lo ya descomprimido del	*
+ *		  bloque. Cuanto más se avanzó en el bloque, más bits de la referencia son del desplazamiento y menos del largo.	*
+ *		  Un encabezado en cero termina la unidad; lo que falta, y lo que falta de cada bloque, son ceros.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::DescomprimirLZNT1(const unsigned char *pOrigen, unsigned BytesOrigen, unsigned char *pDestino, unsigned BytesDestino)
+{
+const unsigned char	*pFinOrigen, *pFinBloque;
+unsigned char		*p, *pBloque, *pFinDestino;
+unsigned		Encabezado, Referencia, BitsLargo, Desplazamiento, Largo, Posicion;
+unsigned char		Banderas;
+int			Bit;
+
+/* Recorrer los bloques */
+pFinOrigen=pOrigen+BytesOrigen;
+pFinDestino=pDestino+BytesDestino;
+for (p=pDestino;(pOrigen+sizeof(USHORT)<=pFinOrigen) && (p<pFinDestino);)
+    {
+	/* Encabezado del bloque */
+	if ( (Encabezado=pOrigen[0] | pOrigen[1]<<8) == 0 )
+		break;
+	pOrigen+=sizeof(USHORT);
+	pFinBloque=pOrigen+(Encabezado&NTFS_LARGO_BLOQUE_LZNT1)+1;
+	if (pFinBloque>pFinOrigen)
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	pBloque=p;
+
+	if (!(Encabezado&NTFS_BLOQUE_LZNT1_COMPRIMIDO))
+	    {
+		/* Sin comprimir: copiarlo */
+		memcpy(p, pOrigen, pFinBloque-pOrigen);
+		p+=pFinBloque-pOrigen;
+		pOrigen=pFinBloque;
+	    }
+	else
+	    {
+		/* Comprimido: de a grupos de ocho elementos */
+		while (pOrigen<pFinBloque)
+		    {
+			Banderas=*pOrigen++;
+			for (Bit=0;(Bit<8) && (pOrigen<pFinBloque);Bit++,Banderas>>=1)
+			    {
+				/* Un byte literal */
+				if (!(Banderas&1))
+				    {
+					if (p>=pBloque+NTFS_BYTES_BLOQUE_LZNT1)
+						return(CODERROR_FILESYSTEM_CORRUPTO);
+					*p++=*pOrigen++;
+					continue;
+				    }
+
+				/* Una referencia: separar desplazamiento y largo según la posición en el bloque */
+				if ( (pOrigen+sizeof(USHORT)>pFinBloque) || (p==pBloque) )
+					return(CODERROR_FILESYSTEM_CORRUPTO);
+				Referencia=pOrigen[0] | pOrigen[1]<<8;
+				pOrigen+=sizeof(USHORT);
+				for (BitsLargo=12,Posicion=p-pBloque-1;Posicion>=0x10;Posicion>>=1)
+					BitsLargo--;
+				Desplazamiento=(Referencia>>BitsLargo)+1;
+				Largo=(Referencia&((1<<BitsLargo)-1))+3;
+				if ( (Desplazamiento>(unsigned)(p-pBloque)) || (p+Largo>pBloque+NTFS_BYTES_BLOQUE_LZNT1) )
+					return(CODERROR_FILESYSTEM_CORRUPTO);
+
+				/* Copiar de a un byte, porque la copia se puede superponer con lo que se está escribiendo */
+				for (;Largo;Largo--,p++)
+					*p=*(p-Desplazamiento);
+			    }
+		    }
+	    }
+
+	/* Completar el bloque con ceros */
+	if (p<pBloque+NTFS_BYTES_BLOQUE_LZNT1)
+	    {
+		memset(p, 0, pBloque+NTFS_BYTES_BLOQUE_LZNT1-p);
+		p=pBloque+NTFS_BYTES_BLOQUE_LZNT1;
+	    }
+    }
+
+/* Y lo que falta de la unidad */
+memset(p, 0, pFinDestino-p);
+return(CODERROR_NINGUNO);
+}
+
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverNTFS :: LeerRaizIndice							*
+ *																	*
+ * OBJETIVO: Esta función levanta la raíz del índice de archivos de un directorio y los runs de sus demás nodos.			*
+ *																	*
+ * ENTRADA: IndiceMFT: Registro del directorio.												*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, CODERROR_DIRECTORIO_INEXISTENTE si el registro no es un	*
+ *	   directorio, caso contrario el código de error.										*
+ *	   Raiz: Copia del valor de $INDEX_ROOT (un INDEX_ROOT seguido de las entradas del nodo raíz).					*
+ *	   Runs: Runs de $INDEX_ALLOCATION, vacío si todas las entradas entran en la raíz.						*
+ *	   BytesBuffer: Tamaño de los buffers de índice.										*
+ *																	*
+ * OBSERVACIONES: La raíz se copia para no retener el registro mientras se recorre el índice.						*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::LeerRaizIndice(__u64 IndiceMFT, std::vector<unsigned char> &Raiz, std::vector<TDataRun> &Runs, unsigned &BytesBuffer) const
+{
+int					CodError;
+TRegistroMFT				Registro;
+const FILE_RECORD_SEGMENT_HEADER	*pRegistro;
+const ATTRIBUTE_RECORD_HEADER		*pAtributo;
+const unsigned char			*pValor;
+__u32					Bytes;
+const INDEX_ROOT			*pRaiz;
+
+/* Inicializar salidas */
+Runs.clear();
+
+/* Levantar el registro del directorio */
+if ( (CodError=LeerRegistroMFT(IndiceMFT, 0, Registro, pRegistro)) != CODERROR_NINGUNO )
+	return(CodError);
+if ( (pRegistro->Flags&(NTFS_REGISTRO_EN_USO|NTFS_REGISTRO_DIRECTORIO)) != (NTFS_REGISTRO_EN_USO|NTFS_REGISTRO_DIRECTORIO) )
+	return(CODERROR_DIRECTORIO_INEXISTENTE);
+
+/* La raíz del índice */
+if ( (CodError=BuscarAtributo(pRegistro, NTFS_STRUCT_INDEX_ROOT, NTFS_NOMBRE_INDICE_ARCHIVOS, pAtributo)) != CODERROR_NINGUNO )
+	return(CodError==CODERROR_NO_ENCONTRADO ? CODERROR_FILESYSTEM_CORRUPTO : CodError);
+if ( (CodError=ValorResidente(pAtributo, pValor, Bytes)) != CODERROR_NINGUNO )
+	return(CodError);
+if (Bytes<sizeof(INDEX_ROOT))
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+Raiz.assign(pValor, pValor+Bytes);
+pRaiz=(const INDEX_ROOT *)&Raiz[0];
+BytesBuffer=pRaiz->Root.IndexAllocationEntrySize;
+if ( (pRaiz->Root.IndexedAttributeType!=NTFS_STRUCT_FILE_NAME) || (BytesBuffer<NTFS_BYTES_SECTOR_FIXUP) || (BytesBuffer>65536) ||
+     (BytesBuffer&(BytesBuffer-1)) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Los demás nodos, si los hay */
+if ( (CodError=BuscarAtributo(pRegistro, NTFS_STRUCT_INDEX_ALLOCATION, NTFS_NOMBRE_INDICE_ARCHIVOS, pAtributo)) == CODERROR_NINGUNO )
+	return(ParsearDataRuns(pAtributo, Runs));
+return(CodError==CODERROR_NO_ENCONTRADO ? CODERROR_NINGUNO : CodError);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverNTFS :: ParsearIndice							*
+ *																	*
+ * OBJETIVO: Esta función recorre en orden todas las entradas del índice de archivos de un directorio.					*
+ *																	*
+ * ENTRADA: IndiceMFT: Registro del directorio.												*
+ *	    Colectora: Función a la que se le pasa cada entrada.									*
+ *	    pParametroUsuario: Valor que se le pasa sin modificar a la colectora.							*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, CODERROR_DIRECTORIO_INEXISTENTE si el registro no es un	*
+ *	   directorio, caso contrario el código de error (o el que haya retornado la colectora).					*
+ *																	*
+ * OBSERVACIONES: El índice es un árbol B: la raíz está en el atributo $INDEX_ROOT y los demás nodos en buffers de $INDEX_ALLOCATION.	*
+ *		  Cada entrada puede apuntar a un subnodo con las que van antes que ella.						*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::ParsearIndice(__u64 IndiceMFT, TpColectoraDatosIndice Colectora, void *pParametroUsuario) const
+{
+int				CodError;
+std::vector<unsigned char>	Raiz;
+std::vector<TDataRun>		Runs;
+unsigned			BytesBuffer;
+
+/* Levantar la raíz y recorrer el árbol desde ahí */
+if ( (CodError=LeerRaizIndice(IndiceMFT, Raiz, Runs, BytesBuffer)) != CODERROR_NINGUNO )
+	return(CodError);
+return(ParsearSubArbolIndice(&((INDEX_ROOT *)&Raiz[0])->Header, Raiz.size()-offsetof(INDEX_ROOT, Header), Runs, BytesBuffer, 0, Colectora,
+			     pParametroUsuario));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverNTFS :: ParsearSubArbolIndice							*
+ *																	*
+ * OBJETIVO: Esta función recorre en orden las entradas de un nodo del índice y de todos sus subnodos.					*
+ *																	*
+ * ENTRADA: pHeader: Encabezado del nodo.												*
+ *	    BytesNodo: Bytes disponibles a partir del encabezado.									*
+ *	    Runs: Runs de $INDEX_ALLOCATION.												*
+ *	    BytesBuffer: Tamaño de los buffers de índice.										*
+ *	    Nivel: Profundidad del nodo (la raíz es 0).											*
+ *	    Colectora, pParametroUsuario: Ver ParsearIndice().										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Cada nivel de la recursión tiene su propio buffer para los subnodos, así al volver de uno el nodo padre sigue		*
+ *		  intacto, y dos hilos que recorren índices a la vez no comparten nada.							*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::ParsearSubArbolIndice(IDX_HEADER *pHeader, unsigned BytesNodo, const std::vector<TDataRun> &Runs, unsigned BytesBuffer,
+				       int Nivel, TpColectoraDatosIndice Colectora, void *pParametroUsuario) const
+{
+int				CodError;
+INDEX_RECORD			*pEntrada;
+FILE_RECORD_INDEX_HEADER	*pBuffer;
+std::vector<unsigned char>	Buffer;
+unsigned			Offset;
+
+/* Los campos del encabezado son offsets en bytes desde el propio encabezado */
+if ( (pHeader->IndexEntriesUsed>BytesNodo) || (pHeader->OffsetFirstEntry>=pHeader->IndexEntriesUsed) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Recorrer las entradas del nodo, la última es una marca sin datos */
+for (Offset=pHeader->OffsetFirstEntry;;Offset+=pEntrada->RecordLength)
+    {
+	if ( (CodError=ValidarEntradaIndice(pHeader, Offset, pEntrada)) != CODERROR_NINGUNO )
+		return(CodError);
+
+	/* Primero las entradas del subnodo, que van antes que esta */
+	if (pEntrada->Flags&NTFS_INDICE_SUBNODO)
+	    {
+		if (Nivel+1>=NTFS_MAXIMO_NIVELES_INDICE)
+			return(CODERROR_FILESYSTEM_CORRUPTO);
+		if ( (CodError=LeerBufferIndice(Runs, VCNSubnodo(pEntrada), BytesBuffer, Buffer, pBuffer)) != CODERROR_NINGUNO )
+			return(CodError);
+		if ( (CodError=ParsearSubArbolIndice(&pBuffer->Header, BytesBuffer-offsetof(FILE_RECORD_INDEX_HEADER, Header), Runs, BytesBuffer, Nivel+1,
+						     Colectora, pParametroUsuario)) != CODERROR_NINGUNO )
+			return(CodError);
+	    }
+
+	/* Después la propia entrada */
+	if (pEntrada->Flags&NTFS_INDICE_ULTIMA)
+		break;
+	if ( (CodError=(this->*Colectora)(pEntrada, pParametroUsuario)) != CODERROR_NINGUNO )
+		return(CodError);
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverNTFS :: LeerBufferIndice							*
+ *																	*
+ * OBJETIVO: Esta función levanta un buffer de $INDEX_ALLOCATION con los fixups ya aplicados.						*
+ *																	*
+ * ENTRADA: Runs: Runs de $INDEX_ALLOCATION.												*
+ *	    NroVCN: VCN del buffer, como figura en la entrada que lo apunta.								*
+ *	    BytesBuffer: Tamaño de los buffers de índice.										*
+ *	    Buffer: Dónde dejar el buffer (se redimensiona si hace falta).								*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   pBuffer: El buffer, dentro de Buffer.											*
+ *																	*
+ * OBSERVACIONES: Si los buffers son más chicos que un cluster los VCN de los índices cuentan sectores de 512 bytes.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::LeerBufferIndice(const std::vector<TDataRun> &Runs, VCN NroVCN, unsigned BytesBuffer, std::vector<unsigned char> &Buffer,
+				  FILE_RECORD_INDEX_HEADER *&pBuffer) const
+{
+int				CodError;
+unsigned			BytesVCN;
+unsigned char			*pDatos;
+
+/* Copiar el buffer y corregirlo */
+Buffer.resize(BytesBuffer);
+pDatos=&Buffer[0];
+BuffersIndiceLeidos++;
+BytesVCN=BytesBuffer>=(unsigned)DatosFS.BytesPorCluster ? DatosFS.BytesPorCluster : NTFS_BYTES_SECTOR_FIXUP;
+if ( (CodError=LeerDeRuns(Runs, NroVCN*BytesVCN, BytesBuffer, pDatos)) != CODERROR_NINGUNO )
+	return(CodError);
+if ( (CodError=AplicarFixups(pDatos, BytesBuffer, NTFS_FIRMA_INDX)) != CODERROR_NINGUNO )
+	return(CodError);
+
+/* Tiene que ser el buffer pedido */
+pBuffer=(FILE_RECORD_INDEX_HEADER *)pDatos;
+if (pBuffer->IndexVCN!=NroVCN)
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TDriverNTFS :: ColectarEntradaDirectorio						*
+ *																	*
+ * OBJETIVO: Colectora de ParsearIndice() que agrega cada entrada del índice a un arreglo de entradas de directorio.			*
+ *																	*
+ * ENTRADA: IndexRecord: La entrada del índice, cuyos datos son un FILE_NAME.								*
+ *	    pParametroUsuario: Puntero al std::vector<TEntradaDirectorio> donde agregarla.						*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Los nombres cortos (8.3) de los archivos con nombre largo tienen su propia entrada, que no se agrega para no		*
+ *		  listar dos veces el mismo archivo.											*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::ColectarEntradaDirectorio(INDEX_RECORD *IndexRecord, void *pParametroUsuario) const
+{
+std::vector<TEntradaDirectorio>	*pEntradas = (std::vector<TEntradaDirectorio> *)pParametroUsuario;
+const FILE_NAME			*pNombre;
+
+/* Validar el nombre */
+if ( (pNombre=NombreEntradaIndice(IndexRecord)) == NULL )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Agregar la entrada */
+if (pNombre->Flags==NTFS_NOMBRE_DOS)
+	return(CODERROR_NINGUNO);
+pEntradas->push_back(TEntradaDirectorio());
+CompletarEntrada(IndexRecord->FileReference, pNombre, pEntradas->back());
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverNTFS :: ValidarEntradaIndice							*
+ *																	*
+ * OBJETIVO: Esta función ubica una entrada dentro de un nodo del índice y valida que entre en el nodo.					*
+ *																	*
+ * ENTRADA: pHeader: Encabezado del nodo, ya validado.											*
+ *	    Offset: Posición de la entrada, desde el encabezado.									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si la entrada es válida, CODERROR_FILESYSTEM_CORRUPTO si no.			*
+ *	   pEntrada: La entrada.													*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::ValidarEntradaIndice(IDX_HEADER *pHeader, unsigned Offset, INDEX_RECORD *&pEntrada)
+{
+/* La entrada tiene que entrar en el nodo, y sus datos en la entrada */
+pEntrada=(INDEX_RECORD *)((unsigned char *)pHeader+Offset);
+if ( (Offset+offsetof(INDEX_RECORD, Data)>pHeader->IndexEntriesUsed) || (pEntrada->RecordLength<offsetof(INDEX_RECORD, Data)) ||
+     (pEntrada->RecordLength&7) || (Offset+pEntrada->RecordLength>pHeader->IndexEntriesUsed) ||
+     (offsetof(INDEX_RECORD, Data)+pEntrada->StreamLength>pEntrada->RecordLength) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Si apunta a un subnodo, también el VCN del final */
+if ( (pEntrada->Flags&NTFS_INDICE_SUBNODO) && (pEntrada->RecordLength<offsetof(INDEX_RECORD, Data)+pEntrada->StreamLength+sizeof(VCN)) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverNTFS :: NombreEntradaIndice							*
+ *																	*
+ * OBJETIVO: Esta función devuelve el FILE_NAME que es la clave de una entrada del índice de archivos.					*
+ *																	*
+ * ENTRADA: pEntrada: La entrada, ya validada con ValidarEntradaIndice().								*
+ *																	*
+ * SALIDA: En el nombre de la función el nombre, o NULL si no entra en la entrada.							*
+ *																	*
+ ****************************************************************************************************************************************/
+const FILE_NAME *TDriverNTFS::NombreEntradaIndice(const INDEX_RECORD *pEntrada)
+{
+const FILE_NAME	*pNombre;
+
+pNombre=(const FILE_NAME *)pEntrada->Data;
+if ( (pEntrada->StreamLength<offsetof(FILE_NAME, FileName)) ||
+     (pEntrada->StreamLength<offsetof(FILE_NAME, FileName)+pNombre->FileNameLength*sizeof(WCHAR)) )
+	return(NULL);
+return(pNombre);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverNTFS :: VCNSubnodo								*
+ *																	*
+ * OBJETIVO: Esta función devuelve el VCN del buffer con el subnodo de una entrada del índice.						*
+ *																	*
+ * ENTRADA: pEntrada: La entrada, ya validada con ValidarEntradaIndice() y con NTFS_INDICE_SUBNODO.					*
+ *																	*
+ * SALIDA: En el nombre de la función el VCN, que está en los últimos bytes de la entrada.						*
+ *																	*
+ ****************************************************************************************************************************************/
+VCN TDriverNTFS::VCNSubnodo(const INDEX_RECORD *pEntrada)
+{
+return(*(const VCN *)((const unsigned char *)pEntrada+pEntrada->RecordLength-sizeof(VCN)));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverNTFS :: BuscarEnDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función busca un nombre en un directorio bajando por su índice, sin recorrerlo entero.				*
+ *																	*
+ * ENTRADA: Directorio: Entrada del directorio donde buscar.										*
+ *	    Nombre: Nombre buscado, ya normalizado con NormalizarNombre().								*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si lo encontró, CODERROR_ARCHIVO_INEXISTENTE si no está,				*
+ *	   CODERROR_NO_IMPLEMENTADO si el índice no se puede recorrer por nombre, caso contrario el código de error.			*
+ *	   Entrada: La entrada encontrada.												*
+ *																	*
+ * OBSERVACIONES: Las entradas de cada nodo están ordenadas según CollationRule. Se recorren hasta la primera que va después del	*
+ *		  nombre, y si no es el nombre buscado se sigue por su subnodo; así se lee un buffer de índice por nivel del árbol.	*
+ *		  Sin la tabla $UpCase no se puede comparar igual que Windows, y entonces se deja que la clase base liste el		*
+ *		  directorio.														*
+ *																	*
  ****************************************************************************************************************************************/
-int TDriverNTFS::LevantarDatosSuperbloque()
+int TDriverNTFS::BuscarEnDirectorio(const TEntradaDirectorio &Directorio, const TString &Nombre, TEntradaDirectorio &Entrada) const
 {
-/* Salir */
-return(CODERROR_NO_IMPLEMENTADO);
+int				CodError, Comparacion, Nivel;
+std::vector<unsigned char>	Raiz;
+std::vector<TDataRun>		Runs;
+std::vector<WCHAR>		Buscado;
+unsigned			BytesBuffer, BytesNodo, Offset;
+INDEX_ROOT			*pRaiz;
+IDX_HEADER			*pHeader;
+INDEX_RECORD			*pEntrada;
+FILE_RECORD_INDEX_HEADER	*pBuffer;
+std::vector<unsigned char>	Buffer;
+const FILE_NAME			*pNombre;
+
+/* Levantar la raíz del índice, que tiene que estar ordenado por nombre */
+if (TablaMayusculas.empty())
+	return(CODERROR_NO_IMPLEMENTADO);
+if ( (CodError=LeerRaizIndice(Directorio.DatosEspecificos.NTFS.IndiceMFT, Raiz, Runs, BytesBuffer)) != CODERROR_NINGUNO )
+	return(CodError);
+pRaiz=(INDEX_ROOT *)&Raiz[0];
+if (pRaiz->Root.CollationRule!=NTFS_COLACION_NOMBRE_ARCHIVO)
+	return(CODERROR_NO_IMPLEMENTADO);
+NombreUTF16(Nombre, Buscado);
+
+/* Bajar desde la raíz */
+pHeader=&pRaiz->Header;
+BytesNodo=Raiz.size()-offsetof(INDEX_ROOT, Header);
+for (Nivel=0;;)
+    {
+	/* Buscar la primera entrada que no va antes del nombre */
+	if ( (pHeader->IndexEntriesUsed>BytesNodo) || (pHeader->OffsetFirstEntry>=pHeader->IndexEntriesUsed) )
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	for (Offset=pHeader->OffsetFirstEntry;;Offset+=pEntrada->RecordLength)
+	    {
+		if ( (CodError=ValidarEntradaIndice(pHeader, Offset, pEntrada)) != CODERROR_NINGUNO )
+			return(CodError);
+		if (pEntrada->Flags&NTFS_INDICE_ULTIMA)
+			break;
+		if ( (pNombre=NombreEntradaIndice(pEntrada)) == NULL )
+			return(CODERROR_FILESYSTEM_CORRUPTO);
+		if ( (Comparacion=CompararNombreIndice(pNombre, Buscado)) > 0 )
+			break;
+
+		/* Es el nombre buscado (los nombres 8.3 sueltos no se listan, así que tampoco se encuentran) */
+		if ( (!Comparacion) && (pNombre->Flags!=NTFS_NOMBRE_DOS) )
+		    {
+			CompletarEntrada(pEntrada->FileReference, pNombre, Entrada);
+			return(CODERROR_NINGUNO);
+		    }
+	    }
+
+	/* Si está, está en el subnodo de esa entrada */
+	if (!(pEntrada->Flags&NTFS_INDICE_SUBNODO))
+		return(CODERROR_ARCHIVO_INEXISTENTE);
+	if (++Nivel>=NTFS_MAXIMO_NIVELES_INDICE)
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	if ( (CodError=LeerBufferIndice(Runs, VCNSubnodo(pEntrada), BytesBuffer, Buffer, pBuffer)) != CODERROR_NINGUNO )
+		return(CodError);
+	pHeader=&pBuffer->Header;
+	BytesNodo=BytesBuffer-offsetof(FILE_RECORD_INDEX_HEADER, Header);
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverNTFS :: CargarMayusculas							*
+ *																	*
+ * OBJETIVO: Esta función levanta la tabla de mayúsculas del volumen ($UpCase).								*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: La tabla tiene la mayúscula de cada código UTF-16, y es la que usa el volumen para ordenar los índices de los		*
+ *		  directorios. Se levanta de la imágen porque depende de la versión de Windows que formateó el volumen.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::CargarMayusculas(void)
+{
+int					CodError;
+TRegistroMFT				Registro;
+const FILE_RECORD_SEGMENT_HEADER	*pRegistro;
+const ATTRIBUTE_RECORD_HEADER		*pAtributo;
+std::vector<TDataRun>			Runs;
+
+/* Buscar el atributo de datos de $UpCase */
+if ( (CodError=LeerRegistroMFT(NTFS_ELEM_UPCASE, 0, Registro, pRegistro)) != CODERROR_NINGUNO )
+	return(CodError);
+if (!(pRegistro->Flags&NTFS_REGISTRO_EN_USO))
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+if ( (CodError=BuscarAtributo(pRegistro, NTFS_STRUCT_DATA, "", pAtributo)) != CODERROR_NINGUNO )
+	return(CodError==CODERROR_NO_ENCONTRADO ? CODERROR_FILESYSTEM_CORRUPTO : CodError);
+
+/* Tiene un carácter por cada código, y no entra en el registro */
+if ( (!pAtributo->NonResidentFlag) || (pAtributo->Flags&(NTFS_ATRIBUTO_COMPRIMIDO|NTFS_ATRIBUTO_ENCRIPTADO)) ||
+     (pAtributo->Form.NonResident.RealSize!=NTFS_CARACTERES_UPCASE*sizeof(WCHAR)) ||
+     (pAtributo->Form.NonResident.InitializedSize!=NTFS_CARACTERES_UPCASE*sizeof(WCHAR)) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+if ( (CodError=ParsearDataRuns(pAtributo, Runs)) != CODERROR_NINGUNO )
+	return(CodError);
+TablaMayusculas.resize(NTFS_CARACTERES_UPCASE);
+return(LeerDeRuns(Runs, 0, NTFS_CARACTERES_UPCASE*sizeof(WCHAR), (unsigned char *)&TablaMayusculas[0]));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverNTFS :: CompararNombreIndice							*
+ *																	*
+ * OBJETIVO: Esta función compara la clave de una entrada del índice con un nombre, como los ordena COLLATION_FILE_NAME.		*
+ *																	*
+ * ENTRADA: pNombre: Clave de la entrada.												*
+ *	    Buscado: Nombre en UTF-16, ya pasado a mayúsculas.										*
+ *																	*
+ * SALIDA: En el nombre de la función un valor negativo si la entrada va antes que el nombre, 0 si son iguales y positivo si va		*
+ *	   después.															*
+ *																	*
+ * OBSERVACIONES: Se comparan los códigos UTF-16 sin signo, de a uno y después de pasarlos a mayúsculas con $UpCase.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::CompararNombreIndice(const FILE_NAME *pNombre, const std::vector<WCHAR> &Buscado) const
+{
+const unsigned char	*pCaracteres;
+WCHAR			Caracter;
+size_t			i;
+
+/* Comparar de a un carácter */
+pCaracteres=(const unsigned char *)pNombre->FileName;
+for (i=0;(i<pNombre->FileNameLength) && (i<Buscado.size());i++)
+    {
+	Caracter=TablaMayusculas[pCaracteres[2*i] | pCaracteres[2*i+1]<<8];
+	if (Caracter!=Buscado[i])
+		return(Caracter<Buscado[i] ? -1 : 1);
+    }
+
+/* Si uno es el comienzo del otro va antes el más corto */
+return(pNombre->FileNameLength<Buscado.size() ? -1 : pNombre->FileNameLength>Buscado.size());
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverNTFS :: CompletarEntrada							*
+ *																	*
+ * OBJETIVO: Esta función completa una entrada de directorio a partir de un atributo FILE_NAME.						*
+ *																	*
+ * ENTRADA: Referencia: Registro del $MFT al que corresponde el nombre.									*
+ *	    pNombre: El FILE_NAME, ya validado.												*
+ *																	*
+ * SALIDA: Entrada: La entrada.														*
+ *																	*
+ * OBSERVACIONES: Se usa la copia del FILE_NAME que está en el índice del directorio, así listar no lee el registro de cada entrada.	*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverNTFS::CompletarEntrada(const FILE_REFERENCE &Referencia, const FILE_NAME *pNombre, TEntradaDirectorio &Entrada) const
+{
+/* Atributos */
+Entrada.Flags=0;
+if (pNombre->FileAttributes&NTFS_READ_ONLY)
+	Entrada.Flags|=fedSOLO_LECTURA;
+if (pNombre->FileAttributes&NTFS_HIDDEN)
+	Entrada.Flags|=fedOCULTO;
+if (pNombre->FileAttributes&NTFS_SYSTEM)
+	Entrada.Flags|=fedSISTEMA;
+if (pNombre->FileAttributes&NTFS_DIRECTORY)
+	Entrada.Flags|=fedDIRECTORIO;
+if (pNombre->FileAttributes&NTFS_ARCHIVE)
+	Entrada.Flags|=fedARCHIVAR;
+if (pNombre->FileAttributes&NTFS_REPARSE_POINT)
+	Entrada.Flags|=fedACCESO_DIRECTO;
+if (pNombre->FileAttributes&NTFS_COMPRESSED)
+	Entrada.Flags|=fedCOMPRIMIDO;
+if (pNombre->FileAttributes&NTFS_ENCTRYPTED)
+	Entrada.Flags|=fedENCRIPTADO;
+if (pNombre->FileAttributes&NTFS_SPARSE_FILE)
+	Entrada.Flags|=fedDISPERSO;
+
+/* Nombre, tamaño y fechas */
+NombreUTF8((const unsigned char *)pNombre->FileName, pNombre->FileNameLength, Entrada.Nombre);
+Entrada.Bytes=pNombre->RealSize;
+Entrada.FechaCreacion=FechaNTFS(pNombre->UTCCreation);
+Entrada.FechaUltimoAcceso=FechaNTFS(pNombre->UTCRLastAccesed);
+Entrada.FechaUltimaModificacion=FechaNTFS(pNombre->UTCModification);
+
+/* Datos propios de NTFS */
+memset(&Entrada.DatosEspecificos, 0, sizeof(Entrada.DatosEspecificos));
+Entrada.DatosEspecificos.NTFS.IndiceMFT=Referencia.MFTIndex;
+Entrada.DatosEspecificos.NTFS.NroSecuencia=Referencia.Sequence;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverNTFS :: NombreUTF8							*
+ *																	*
+ * OBJETIVO: Esta función convierte un nombre de NTFS (UTF-16) a UTF-8.									*
+ *																	*
+ * ENTRADA: pNombre: El nombre, en UTF-16 little endian.										*
+ *	    Caracteres: Largo del nombre, en unidades de 16 bits.									*
+ *																	*
+ * SALIDA: Nombre: El nombre en UTF-8.													*
+ *																	*
+ * OBSERVACIONES: Los surrogates sueltos, que NTFS permite, se reemplazan por U+FFFD.							*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverNTFS::NombreUTF8(const unsigned char *pNombre, int Caracteres, TString &Nombre)
+{
+__u32	Codigo, Siguiente;
+int	i;
+
+/* Convertir de a un código */
+Nombre.clear();
+for (i=0;i<Caracteres;i++)
+    {
+	/* Armar el código, juntando los pares de surrogates */
+	Codigo=pNombre[2*i] | pNombre[2*i+1]<<8;
+	if ( (Codigo>=0xD800) && (Codigo<0xE000) )
+	    {
+		Siguiente=i+1<Caracteres ? pNombre[2*i+2] | pNombre[2*i+3]<<8 : 0;
+		if ( (Codigo<0xDC00) && (Siguiente>=0xDC00) && (Siguiente<0xE000) )
+		    {
+			Codigo=0x10000 + ((Codigo-0xD800)<<10) + (Siguiente-0xDC00);
+			i++;
+		    }
+		else
+			Codigo=0xFFFD;
+	    }
+
+	/* Codificarlo en UTF-8 */
+	if (Codigo<0x80)
+		Nombre+=(char)Codigo;
+	else if (Codigo<0x800)
+	    {
+		Nombre+=(char)(0xC0 | Codigo>>6);
+		Nombre+=(char)(0x80 | (Codigo&0x3F));
+	    }
+	else if (Codigo<0x10000)
+	    {
+		Nombre+=(char)(0xE0 | Codigo>>12);
+		Nombre+=(char)(0x80 | (Codigo>>6&0x3F));
+		Nombre+=(char)(0x80 | (Codigo&0x3F));
+	    }
+	else
+	    {
+		Nombre+=(char)(0xF0 | Codigo>>18);
+		Nombre+=(char)(0x80 | (Codigo>>12&0x3F));
+		Nombre+=(char)(0x80 | (Codigo>>6&0x3F));
+		Nombre+=(char)(0x80 | (Codigo&0x3F));
+	    }
+    }
+}
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverNTFS :: NombreUTF16							*
+ *																	*
+ * OBJETIVO: Esta función convierte un nombre de UTF-8 a UTF-16, que es como se guardan los nombres en NTFS.				*
+ *																	*
+ * ENTRADA: Nombre: El nombre en UTF-8.													*
+ *																	*
+ * SALIDA: Caracteres: El nombre en UTF-16. Los códigos mayores a 0xFFFF quedan como un par de surrogates.				*
+ *																	*
+ * OBSERVACIONES: Las secuencias UTF-8 inválidas se reemplazan por U+FFFD, igual que los surrogates sueltos en NombreUTF8().		*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverNTFS::NombreUTF16(const TString &Nombre, std::vector<WCHAR> &Caracteres)
+{
+static const __u32	Minimos[4] = {0, 0x80, 0x800, 0x10000};
+const unsigned char	*p, *pFin;
+__u32			Codigo;
+int			Siguientes, i;
+
+/* Decodificar de a una secuencia */
+Caracteres.clear();
+p=(const unsigned char *)Nombre.data();
+pFin=p+Nombre.size();
+while (p<pFin)
+    {
+	/* El primer byte dice cuántos siguen, y el código más chico que puede llevar esa cantidad */
+	Codigo=*p++;
+	if (Codigo<0x80)
+		Siguientes=0;
+	else if ( (Codigo&0xE0) == 0xC0 )
+		Siguientes=1;
+	else if ( (Codigo&0xF0) == 0xE0 )
+		Siguientes=2;
+	else if ( (Codigo&0xF8) == 0xF0 )
+		Siguientes=3;
+	else
+	    {
+		Caracteres.push_back(0xFFFD);
+		continue;
+	    }
+	Codigo&=Siguientes ? 0x3F>>Siguientes : 0x7F;
+
+	/* Juntar los bits de los que siguen */
+	for (i=Siguientes;(i) && (p<pFin) && ((*p&0xC0) == 0x80);i--)
+		Codigo=Codigo<<6 | (*p++&0x3F);
+	if ( (i) || (Codigo<Minimos[Siguientes]) || (Codigo>0x10FFFF) || ((Codigo>=0xD800) && (Codigo<0xE000)) )
+		Codigo=0xFFFD;
+
+	/* Codificarlo en UTF-16 */
+	if (Codigo<0x10000)
+		Caracteres.push_back((WCHAR)Codigo);
+	else
+	    {
+		Caracteres.push_back((WCHAR)(0xD800 + ((Codigo-0x10000)>>10)));
+		Caracteres.push_back((WCHAR)(0xDC00 + ((Codigo-0x10000)&0x3FF)));
+	    }
+    }
+}
+
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverNTFS :: FechaNTFS								*
+ *																	*
+ * OBJETIVO: Esta función convierte una fecha de NTFS a time_t.										*
+ *																	*
+ * ENTRADA: Fecha: Intervalos de 100 ns desde el 1/1/1601 UTC.										*
+ *																	*
+ * SALIDA: En el nombre de la función la fecha, o 0 si es anterior a 1970.								*
+ *																	*
+ ****************************************************************************************************************************************/
+time_t TDriverNTFS::FechaNTFS(ULONGLONG Fecha)
+{
+Fecha/=NTFS_INTERVALOS_POR_SEGUNDO;
+return(Fecha>NTFS_SEGUNDOS_1601_A_1970 ? (time_t)(Fecha-NTFS_SEGUNDOS_1601_A_1970) : 0);
 }
 
 
@@ -72,10 +1959,105 @@ return(CODERROR_NO_IMPLEMENTADO);
  *	   Entradas: Arreglo con cada una de las entradas.										*
  *																	*
  ****************************************************************************************************************************************/
-int TDriverNTFS::ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas)
+int TDriverNTFS::ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas) const
 {
-/* Salir */
-return(CODERROR_NO_IMPLEMENTADO);
+/* La ruta la resuelve la clase base, pidiendo cada directorio con ListarDirectorioEntrada() */
+return(ListarDirectorioPorRuta(Path, Entradas));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TDriverNTFS :: ListarDirectorioEntrada							*
+ *																	*
+ * OBJETIVO: Esta función enumera las entradas de un directorio dado por su entrada.							*
+ *																	*
+ * ENTRADA: Directorio: Entrada del directorio a enumerar.										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Entradas: Arreglo con cada una de las entradas, en el orden del índice (alfabético, sin distinguir mayúsculas).		*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::ListarDirectorioEntrada(const TEntradaDirectorio &Directorio, std::vector<TEntradaDirectorio> &Entradas) const
+{
+/* Inicializar salidas */
+Entradas.clear();
+
+/* Juntar las entradas del índice de archivos */
+return(ParsearIndice(Directorio.DatosEspecificos.NTFS.IndiceMFT, &TDriverNTFS::ColectarEntradaDirectorio, &Entradas));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverNTFS :: EntradaRootDir							*
+ *																	*
+ * OBJETIVO: Esta función arma la entrada que representa al directorio raíz.								*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Entrada: La entrada del directorio raíz (registro NTFS_ELEM_ROOT_DIR).							*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverNTFS::EntradaRootDir(TEntradaDirectorio &Entrada) const
+{
+TDriverBase::EntradaRootDir(Entrada);
+Entrada.DatosEspecificos.NTFS.IndiceMFT=NTFS_ELEM_ROOT_DIR;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TDriverNTFS :: IdentificadorDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función devuelve un número que identifica unívocamente a un directorio dentro del filesystem.				*
+ *																	*
+ * ENTRADA: Directorio: Entrada del directorio.												*
+ *																	*
+ * SALIDA: En el nombre de la función el número de registro del $MFT.									*
+ *																	*
+ ****************************************************************************************************************************************/
+__u64 TDriverNTFS::IdentificadorDirectorio(const TEntradaDirectorio &Directorio) const
+{
+return(Directorio.DatosEspecificos.NTFS.IndiceMFT);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverNTFS :: NormalizarNombre							*
+ *																	*
+ * OBJETIVO: Esta función lleva un nombre a la forma en que se compara dentro de un directorio.						*
+ *																	*
+ * ENTRADA: Nombre: El nombre a normalizar.												*
+ *																	*
+ * SALIDA: Nombre: El nombre normalizado.												*
+ *																	*
+ * OBSERVACIONES: NTFS no distingue mayúsculas de minúsculas: el nombre se pasa a mayúsculas con la tabla $UpCase del volumen, que	*
+ *		  es la misma con la que se ordenan los índices. Si no se pudo levantar sólo se igualan las letras ASCII.		*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverNTFS::NormalizarNombre(TString &Nombre) const
+{
+std::vector<WCHAR>	Caracteres;
+size_t			i;
+
+/* Sin la tabla, sólo ASCII */
+if (TablaMayusculas.empty())
+    {
+	for (i=0;i<Nombre.size();i++)
+		if ( (Nombre[i]>='a') && (Nombre[i]<='z') )
+			Nombre[i]-='a'-'A';
+	return;
+    }
+
+/* Pasar cada carácter UTF-16 a mayúsculas y volver a UTF-8 */
+NombreUTF16(Nombre, Caracteres);
+if (Caracteres.empty())
+	return;
+for (i=0;i<Caracteres.size();i++)
+	Caracteres[i]=TablaMayusculas[Caracteres[i]];
+NombreUTF8((const unsigned char *)&Caracteres[0], Caracteres.size(), Nombre);
 }
 
 
@@ -94,9 +2076,414 @@ return(CODERROR_NO_IMPLEMENTADO);
  * OBSERVACIONES: Los valores Data y DataLen sólo devuelven valores válidos si se retorna CODERROR_NINGUNO.				*
  *																	*
  ****************************************************************************************************************************************/
-int TDriverNTFS::LeerArchivo(const char *Path, unsigned char *&Data, unsigned &DataLen)
+int TDriverNTFS::LeerArchivo(const char *Path, unsigned char *&Data, __u64 &DataLen) const
+{
+/* Se arma con los tramos que entrega LeerArchivoPorTramos() */
+return(LeerArchivoCompleto(Path, Data, DataLen));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverNTFS :: LeerArchivoPorTramos							*
+ *																	*
+ * OBJETIVO: Esta función lee un archivo entregándolo de a tramos contiguos que apuntan directamente a la imágen.			*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo a leer. Para leer un stream con nombre se agrega al final ":stream" (o ":stream:$DATA").		*
+ *	    Receptor, pParametroUsuario: Ver TDriverBase::LeerArchivoPorTramos().							*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Sin stream se lee el atributo $DATA sin nombre. Los directorios sólo tienen streams con nombre.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::LeerArchivoPorTramos(const char *Path, TpReceptorTramo Receptor, void *pParametroUsuario) const
+{
+int					CodError;
+TEntradaDirectorio			Entrada;
+TString					Ruta, Stream;
+std::shared_ptr<const TStreamNTFS>	pStream;
+std::unique_lock<std::recursive_mutex>	Bloqueo = SerializarLectura();
+
+/* Buscar el archivo */
+if ( (CodError=SepararStream(Path, Ruta, Stream)) != CODERROR_NINGUNO )
+	return(CodError);
+if ( (CodError=BuscarEntrada(Ruta.c_str(), Entrada)) != CODERROR_NINGUNO )
+	return(CodError);
+if ( (Entrada.Flags&fedDIRECTORIO) && (Stream.empty()) )
+	return(CODERROR_ARCHIVO_INEXISTENTE);
+
+/* Levantar el stream, que tiene que ser del mismo registro al que apunta el directorio, y entregarlo */
+NormalizarNombre(Stream);
+if ( (CodError=CargarStream(Entrada.DatosEspecificos.NTFS.IndiceMFT, Entrada.DatosEspecificos.NTFS.NroSecuencia, Stream, pStream)) != CODERROR_NINGUNO )
+	return(CodError);
+return(EmitirStream(*pStream, Receptor, pParametroUsuario));
+}
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverNTFS :: RecorrerVolumen							*
+ *																	*
+ * OBJETIVO: Esta función entrega cada archivo y directorio del volumen con su ruta completa, leyendo el $MFT en orden.			*
+ *																	*
+ * ENTRADA: Receptor, pParametroUsuario: Ver TDriverBase::RecorrerVolumen().								*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: En vez de recorrer los índices de cada directorio, que salta por todo el disco, se lee el $MFT de punta a punta en	*
+ *		  lotes de NTFS_BYTES_LOTE_MFT bytes y se juntan los FILE_NAME de cada registro. Después las rutas se arman con		*
+ *		  ArmarRutaRecorrido() subiendo por el ParentDirectory de cada nombre (con su número de secuencia, así una referencia	*
+ *		  vieja no cuelga de un registro reusado).										*
+ *		  Las entradas salen en el orden del $MFT, una por cada nombre (un archivo con varios hard links sale varias veces),	*
+ *		  y no salen las que cuelgan de un directorio que ya no existe. Los lotes no dependen uno de otro, así que se reparten	*
+ *		  con EjecutarEnParalelo() a razón de una tarea por lote y los nombres se juntan en el orden de los lotes: la salida	*
+ *		  es la misma con cualquier cantidad de hilos. El recorrido sólo pasa por el cache de registros para completar los	*
+ *		  nombres que están en registros de extensión.										*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::RecorrerVolumen(TpReceptorEntrada Receptor, void *pParametroUsuario) const
+{
+int						CodError;
+TRecorridoNTFS					Recorrido;
+std::vector<TNombreMFT>				Nombres;
+std::unordered_map<__u64, __u64>		TamanosExtension;
+std::unordered_map<__u64, __u64>::iterator	itTamano;
+std::unordered_map<__u64, TDirectorioRecorrido>	Directorios;
+TDirectorioRecorrido				*pDirectorio;
+const TString					*pRuta;
+TString						Ruta;
+__u64						IndiceMFT, IdDirectorio;
+size_t						NroLote, i, j;
+bool						RaizEncontrado = false;
+std::unique_lock<std::recursive_mutex>		Bloqueo = SerializarLectura();
+
+/* Juntar los nombres de todo el $MFT, de a lotes */
+Recorrido.pDriver=this;
+Recorrido.RegistrosLote=NTFS_BYTES_LOTE_MFT/DatosFS.DatosEspecificos.NTFS.BytesPorFileRecordSegment;
+Recorrido.Lotes.resize((RegistrosMFT+Recorrido.RegistrosLote-1)/Recorrido.RegistrosLote);
+if ( (CodError=EjecutarEnParalelo(Recorrido.Lotes.size(), TareaLoteMFT, &Recorrido)) != CODERROR_NINGUNO )
+	return(CodError);
+for (NroLote=0;NroLote<Recorrido.Lotes.size();NroLote++)
+    {
+	Nombres.insert(Nombres.end(), Recorrido.Lotes[NroLote].Nombres.begin(), Recorrido.Lotes[NroLote].Nombres.end());
+	for (j=0;j<Recorrido.Lotes[NroLote].TamanosExtension.size();j++)
+		TamanosExtension[Recorrido.Lotes[NroLote].TamanosExtension[j].first]=Recorrido.Lotes[NroLote].TamanosExtension[j].second;
+    }
+Recorrido.Lotes.clear();
+
+/* Completar los nombres de los registros de extensión con los datos de su registro base (descartando los que quedaron sueltos), y
+   los tamaños de los archivos cuyo $DATA está en un registro de extensión */
+for (i=0,j=0;i<Nombres.size();i++)
+    {
+	if (Nombres[i].EnExtension)
+	    {
+		if ( (CodError=ResolverExtensionMFT(Nombres[i])) == CODERROR_FILESYSTEM_CORRUPTO )
+			continue;
+		if (CodError!=CODERROR_NINGUNO)
+			return(CodError);
+	    }
+	if ( (!(Nombres[i].Entrada.Flags&fedDIRECTORIO)) &&
+	     ((itTamano=TamanosExtension.find(NTFS_ID_REFERENCIA(Nombres[i].Entrada.DatosEspecificos.NTFS.IndiceMFT,
+								 Nombres[i].Entrada.DatosEspecificos.NTFS.NroSecuencia))) != TamanosExtension.end()) )
+		Nombres[i].Entrada.Bytes=itTamano->second;
+	if (j!=i)
+		Nombres[j]=Nombres[i];
+	j++;
+    }
+Nombres.resize(j);
+
+/* Indexar los directorios por referencia completa. El raíz ya tiene su ruta */
+for (i=0;i<Nombres.size();i++)
+    {
+	IndiceMFT=Nombres[i].Entrada.DatosEspecificos.NTFS.IndiceMFT;
+	IdDirectorio=NTFS_ID_REFERENCIA(IndiceMFT, Nombres[i].Entrada.DatosEspecificos.NTFS.NroSecuencia);
+	if ( (!(Nombres[i].Entrada.Flags&fedDIRECTORIO)) || (Directorios.count(IdDirectorio)) )
+		continue;
+	pDirectorio=&Directorios[IdDirectorio];
+	pDirectorio->IdPadre=Nombres[i].IdPadre;
+	pDirectorio->Nombre=Nombres[i].Entrada.Nombre;
+	pDirectorio->Estado=IndiceMFT==NTFS_ELEM_ROOT_DIR ? erARMADA : erSIN_ARMAR;
+	RaizEncontrado|=IndiceMFT==NTFS_ELEM_ROOT_DIR;
+    }
+if (!RaizEncontrado)
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Entregar cada nombre con la ruta de su padre */
+for (i=0;i<Nombres.size();i++)
+    {
+	if (Nombres[i].Entrada.DatosEspecificos.NTFS.IndiceMFT==NTFS_ELEM_ROOT_DIR)
+		continue;
+	if ( (CodError=ArmarRutaRecorrido(Nombres[i].IdPadre, Directorios, pRuta)) != CODERROR_NINGUNO )
+		continue;
+	Ruta=*pRuta;
+	Ruta+='/';
+	Ruta+=Nombres[i].Entrada.Nombre;
+	if ( (CodError=Receptor(Ruta, Nombres[i].Entrada, pParametroUsuario)) != CODERROR_NINGUNO )
+		return(CodError);
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverNTFS :: TareaLoteMFT							*
+ *																	*
+ * OBJETIVO: Esta función es la tarea que junta los nombres de un lote del $MFT.							*
+ *																	*
+ * ENTRADA: NroLote: Número de lote.													*
+ *	    pParametroUsuario: El TRecorridoNTFS del recorrido.										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::TareaLoteMFT(size_t NroLote, void *pParametroUsuario)
+{
+TRecorridoNTFS	*pRecorrido = (TRecorridoNTFS *)pParametroUsuario;
+__u64		Primero, Cantidad;
+
+Primero=NroLote*pRecorrido->RegistrosLote;
+Cantidad=min(pRecorrido->RegistrosLote, pRecorrido->pDriver->RegistrosMFT-Primero);
+return(pRecorrido->pDriver->EscanearLoteMFT(Primero, Cantidad, pRecorrido->Lotes[NroLote]));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverNTFS :: EscanearLoteMFT							*
+ *																	*
+ * OBJETIVO: Esta función junta los nombres de un lote de registros consecutivos del $MFT.						*
+ *																	*
+ * ENTRADA: Primero: Primer registro del lote.												*
+ *	    Cantidad: Cantidad de registros del lote.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Lote: Los nombres y tamaños de los registros en uso del lote.								*
+ *																	*
+ * OBSERVACIONES: El lote se copia de una sola vez, y recién después se corrige cada registro. Los que no tienen la firma FILE son	*
+ *		  registros que nunca se usaron, y los que tienen los fixups o los atributos mal armados no se pueden leer; todos	*
+ *		  ellos se saltean sin cortar el recorrido.										*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::EscanearLoteMFT(__u64 Primero, __u64 Cantidad, TLoteMFT &Lote) const
+{
+int					CodError;
+unsigned				BytesPorRegistro;
+size_t					NroRun, PrimerNombre, PrimerTamano;
+__u64					i;
+std::vector<unsigned char>		Buffer;
+unsigned char				*pDatos;
+const FILE_RECORD_SEGMENT_HEADER	*pRegistro;
+
+/* Copiar el lote */
+BytesPorRegistro=DatosFS.DatosEspecificos.NTFS.BytesPorFileRecordSegment;
+Buffer.resize(Cantidad*BytesPorRegistro);
+NroRun=BuscarRunMFT(Primero*BytesPorRegistro/DatosFS.BytesPorCluster);
+if ( (CodError=LeerDeRuns(RunsMFT, Primero*BytesPorRegistro, Buffer.size(), &Buffer[0], NroRun,
+			  VCNsMFT[NroRun]*DatosFS.BytesPorCluster)) != CODERROR_NINGUNO )
+	return(CodError);
+
+/* Recorrer sus registros en uso */
+for (i=0;i<Cantidad;i++)
+    {
+	pDatos=&Buffer[i*BytesPorRegistro];
+	if (ValidarRegistroMFT(pDatos)!=CODERROR_NINGUNO)
+		continue;
+	pRegistro=(const FILE_RECORD_SEGMENT_HEADER *)pDatos;
+	if (!(pRegistro->Flags&NTFS_REGISTRO_EN_USO))
+		continue;
+
+	/* Si está mal armado, descartar lo que se haya juntado de él */
+	PrimerNombre=Lote.Nombres.size();
+	PrimerTamano=Lote.TamanosExtension.size();
+	if ( (CodError=EscanearRegistroMFT(Primero+i, pRegistro, Lote)) == CODERROR_FILESYSTEM_CORRUPTO )
+	    {
+		Lote.Nombres.resize(PrimerNombre);
+		Lote.TamanosExtension.resize(PrimerTamano);
+	    }
+	else if (CodError!=CODERROR_NINGUNO)
+		return(CodError);
+    }
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverNTFS :: EscanearRegistroMFT							*
+ *																	*
+ * OBJETIVO: Esta función junta los nombres de un registro en uso del $MFT, ya corregido.						*
+ *																	*
+ * ENTRADA: IndiceMFT: Número del registro.												*
+ *	    pRegistro: El registro.													*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Lote: Los nombres del registro, y el tamaño del archivo si es de extensión y tiene el comienzo del $DATA sin nombre,		*
+ *		 agregados al final.													*
+ *																	*
+ * OBSERVACIONES: Los nombres de un registro de extensión salen con la referencia del registro base y marcados con EnExtension, así	*
+ *		  RecorrerVolumen() los completa con los datos del registro base. El tamaño del FILE_NAME de un registro no siempre	*
+ *		  está actualizado, así que para los archivos se toma el del $DATA sin nombre si está en el registro base.		*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::EscanearRegistroMFT(__u64 IndiceMFT, const FILE_RECORD_SEGMENT_HEADER *pRegistro, TLoteMFT &Lote) const
 {
+int				CodError;
+unsigned			Offset;
+size_t				PrimerNombre, j;
+const ATTRIBUTE_RECORD_HEADER	*pAtributo;
+const FILE_NAME			*pNombre;
+const unsigned char		*pValor;
+__u32				Bytes;
+FILE_REFERENCE			Referencia;
+bool				EnExtension;
+
+/* Los nombres de un registro de extensión son del registro base */
+EnExtension=(pRegistro->BaseFileRecordSegment.MFTIndex) || (pRegistro->BaseFileRecordSegment.Sequence);
+if (EnExtension)
+	Referencia=pRegistro->BaseFileRecordSegment;
+else
+    {
+	Referencia.MFTIndex=IndiceMFT;
+	Referencia.Sequence=pRegistro->SequenceNumber;
+    }
+
+/* Agregar sus nombres, salvo los cortos que acompañan a uno largo. En uno de extensión también buscar el $DATA sin nombre */
+PrimerNombre=Lote.Nombres.size();
+for (Offset=pRegistro->FirstAttributeOffset;Offset+2*sizeof(ULONG)<=pRegistro->RealSizeOfFileRecord;Offset+=pAtributo->RecordLength)
+    {
+	pAtributo=(const ATTRIBUTE_RECORD_HEADER *)((const unsigned char *)pRegistro+Offset);
+	if ( (pAtributo->TypeCode==NTFS_STRUCT_END) || (pAtributo->TypeCode>(EnExtension ? NTFS_STRUCT_DATA : NTFS_STRUCT_FILE_NAME)) )
+		break;
+	if ( (pAtributo->RecordLength<offsetof(ATTRIBUTE_RECORD_HEADER, Form.Resident.Padding)) || (pAtributo->RecordLength&7) ||
+	     (Offset+pAtributo->RecordLength>pRegistro->RealSizeOfFileRecord) )
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	if ( (pAtributo->TypeCode==NTFS_STRUCT_DATA) && (!pAtributo->NameLength) )
+	    {
+		if (!pAtributo->NonResidentFlag)
+			Lote.TamanosExtension.push_back(std::make_pair(NTFS_ID_REFERENCIA(Referencia.MFTIndex, Referencia.Sequence),
+								       (__u64)pAtributo->Form.Resident.ValueLength));
+		else if (!pAtributo->Form.NonResident.FirstVCN)
+			Lote.TamanosExtension.push_back(std::make_pair(NTFS_ID_REFERENCIA(Referencia.MFTIndex, Referencia.Sequence),
+								       (__u64)pAtributo->Form.NonResident.RealSize));
+		continue;
+	    }
+	if (pAtributo->TypeCode!=NTFS_STRUCT_FILE_NAME)
+		continue;
+	if ( (CodError=ValorResidente(pAtributo, pValor, Bytes)) != CODERROR_NINGUNO )
+		return(CodError);
+	pNombre=(const FILE_NAME *)pValor;
+	if ( (Bytes<offsetof(FILE_NAME, FileName)) || (Bytes<offsetof(FILE_NAME, FileName)+pNombre->FileNameLength*sizeof(WCHAR)) )
+		return(CODERROR_FILESYSTEM_CORRUPTO);
+	if (pNombre->Flags==NTFS_NOMBRE_DOS)
+		continue;
+	Lote.Nombres.push_back(TNombreMFT());
+	Lote.Nombres.back().IdPadre=NTFS_ID_REFERENCIA(pNombre->ParentDirectory.MFTIndex, pNombre->ParentDirectory.Sequence);
+	Lote.Nombres.back().EnExtension=EnExtension;
+	CompletarEntrada(Referencia, pNombre, Lote.Nombres.back().Entrada);
+	if (pRegistro->Flags&NTFS_REGISTRO_DIRECTORIO)
+		Lote.Nombres.back().Entrada.Flags|=fedDIRECTORIO;
+    }
+
+/* Corregir el tamaño de los archivos con el $DATA del registro base */
+if ( (EnExtension) || (PrimerNombre==Lote.Nombres.size()) || (pRegistro->Flags&NTFS_REGISTRO_DIRECTORIO) )
+	return(CODERROR_NINGUNO);
+if ( (CodError=BuscarAtributo(pRegistro, NTFS_STRUCT_DATA, "", pAtributo)) == CODERROR_NO_ENCONTRADO )
+	return(CODERROR_NINGUNO);
+if (CodError!=CODERROR_NINGUNO)
+	return(CodError);
+if ( (pAtributo->NonResidentFlag) && (pAtributo->Form.NonResident.FirstVCN) )
+	return(CODERROR_NINGUNO);
+for (j=PrimerNombre;j<Lote.Nombres.size();j++)
+	Lote.Nombres[j].Entrada.Bytes=pAtributo->NonResidentFlag ? pAtributo->Form.NonResident.RealSize : pAtributo->Form.Resident.ValueLength;
+
 /* Salir */
-return(CODERROR_NO_IMPLEMENTADO);
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TDriverNTFS :: ResolverExtensionMFT							*
+ *																	*
+ * OBJETIVO: Esta función completa un nombre encontrado en un registro de extensión con los datos de su registro base.			*
+ *																	*
+ * ENTRADA: Nombre: El nombre, con la referencia del registro base.									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, CODERROR_FILESYSTEM_CORRUPTO si el registro base ya no	*
+ *	   existe (el nombre se descarta), caso contrario el código de error.								*
+ *	   Nombre: El nombre, marcado como directorio si el registro base lo es.							*
+ *																	*
+ * OBSERVACIONES: El registro base se lee del cache de registros. Tiene que estar en uso, con la misma secuencia, y no ser él mismo	*
+ *		  de extensión.														*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::ResolverExtensionMFT(TNombreMFT &Nombre) const
+{
+int					CodError;
+TRegistroMFT				Registro;
+const FILE_RECORD_SEGMENT_HEADER	*pRegistro;
+
+/* Levantar el registro base */
+if ( (CodError=LeerRegistroMFT(Nombre.Entrada.DatosEspecificos.NTFS.IndiceMFT, Nombre.Entrada.DatosEspecificos.NTFS.NroSecuencia,
+			       Registro, pRegistro)) != CODERROR_NINGUNO )
+	return(CodError);
+if ( (!(pRegistro->Flags&NTFS_REGISTRO_EN_USO)) || (pRegistro->BaseFileRecordSegment.MFTIndex) ||
+     (pRegistro->BaseFileRecordSegment.Sequence) )
+	return(CODERROR_FILESYSTEM_CORRUPTO);
+
+/* Tomar lo que no está en el FILE_NAME */
+if (pRegistro->Flags&NTFS_REGISTRO_DIRECTORIO)
+	Nombre.Entrada.Flags|=fedDIRECTORIO;
+return(CODERROR_NINGUNO);
 }
 
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverNTFS :: MostrarEstadisticas							*
+ *																	*
+ * OBJETIVO: Esta función muestra los contadores de los caches, agregando los del cache de registros del $MFT a los de la clase base.	*
+ *																	*
+ * ENTRADA: f: Archivo donde imprimir.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverNTFS::MostrarEstadisticas(FILE *f) const
+{
+__u64	Aciertos, Fallos, Total;
+
+/* Mostrar los de la clase base */
+TDriverBase::MostrarEstadisticas(f);
+
+/* Mostrar los del cache de registros */
+Aciertos=CacheRegistros.Aciertos();
+Fallos=CacheRegistros.Fallos();
+Total=Aciertos+Fallos;
+fprintf(f, "Estadísticas del cache de registros del $MFT:\n");
+fprintf(f, "\tAciertos                : %llu\n", Aciertos);
+fprintf(f, "\tFallos                  : %llu\n", Fallos);
+fprintf(f, "\tTasa de aciertos        : %.2f%%\n", Total ? (100.0*Aciertos)/Total : 0.0);
+fprintf(f, "\tEntradas en cache       : %llu de %d\n", (__u64)CacheRegistros.Entradas(), MAXIMO_REGISTROS_CACHE);
+fprintf(f, "\tRuns del $MFT           : %llu\n", (__u64)RunsMFT.size());
+
+/* Los del cache de streams */
+Aciertos=CacheStreams.Aciertos();
+Fallos=CacheStreams.Fallos();
+Total=Aciertos+Fallos;
+fprintf(f, "Estadísticas del cache de streams:\n");
+fprintf(f, "\tAciertos                : %llu\n", Aciertos);
+fprintf(f, "\tFallos                  : %llu\n", Fallos);
+fprintf(f, "\tTasa de aciertos        : %.2f%%\n", Total ? (100.0*Aciertos)/Total : 0.0);
+fprintf(f, "\tEntradas en cache       : %llu de %d\n", (__u64)CacheStreams.Entradas(), MAXIMO_STREAMS_CACHE);
+
+/* Y los de los índices de los directorios */
+fprintf(f, "Estadísticas de los índices de directorios:\n");
+fprintf(f, "\tBuffers de índice leídos: %llu\n", BuffersIndiceLeidos.load());
+fprintf(f, "\tTabla $UpCase           : %s\n", TablaMayusculas.empty() ? "no disponible" : "cargada");
+}
@@ -0,0 +1,595 @@
+#include "all_heads.h"
+
+
+/********************************
+ *				*
+ *     Clase TFuenteBloques	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *						    TFuenteBloques :: TFuenteBloques							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteBloques::TFuenteBloques()
+{
+/* Inicializar variables */
+LongitudImagen=0;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TFuenteBloques :: ~TFuenteBloques							*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteBloques::~TFuenteBloques()
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TFuenteBloques :: RangoValido							*
+ *																	*
+ * OBJETIVO: Esta función determina si un rango de bytes cae completo dentro de la imágen.						*
+ *																	*
+ * ENTRADA: Offset: Posición, en bytes, del comienzo del rango.										*
+ *	    Bytes: Longitud del rango.													*
+ *																	*
+ * SALIDA: En el nombre de la función true si el rango es válido.									*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TFuenteBloques::RangoValido(__u64 Offset, __u64 Bytes)
+{
+/* Cuidado con el overflow de Offset+Bytes */
+return( (Bytes<=LongitudImagen) && (Offset<=LongitudImagen-Bytes) );
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TFuenteBloques :: MostrarEstadisticas							*
+ *																	*
+ * OBJETIVO: Esta función muestra las estadísticas de uso de la fuente. Las fuentes que no tienen cache no tienen nada que mostrar.	*
+ *																	*
+ * ENTRADA: f: Archivo donde imprimir.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TFuenteBloques::MostrarEstadisticas(FILE *f)
+{
+}
+
+
+/****************************************
+ *					*
+ *     Clase TFuenteBloquesMemoria	*
+ *					*
+ ****************************************/
+/****************************************************************************************************************************************
+ *																	*
+ *					     TFuenteBloquesMemoria :: TFuenteBloquesMemoria						*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteBloquesMemoria::TFuenteBloquesMemoria()
+{
+/* Inicializar variables */
+DiskData=NULL;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *					    TFuenteBloquesMemoria :: ~TFuenteBloquesMemoria						*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteBloquesMemoria::~TFuenteBloquesMemoria()
+{
+/* Liberar la imágen si está cargada */
+if (DiskData)
+	free((void *)DiskData);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TFuenteBloquesMemoria :: Abrir							*
+ *																	*
+ * OBJETIVO: Esta función lee una imágen de disco completa a memoria.									*
+ *																	*
+ * ENTRADA: Ruta: Ruta al archivo binario a cargar.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TFuenteBloquesMemoria::Abrir(const char *Ruta)
+{
+int		CodError = CODERROR_NINGUNO;
+FILE		*f;
+
+/* Abrir el archivo de entrada */
+if ( (f=fopen(Ruta, "rb")) == NULL )
+	return(CODERROR_ARCHIVO_INEXISTENTE);
+
+/* Determinar el tamaño */
+fseek(f, 0, SEEK_END);
+LongitudImagen=ftell(f);
+fseek(f, 0, SEEK_SET);
+
+/* Validar la longitud del archivo */
+if ( (LongitudImagen%512) != 0 )
+    {
+	/* No puede no ser múltiplo de sector */
+	CodError = CODERROR_ARCHIVO_INVALIDO;
+    }
+else
+    {
+	/* Alocar memoria para almacenarlo */
+	if ( (DiskData=(const unsigned char *)malloc(LongitudImagen)) == NULL )
+	    {
+		/* No hay suficiente memoria */
+		CodError = CODERROR_FALTA_MEMORIA;
+	    }
+	else
+	    {
+		/* Levantar el archivo a memoria */
+		if ( fread((void *)DiskData, 1, LongitudImagen, f) != LongitudImagen )
+		    {
+			/* Error al levantar el archivo */
+			CodError = CODERROR_LECTURA_DISCO;
+		    }
+	    }
+    }
+
+/* Cerrar el archivo de entrada */
+fclose(f);
+
+/* Salir */
+return(CodError);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TFuenteBloquesMemoria :: Puntero							*
+ *																	*
+ * OBJETIVO: Esta función devuelve un puntero a un rango de bytes de la imágen.								*
+ *																	*
+ * ENTRADA: Offset: Posición, en bytes, del comienzo del rango.										*
+ *	    Bytes: Longitud del rango.													*
+ *																	*
+ * SALIDA: En el nombre de la función el puntero, o NULL si el rango no está dentro de la imágen.					*
+ *																	*
+ * OBSERVACIONES: Como la imágen está completa en memoria el puntero es válido mientras la fuente exista.				*
+ *																	*
+ ****************************************************************************************************************************************/
+const unsigned char *TFuenteBloquesMemoria::Puntero(__u64 Offset, __u64 Bytes)
+{
+/* Ver si tengo imágen cargada y si el rango existe */
+if ( (!DiskData) || (!RangoValido(Offset, Bytes)) )
+	return(NULL);
+
+/* Retornar el puntero solicitado */
+return(DiskData+Offset);
+}
+
+
+/****************************************
+ *					*
+ *     Clase TFuenteBloquesMapeada	*
+ *					*
+ ****************************************/
+/****************************************************************************************************************************************
+ *																	*
+ *					     TFuenteBloquesMapeada :: TFuenteBloquesMapeada						*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteBloquesMapeada::TFuenteBloquesMapeada()
+{
+/* Inicializar variables */
+ImagenMapeada=false;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *					    TFuenteBloquesMapeada :: ~TFuenteBloquesMapeada						*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteBloquesMapeada::~TFuenteBloquesMapeada()
+{
+/* Si la imágen está mapeada hay que desmapearla (y que la clase base no intente liberarla) */
+if ( (ImagenMapeada) && (DiskData) )
+    {
+	munmap((void *)DiskData, LongitudImagen);
+	DiskData=NULL;
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TFuenteBloquesMapeada :: Abrir							*
+ *																	*
+ * OBJETIVO: Esta función mapea una imágen de disco en memoria de sólo lectura.								*
+ *																	*
+ * ENTRADA: Ruta: Ruta al archivo binario a cargar.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: La carga no lee nada del disco: las páginas se levantan recién cuando algún driver las toca. Si no se puede mapear	*
+ *		  se la lee completa a memoria.												*
+ *																	*
+ ****************************************************************************************************************************************/
+int TFuenteBloquesMapeada::Abrir(const char *Ruta)
+{
+int		CodError = CODERROR_NINGUNO;
+FILE		*f;
+void		*pMapeo;
+
+/* Abrir el archivo de entrada */
+if ( (f=fopen(Ruta, "rb")) == NULL )
+	return(CODERROR_ARCHIVO_INEXISTENTE);
+
+/* Determinar el tamaño */
+fseek(f, 0, SEEK_END);
+LongitudImagen=ftell(f);
+fseek(f, 0, SEEK_SET);
+
+/* Validar la longitud del archivo */
+if ( (LongitudImagen%512) != 0 )
+    {
+	/* No puede no ser múltiplo de sector */
+	CodError = CODERROR_ARCHIVO_INVALIDO;
+    }
+else
+    {
+	/* Intentar mapear la imágen completa como sólo lectura */
+	pMapeo=LongitudImagen ? mmap(NULL, LongitudImagen, PROT_READ, MAP_PRIVATE, fileno(f), 0) : MAP_FAILED;
+	if (pMapeo!=MAP_FAILED)
+	    {
+		/* Los drivers saltan por toda la imágen siguiendo metadatos, no tiene sentido el read-ahead */
+		madvise(pMapeo, LongitudImagen, MADV_RANDOM);
+
+		/* Pero el comienzo (boot sector, superbloque, descriptores de grupo) se lee siempre, pedirlo ya */
+		madvise(pMapeo, LongitudImagen<LONGITUD_PRECARGA_IMAGEN ? LongitudImagen : LONGITUD_PRECARGA_IMAGEN, MADV_WILLNEED);
+
+		DiskData=(const unsigned char *)pMapeo;
+		ImagenMapeada=true;
+	    }
+    }
+
+/* Cerrar el archivo de entrada (el mapeo sigue siendo válido) */
+fclose(f);
+
+/* Si no se pudo mapear, leerla completa */
+if ( (CodError==CODERROR_NINGUNO) && (!ImagenMapeada) )
+	CodError=TFuenteBloquesMemoria::Abrir(Ruta);
+
+/* Salir */
+return(CodError);
+}
+
+
+/****************************************
+ *					*
+ *      Clase TFuenteBloquesPRead	*
+ *					*
+ ****************************************/
+/****************************************************************************************************************************************
+ *																	*
+ *					       TFuenteBloquesPRead :: TFuenteBloquesPRead						*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: BytesCache: Memoria máxima, en bytes, a usar para el cache de líneas.							*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteBloquesPRead::TFuenteBloquesPRead(__u64 BytesCache)
+{
+/* Inicializar variables */
+Archivo=NULL;
+BytesMaximosCache=BytesCache;
+BytesEnCache=0;
+pLecturaGrande=NULL;
+BytesLecturaGrande=0;
+Aciertos=0;
+Fallos=0;
+Desalojos=0;
+BytesLeidos=0;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *					      TFuenteBloquesPRead :: ~TFuenteBloquesPRead						*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteBloquesPRead::~TFuenteBloquesPRead()
+{
+/* Liberar el cache */
+VaciarCache();
+if (pLecturaGrande)
+	free(pLecturaGrande);
+
+/* Cerrar la imágen */
+if (Archivo)
+	fclose(Archivo);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TFuenteBloquesPRead :: Abrir								*
+ *																	*
+ * OBJETIVO: Esta función abre una imágen de disco para leerla a pedido.								*
+ *																	*
+ * ENTRADA: Ruta: Ruta al archivo binario a cargar.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TFuenteBloquesPRead::Abrir(const char *Ruta)
+{
+/* Abrir el archivo de entrada, queda abierto mientras exista la fuente */
+if ( (Archivo=fopen(Ruta, "rb")) == NULL )
+	return(CODERROR_ARCHIVO_INEXISTENTE);
+
+/* Determinar el tamaño */
+fseek(Archivo, 0, SEEK_END);
+LongitudImagen=ftell(Archivo);
+fseek(Archivo, 0, SEEK_SET);
+
+/* Validar la longitud del archivo */
+if ( (LongitudImagen%512) != 0 )
+	return(CODERROR_ARCHIVO_INVALIDO);
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TFuenteBloquesPRead :: LeerRango							*
+ *																	*
+ * OBJETIVO: Esta función lee un rango de la imágen con pread(), reintentando las lecturas parciales.					*
+ *																	*
+ * ENTRADA: Offset: Posición, en bytes, del comienzo del rango.										*
+ *	    Bytes: Longitud del rango.													*
+ *	    pDestino: Buffer donde dejar los datos.											*
+ *																	*
+ * SALIDA: En el nombre de la función true si se pudo leer todo el rango.								*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TFuenteBloquesPRead::LeerRango(__u64 Offset, __u64 Bytes, unsigned char *pDestino)
+{
+ssize_t		Leidos;
+
+/* Leer hasta completar el rango */
+while (Bytes)
+    {
+	if ( (Leidos=pread(fileno(Archivo), pDestino, Bytes, Offset)) <= 0 )
+		return(false);
+	pDestino+=Leidos;
+	Offset+=Leidos;
+	Bytes-=Leidos;
+	BytesLeidos+=Leidos;
+    }
+
+/* Salir */
+return(true);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TFuenteBloquesPRead :: Puntero							*
+ *																	*
+ * OBJETIVO: Esta función devuelve un puntero a un rango de bytes de la imágen, levantándolo al cache si no estaba.			*
+ *																	*
+ * ENTRADA: Offset: Posición, en bytes, del comienzo del rango.										*
+ *	    Bytes: Longitud del rango.													*
+ *																	*
+ * SALIDA: En el nombre de la función el puntero, o NULL si el rango no está dentro de la imágen o no se pudo leer.			*
+ *																	*
+ * OBSERVACIONES: El cache trabaja con líneas de BYTES_POR_LINEA_CACHE bytes alineadas. Una lectura que cruza varias líneas se guarda	*
+ *		  como una única línea larga, para que el puntero devuelto sea contiguo.						*
+ *		  IMPORTANTE: el puntero no vale para siempre. El de una línea del cache vale hasta que se usan otras			*
+ *		  LINEAS_CACHE_PROTEGIDAS líneas distintas después de ella. Las lecturas de BYTES_LECTURA_GRANDE o más (o de más de	*
+ *		  la cuarta parte del cache) no se guardan: comparten un único buffer y su puntero deja de valer con la próxima		*
+ *		  lectura grande. Quien tenga que usar dos lecturas grandes a la vez debe copiar la primera antes de pedir la segunda.	*
+ *																	*
+ ****************************************************************************************************************************************/
+const unsigned char *TFuenteBloquesPRead::Puntero(__u64 Offset, __u64 Bytes)
+{
+__u64		LineaInicial, CantidadLineas;
+__u64		OffsetLinea, BytesLinea;
+__u64		Clave;
+TLineaCache	Linea;
+std::unordered_map<__u64, std::list<TLineaCache>::iterator>::iterator	itIndice;
+
+/* Ver si tengo imágen abierta y si el rango existe */
+if ( (!Archivo) || (!RangoValido(Offset, Bytes)) )
+	return(NULL);
+if (!Bytes)
+	Bytes=1;
+
+/* Determinar las líneas que abarca el rango */
+LineaInicial=Offset/BYTES_POR_LINEA_CACHE;
+CantidadLineas=(Offset+Bytes-1)/BYTES_POR_LINEA_CACHE-LineaInicial+1;
+OffsetLinea=LineaInicial*BYTES_POR_LINEA_CACHE;
+BytesLinea=CantidadLineas*BYTES_POR_LINEA_CACHE;
+if (BytesLinea>LongitudImagen-OffsetLinea)
+	BytesLinea=LongitudImagen-OffsetLinea;
+
+/* Las lecturas grandes no pasan por el cache, sólo desplazarían todo lo demás */
+if ( (BytesLinea>=BYTES_LECTURA_GRANDE) || (BytesLinea>BytesMaximosCache/4) )
+    {
+	Fallos++;
+	if (Bytes>BytesLecturaGrande)
+	    {
+		free(pLecturaGrande);
+		if ( (pLecturaGrande=(unsigned char *)malloc(Bytes)) == NULL )
+		    {
+			BytesLecturaGrande=0;
+			return(NULL);
+		    }
+		BytesLecturaGrande=Bytes;
+	    }
+	return(LeerRango(Offset, Bytes, pLecturaGrande) ? pLecturaGrande : NULL);
+    }
+
+/* Buscar la línea en el cache */
+Clave=(LineaInicial<<20)|CantidadLineas;
+if ( (itIndice=IndiceLineas.find(Clave)) != IndiceLineas.end() )
+    {
+	/* Está, pasarla al frente de la lista LRU */
+	Aciertos++;
+	Lineas.splice(Lineas.begin(), Lineas, itIndice->second);
+	return(itIndice->second->pDatos+(Offset-OffsetLinea));
+    }
+
+/* No está, levantarla */
+Fallos++;
+Linea.Clave=Clave;
+Linea.Bytes=BytesLinea;
+if ( (Linea.pDatos=(unsigned char *)malloc(BytesLinea)) == NULL )
+	return(NULL);
+if (!LeerRango(OffsetLinea, BytesLinea, Linea.pDatos))
+    {
+	free(Linea.pDatos);
+	return(NULL);
+    }
+
+/* Agregarla al frente y hacer lugar si hace falta */
+Lineas.push_front(Linea);
+IndiceLineas[Clave]=Lineas.begin();
+BytesEnCache+=BytesLinea;
+Desalojar();
+
+/* Salir */
+return(Linea.pDatos+(Offset-OffsetLinea));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TFuenteBloquesPRead :: Desalojar							*
+ *																	*
+ * OBJETIVO: Esta función libera las líneas menos usadas recientemente hasta que el cache entre en su tamaño máximo.			*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TFuenteBloquesPRead::Desalojar(void)
+{
+/* Las últimas LINEAS_CACHE_PROTEGIDAS líneas nunca se desalojan, alguien puede estar usando sus punteros */
+while ( (BytesEnCache>BytesMaximosCache) && (Lineas.size()>LINEAS_CACHE_PROTEGIDAS) )
+    {
+	BytesEnCache-=Lineas.back().Bytes;
+	IndiceLineas.erase(Lineas.back().Clave);
+	free(Lineas.back().pDatos);
+	Lineas.pop_back();
+	Desalojos++;
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TFuenteBloquesPRead :: VaciarCache							*
+ *																	*
+ * OBJETIVO: Esta función libera todas las líneas del cache.										*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TFuenteBloquesPRead::VaciarCache(void)
+{
+std::list<TLineaCache>::iterator	it;
+
+/* Liberar cada línea */
+for(it=Lineas.begin();it!=Lineas.end();it++)
+	free(it->pDatos);
+Lineas.clear();
+IndiceLineas.clear();
+BytesEnCache=0;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *					       TFuenteBloquesPRead :: MostrarEstadisticas						*
+ *																	*
+ * OBJETIVO: Esta función muestra los contadores del cache, para poder dimensionarlo.							*
+ *																	*
+ * ENTRADA: f: Archivo donde imprimir.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TFuenteBloquesPRead::MostrarEstadisticas(FILE *f)
+{
+__u64	Total;
+
+/* Mostrar los contadores */
+Total=Aciertos+Fallos;
+fprintf(f, "Estadísticas del cache de lectura:\n");
+fprintf(f, "\tAciertos                : %llu\n", Aciertos);
+fprintf(f, "\tFallos                  : %llu\n", Fallos);
+fprintf(f, "\tTasa de aciertos        : %.2f%%\n", Total ? (100.0*Aciertos)/Total : 0.0);
+fprintf(f, "\tDesalojos               : %llu\n", Desalojos);
+fprintf(f, "\tBytes leídos de disco   : %llu\n", BytesLeidos);
+fprintf(f, "\tBytes en cache          : %llu de %llu\n", BytesEnCache, BytesMaximosCache);
+}
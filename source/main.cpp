@@ -3,14 +3,58 @@
 int main(int argc, char *argv[])
 {
 int		CodError;
+int		Opcion;
+TModoCarga	ModoCarga = mcMAPEADA;
+__u64		BytesCache = BYTES_CACHE_POR_OMISION;
+bool		MostrarEstadisticas = false;
+unsigned	Hilos = 0;
+bool		EnLote = false;
+bool		Agrupar = false;
 TAnalizadorFS	AnalizadorFS;
 
-/* Analizar los parámetros */
-if (argc!=2)
+/* Analizar los parámetros: [-m memoria|mmap|pread] [-c MiB de cache] [-e] [-t hilos] [-b] [-g] <imagen> */
+while ( (Opcion=getopt(argc, argv, "m:c:et:bg")) != -1 )
+    {
+	switch (Opcion)
+	    {
+		case 'm':
+			if (!strcasecmp(optarg, "memoria"))
+				ModoCarga=mcMEMORIA;
+			else if (!strcasecmp(optarg, "mmap"))
+				ModoCarga=mcMAPEADA;
+			else if (!strcasecmp(optarg, "pread"))
+				ModoCarga=mcPREAD;
+			else
+				return(CODERROR_PARAMETROS_INVALIDOS);
+			break;
+		case 'c':
+			if ( (BytesCache=strtoull(optarg, NULL, 10)*1024*1024) == 0 )
+				return(CODERROR_PARAMETROS_INVALIDOS);
+			break;
+		case 'e':
+			MostrarEstadisticas=true;
+			break;
+		case 't':
+			Hilos=strtoul(optarg, NULL, 10);
+			break;
+		case 'b':
+			EnLote=true;
+			break;
+		case 'g':
+			EnLote=Agrupar=true;
+			break;
+		default:
+			return(CODERROR_PARAMETROS_INVALIDOS);
+	    }
+    }
+if (optind!=argc-1)
 	return(CODERROR_PARAMETROS_INVALIDOS);
 
 /* Ejeuctar la clase que busca el driver adecuado y luego analiza la imágen */
-CodError=AnalizadorFS.Ejecutar(argv[1]);
+AnalizadorFS.ConfigurarCarga(ModoCarga, BytesCache, MostrarEstadisticas);
+AnalizadorFS.ConfigurarHilos(Hilos);
+AnalizadorFS.ConfigurarLote(EnLote, Agrupar);
+CodError=AnalizadorFS.Ejecutar(argv[optind]);
 
 /* Imprimir un mensaje final */
 printf("El programa termina con resultado %d.\r\n", CodError);
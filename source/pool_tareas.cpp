@@ -0,0 +1,287 @@
+#include "all_heads.h"
+
+
+/********************************
+ *				*
+ *      Clase TPoolTareas	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *						      TPoolTareas :: TPoolTareas							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada, arrancando los hilos que van a esperar tareas.						*
+ *																	*
+ * ENTRADA: Hilos: Cantidad de hilos, contando al que llama a Ejecutar() (0 = uno por núcleo).						*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TPoolTareas::TPoolTareas(unsigned Hilos)
+{
+unsigned	i;
+
+/* Un hilo por núcleo si no se pide otra cosa */
+if (!Hilos)
+	Hilos=std::thread::hardware_concurrency();
+if (!Hilos)
+	Hilos=1;
+CantidadHilos=Hilos<MAXIMO_HILOS_POOL ? Hilos : MAXIMO_HILOS_POOL;
+
+/* Inicializar variables */
+Colas=new TColaTareas[CantidadHilos];
+for (i=0;i<CantidadHilos;i++)
+	Colas[i].Primera=Colas[i].Fin=0;
+NroTanda=0;
+HilosOcupados=0;
+Terminar=false;
+Tarea=NULL;
+pParametroUsuario=NULL;
+PrimeraFallida=0;
+CodErrorFallida=CODERROR_NINGUNO;
+
+/* El que llama a Ejecutar() hace de hilo 0 */
+for (i=1;i<CantidadHilos;i++)
+	Trabajadores.push_back(std::thread(Hilo, this, i));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TPoolTareas :: ~TPoolTareas							*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados, esperando que terminen los hilos.								*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TPoolTareas::~TPoolTareas()
+{
+size_t	i;
+
+/* Avisarles a los hilos que terminen y esperarlos */
+    {
+	std::lock_guard<std::mutex>	Bloqueo(Mutex);
+	Terminar=true;
+    }
+HayTanda.notify_all();
+for (i=0;i<Trabajadores.size();i++)
+	Trabajadores[i].join();
+delete[] Colas;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TPoolTareas :: Ejecutar								*
+ *																	*
+ * OBJETIVO: Esta función ejecuta una tanda de tareas independientes repartiéndolas entre los hilos, y espera a que terminen.		*
+ *																	*
+ * ENTRADA: Tareas: Cantidad de tareas. Cada una se identifica por su número, de 0 a Tareas-1.						*
+ *	    Tarea: Función que ejecuta cada tarea.											*
+ *	    pParametroUsuario: Valor que se le pasa sin modificar a cada tarea.								*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si todas las tareas terminaron bien, caso contrario el error de la primera	*
+ *	   (por número) que falló.													*
+ *																	*
+ * OBSERVACIONES: Cada hilo arranca con un tramo consecutivo de tareas y, cuando se le acaba, le roba la mitad de lo que le queda a	*
+ *		  otro hilo. Cuando una tarea falla no se empiezan las que tienen un número mayor, pero sí las anteriores, así el	*
+ *		  error que se devuelve es el mismo que si se ejecutaran en orden en un solo hilo. Cada tarea debe dejar sus		*
+ *		  resultados aparte (por ejemplo en un arreglo indexado por número de tarea), para juntarlos en orden al terminar.	*
+ *		  No es reentrante: una tarea no puede llamar a Ejecutar() del mismo pool.						*
+ *																	*
+ ****************************************************************************************************************************************/
+int TPoolTareas::Ejecutar(size_t Tareas, TpTarea Tarea, void *pParametroUsuario)
+{
+int		CodError;
+size_t		i;
+unsigned	j;
+
+/* Con un solo hilo, o una sola tarea, no hace falta repartir nada */
+if ( (CantidadHilos==1) || (Tareas<=1) )
+    {
+	for (i=0;i<Tareas;i++)
+		if ( (CodError=Tarea(i, pParametroUsuario)) != CODERROR_NINGUNO )
+			return(CodError);
+	return(CODERROR_NINGUNO);
+    }
+
+/* Repartir las tareas en tramos consecutivos y despertar a los hilos */
+    {
+	std::lock_guard<std::mutex>	Bloqueo(Mutex);
+	TPoolTareas::Tarea=Tarea;
+	TPoolTareas::pParametroUsuario=pParametroUsuario;
+	PrimeraFallida=Tareas;
+	CodErrorFallida=CODERROR_NINGUNO;
+	for (j=0;j<CantidadHilos;j++)
+	    {
+		std::lock_guard<std::mutex>	BloqueoCola(Colas[j].Mutex);
+		Colas[j].Primera=Tareas*j/CantidadHilos;
+		Colas[j].Fin=Tareas*(j+1)/CantidadHilos;
+	    }
+	HilosOcupados=CantidadHilos-1;
+	NroTanda++;
+    }
+HayTanda.notify_all();
+
+/* Trabajar como uno más y esperar a los demás */
+Trabajar(0);
+    {
+	std::unique_lock<std::mutex>	Bloqueo(Mutex);
+	while (HilosOcupados)
+		TandaTerminada.wait(Bloqueo);
+    }
+
+/* Salir */
+return(CodErrorFallida);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TPoolTareas :: Trabajar								*
+ *																	*
+ * OBJETIVO: Esta función ejecuta tareas de la tanda en curso hasta que no queda ninguna, ni propia ni para robar.			*
+ *																	*
+ * ENTRADA: NroHilo: Número del hilo que trabaja.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TPoolTareas::Trabajar(unsigned NroHilo)
+{
+int	CodError;
+size_t	NroTarea;
+
+while (TomarTarea(NroHilo, NroTarea))
+    {
+	/* Las que vienen después de una que falló ya no importan */
+	if (NroTarea>PrimeraFallida)
+		continue;
+	if ( (CodError=Tarea(NroTarea, pParametroUsuario)) != CODERROR_NINGUNO )
+		RegistrarError(NroTarea, CodError);
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TPoolTareas :: TomarTarea								*
+ *																	*
+ * OBJETIVO: Esta función saca la próxima tarea de la cola de un hilo o, si está vacía, de la de otro.					*
+ *																	*
+ * ENTRADA: NroHilo: Número del hilo que pide la tarea.											*
+ *																	*
+ * SALIDA: En el nombre de la función false si no quedan tareas en ninguna cola.							*
+ *	   NroTarea: La tarea a ejecutar.												*
+ *																	*
+ * OBSERVACIONES: Las propias se toman desde adelante, en orden. A otro hilo se le roba la mitad de atrás de su cola: la primera de	*
+ *		  las robadas se ejecuta y el resto pasa a la cola propia. Nunca se bloquean dos colas a la vez, y sólo el dueño de	*
+ *		  una cola vacía la vuelve a llenar, así que ninguna tarea se pierde ni se ejecuta dos veces.				*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TPoolTareas::TomarTarea(unsigned NroHilo, size_t &NroTarea)
+{
+TColaTareas	*pCola;
+size_t		Robadas;
+unsigned	i;
+
+/* Primero las propias */
+    {
+	std::lock_guard<std::mutex>	Bloqueo(Colas[NroHilo].Mutex);
+	if (Colas[NroHilo].Primera<Colas[NroHilo].Fin)
+	    {
+		NroTarea=Colas[NroHilo].Primera++;
+		return(true);
+	    }
+    }
+
+/* Si no, robarle a otro, empezando por el siguiente */
+for (i=1;i<CantidadHilos;i++)
+    {
+	pCola=&Colas[(NroHilo+i)%CantidadHilos];
+	    {
+		std::lock_guard<std::mutex>	Bloqueo(pCola->Mutex);
+		if (pCola->Primera>=pCola->Fin)
+			continue;
+		Robadas=(pCola->Fin-pCola->Primera+1)/2;
+		pCola->Fin-=Robadas;
+		NroTarea=pCola->Fin;
+	    }
+	if (Robadas>1)
+	    {
+		std::lock_guard<std::mutex>	Bloqueo(Colas[NroHilo].Mutex);
+		Colas[NroHilo].Primera=NroTarea+1;
+		Colas[NroHilo].Fin=NroTarea+Robadas;
+	    }
+	return(true);
+    }
+
+/* Salir */
+return(false);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TPoolTareas :: RegistrarError							*
+ *																	*
+ * OBJETIVO: Esta función anota el error de una tarea si es la primera (por número) que falló hasta ahora.				*
+ *																	*
+ * ENTRADA: NroTarea: La tarea que falló.												*
+ *	    CodError: Su código de error.												*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TPoolTareas::RegistrarError(size_t NroTarea, int CodError)
+{
+std::lock_guard<std::mutex>	Bloqueo(Mutex);
+
+if (NroTarea<PrimeraFallida)
+    {
+	PrimeraFallida=NroTarea;
+	CodErrorFallida=CodError;
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TPoolTareas :: Hilo								*
+ *																	*
+ * OBJETIVO: Esta función es el cuerpo de cada hilo del pool: espera una tanda, trabaja en ella y avisa cuando se queda sin tareas.	*
+ *																	*
+ * ENTRADA: pPool: El pool.														*
+ *	    NroHilo: Número del hilo (el 0 es el que llama a Ejecutar()).								*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TPoolTareas::Hilo(TPoolTareas *pPool, unsigned NroHilo)
+{
+unsigned	TandaVista = 0;
+
+for (;;)
+    {
+	/* Esperar una tanda nueva, o que cierren el pool */
+	    {
+		std::unique_lock<std::mutex>	Bloqueo(pPool->Mutex);
+		while ( (!pPool->Terminar) && (pPool->NroTanda==TandaVista) )
+			pPool->HayTanda.wait(Bloqueo);
+		if (pPool->Terminar)
+			return;
+		TandaVista=pPool->NroTanda;
+	    }
+
+	/* Trabajar hasta que no quede nada y avisar */
+	pPool->Trabajar(NroHilo);
+	    {
+		std::lock_guard<std::mutex>	Bloqueo(pPool->Mutex);
+		if (!--pPool->HilosOcupados)
+			pPool->TandaTerminada.notify_all();
+	    }
+    }
+}